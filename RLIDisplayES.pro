@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui widgets concurrent opengl
+QT       += core gui widgets concurrent opengl network
 
 TARGET = RLIDisplayES
 TEMPLATE = app
@@ -41,23 +41,42 @@ SOURCES     += \
     src/common/rlilayout.cpp \
     src/common/rlistate.cpp \
     src/common/radarscale.cpp \
+    src/common/targetindex.cpp \
+    src/common/startuptrace.cpp \
+    src/common/framescheduler.cpp \
     \
     src/datasources/radardatasource.cpp \
+    src/datasources/radarudpreceiver.cpp \
+    src/datasources/datarecord.cpp \
+    src/datasources/datarecorder.cpp \
+    src/datasources/dataplayer.cpp \
     src/datasources/shipdatasource.cpp \
     src/datasources/targetdatasource.cpp \
+    src/datasources/aisparser.cpp \
+    src/datasources/targetfeed.cpp \
+    \
+    src/processing/radarvideoprocessor.cpp \
+    src/processing/radarplotextractor.cpp \
+    src/processing/radartracker.cpp \
     \
     src/s52/chartmanager.cpp \
     src/s52/s52chart.cpp \
     src/s52/s52assets.cpp \
     src/s52/s52references.cpp \
+    src/s52/s52pack.cpp \
     src/s52/s57condsymb.cpp \
     \
     src/layers/info/infofonts.cpp \
     src/layers/info/infoengine.cpp \
     src/layers/info/menuengine.cpp \
     src/layers/radar/radarengine.cpp \
+    src/layers/radar/radarhistory.cpp \
     src/layers/radar/radarpalette.cpp \
+    src/layers/radar/radarpyramid.cpp \
+    src/layers/radar/radarscanconverter.cpp \
+    src/layers/radar/radartrails.cpp \
     src/layers/chart/chartengine.cpp \
+    src/layers/chart/chartupload.cpp \
     src/layers/chart/chartshaders.cpp \
     src/layers/maskengine.cpp \
     src/layers/routeengine.cpp \
@@ -85,23 +104,44 @@ HEADERS     += \
     src/common/rlistringnames.h \
     src/common/rlistate.h \
     src/common/radarscale.h \
+    src/common/rlisimd.h \
+    src/common/targetindex.h \
+    src/common/startuptrace.h \
+    src/common/framescheduler.h \
     \
     src/datasources/radardatasource.h \
+    src/datasources/radarudpreceiver.h \
+    src/datasources/radarpacket.h \
+    src/datasources/datarecord.h \
+    src/datasources/datarecorder.h \
+    src/datasources/dataplayer.h \
     src/datasources/targetdatasource.h \
+    src/datasources/aisparser.h \
+    src/datasources/targetfeed.h \
+    \
+    src/processing/radarvideoprocessor.h \
+    src/processing/radarplotextractor.h \
+    src/processing/radartracker.h \
     src/datasources/shipdatasource.h \
     \
     src/s52/chartmanager.h \
     src/s52/s52chart.h \
     src/s52/s52assets.h \
     src/s52/s52references.h \
+    src/s52/s52pack.h \
     src/s52/s57condsymb.h \
     \
     src/layers/info/infofonts.h \
     src/layers/info/infoengine.h \
     src/layers/info/menuengine.h \
     src/layers/radar/radarengine.h \
+    src/layers/radar/radarhistory.h \
     src/layers/radar/radarpalette.h \
+    src/layers/radar/radarpyramid.h \
+    src/layers/radar/radarscanconverter.h \
+    src/layers/radar/radartrails.h \
     src/layers/chart/chartengine.h \
+    src/layers/chart/chartupload.h \
     src/layers/chart/chartshaders.h \
     src/layers/maskengine.h \    
     src/layers/routeengine.h \
@@ -1,5 +1,5 @@
-uniform vec4  color;
+varying vec4 v_color;
 
 void main() {
-  gl_FragColor = color;
+  gl_FragColor = v_color;
 }
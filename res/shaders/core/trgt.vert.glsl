@@ -6,13 +6,17 @@ attribute float heading;
 attribute float rotation;
 attribute float course;
 attribute float speed;
+attribute float sample_time;
 
 uniform vec2 center;
 uniform float scale;
 uniform float type;
+uniform float now;
+uniform float tail_duration;
 
 varying vec2 v_inner_texcoords;
 varying float v_type;
+varying float v_alpha;
 
 const float EARTH_RAD_METERS = 6378137.0;
 
@@ -58,6 +62,14 @@ void main() {
   }
 
   v_type = type;
+  v_alpha = 1.0;
   gl_Position = mvp_matrix  * vec4(pix_pos, 0.0, 1.0);
+
+  // Tail segments fade with age, empty and expired ones are moved out of the screen
+  if (type == 3.0) {
+    v_alpha = 1.0 - (now - sample_time) / tail_duration;
+    if (sample_time < 0.0 || v_alpha <= 0.0)
+      gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+  }
   gl_PointSize = 5.0;
 }
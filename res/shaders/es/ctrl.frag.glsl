@@ -1,7 +1,7 @@
 #version 100
 
-uniform vec4  color;
+varying vec4 v_color;
 
 void main() {
-  gl_FragColor = color;
+  gl_FragColor = v_color;
 }
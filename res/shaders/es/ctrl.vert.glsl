@@ -2,20 +2,36 @@
 
 uniform mat4 mvp_matrix;
 
-attribute float angle;
-attribute float radius;
+// One row per circle or ray, see ControlsEngine.
+// Circles: (radius, min angle, angular span, 0), rays: (angle, min radius, max radius, shift)
+uniform vec4 geometry[24];
+uniform vec4 offsets[24];
+uniform vec4 colors[24];
+uniform float circles;
 
-uniform float shift;
+attribute float row;
+attribute float t;
+
+varying vec4 v_color;
 
 void main() {
-  float phi = radians(angle);
-  vec2 pos = radius * vec2(sin(phi), -cos(phi));
+  int i = int(row + 0.5);
+  vec4 g = geometry[i];
 
-  if (shift != 0.0) {
-    float phi_shift = radians(angle + 90.0);
-    pos += shift * vec2(sin(phi_shift), -cos(phi_shift));
+  float phi;
+  float radius;
+  if (circles > 0.5) {
+    phi = radians(g.y + t * g.z);
+    radius = g.x;
+  } else {
+    phi = radians(g.x);
+    radius = mix(g.y, g.z, t);
   }
 
-  gl_Position = mvp_matrix * vec4(pos, 0.0, 1.0);
+  // Shift is along the direction 90 degrees clockwise of the ray
+  vec2 pos = radius * vec2(sin(phi), -cos(phi)) + g.w * vec2(cos(phi), sin(phi));
+
+  gl_Position = mvp_matrix * vec4(pos + offsets[i].xy, 0.0, 1.0);
   gl_PointSize = 1.0;
+  v_color = colors[i];
 }
@@ -1,14 +1,27 @@
 #version 100
 
-uniform sampler2D texture;
+uniform sampler2D amplitudes;
+uniform sampler2D palette;
 uniform vec4  color;
 uniform float threashold;
+uniform vec2  size;
+uniform vec2  tap;
 
-varying float v_amp;
+varying vec2 v_pixel;
+varying vec2 v_texcoord;
 
 void main() {
-  if (v_amp < threashold)
+  if (any(lessThan(v_pixel, vec2(1.0))) || any(greaterThan(v_pixel, size - vec2(1.0)))) {
     gl_FragColor = color;
+    return;
+  }
+
+  // Max of 2x2 samples, all taps are the same sample when tap is zero
+  float amp = max( max(texture2D(amplitudes, v_texcoord - tap).r, texture2D(amplitudes, v_texcoord + tap).r)
+                 , max(texture2D(amplitudes, v_texcoord + vec2(tap.x, -tap.y)).r, texture2D(amplitudes, v_texcoord + vec2(-tap.x, tap.y)).r) );
+
+  if (amp < threashold)
+    gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
   else
-    gl_FragColor = texture2D(texture, vec2(0.0, v_amp / 255.0));
+    gl_FragColor = texture2D(palette, vec2(0.0, amp));
 }
@@ -1,14 +1,17 @@
 #version 100
 
 uniform mat4 mvp_matrix;
+// Polar texture coordinates per pixel, (radius, peleng)
+uniform vec2 tex_scale;
 
 attribute vec2 a_position;
-attribute float a_amplitude;
 
-varying float v_amp;
+varying vec2 v_pixel;
+varying vec2 v_texcoord;
 
 void main() {
   gl_Position = mvp_matrix * vec4(a_position, 0.0, 1.0);
-  v_amp = a_amplitude;
-  gl_PointSize = 1.0;
+  v_pixel = a_position;
+  // Columns are pelengs and rows are radii, the border is one pixel wide
+  v_texcoord = (a_position.yx - vec2(1.0)) * tex_scale;
 }
@@ -9,6 +9,7 @@ attribute float amplitude;
 
 uniform float peleng_length;
 uniform float peleng_count;
+uniform float north_shift;
 
 varying float v_amp;
 
@@ -16,7 +17,7 @@ void main() {
   float peleng_index = floor(position / peleng_length);
   float radius = mod(position, peleng_length);
 
-  float angle = radians((360.0 * peleng_index) / peleng_count);
+  float angle = radians(mod(north_shift + (360.0 * peleng_index) / peleng_count, 360.0));
 
   float x =  radius * sin(angle);
   float y = -radius * cos(angle);
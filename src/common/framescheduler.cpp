@@ -0,0 +1,141 @@
+#include "framescheduler.h"
+#include "properties.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QDebug>
+
+FrameScheduler::FrameScheduler(QOpenGLWidget* widget, int min_interval, const std::function<bool()>& poll, QObject* parent)
+  : QObject(parent), _widget(widget), _poll(poll) {
+  _min_interval = static_cast<qint64>(qMax(0, min_interval)) * 1000000;
+  _stat = qApp->property(PROPERTY_RADAR_STAT).toBool();
+
+  _clock.start();
+  _last_frame = -_min_interval;
+  _stat_start = _clock.nsecsElapsed();
+
+  _deadline.setSingleShot(true);
+  _deadline.setTimerType(Qt::PreciseTimer);
+  connect(&_deadline, SIGNAL(timeout()), SLOT(schedule()));
+
+  _poll_timer.setInterval(POLL_INTERVAL);
+  connect(&_poll_timer, SIGNAL(timeout()), SLOT(onPoll()));
+  _poll_timer.start();
+
+  connect(_widget, SIGNAL(frameSwapped()), SLOT(onFrameSwapped()));
+}
+
+
+void FrameScheduler::request(int reasons) {
+  _pending |= reasons;
+  schedule();
+}
+
+void FrameScheduler::onRadarData() {
+  if (_data_arrival < 0)
+    _data_arrival = _clock.nsecsElapsed();
+
+  request(RADAR_DATA);
+}
+
+void FrameScheduler::onChartImage() {
+  request(CHART);
+}
+
+void FrameScheduler::onPoll() {
+  if (_poll && _poll())
+    request(LAYERS);
+}
+
+void FrameScheduler::schedule() {
+  if (_pending == 0 || _requested)
+    return;
+
+  qint64 now = _clock.nsecsElapsed();
+
+  // The swap of the last frame is awaited, unless it was lost (hidden window)
+  if (_in_flight && now - _last_frame < 4*qMax(_min_interval, qint64(POLL_INTERVAL) * 1000000))
+    return;
+  _in_flight = false;
+
+  qint64 wait = _last_frame + _min_interval - now;
+  if (wait > 0) {
+    if (!_deadline.isActive())
+      _deadline.start(static_cast<int>((wait + 999999) / 1000000));
+    return;
+  }
+
+  _requested = true;
+  _widget->update();
+}
+
+
+void FrameScheduler::beginFrame() {
+  // paintGL may also come from Qt itself, e.g. on expose, it takes all pending changes the same way
+  _requested = false;
+  _deadline.stop();
+
+  _last_frame = _clock.nsecsElapsed();
+  _frame_reasons = _pending;
+  _pending = 0;
+
+  _frame_data_arrival = _data_arrival;
+  _data_arrival = -1;
+}
+
+void FrameScheduler::endFrame() {
+  _in_flight = true;
+
+  // The budget of a frame is the minimal interval, a longer frame delays the next one
+  if (_stat && _min_interval > 0 && _clock.nsecsElapsed() - _last_frame > _min_interval)
+    _stat_late++;
+}
+
+void FrameScheduler::onFrameSwapped() {
+  qint64 now = _clock.nsecsElapsed();
+  _in_flight = false;
+
+  if (_stat)
+    collectStat(now);
+
+  // Changes which came during the frame
+  schedule();
+}
+
+
+void FrameScheduler::collectStat(qint64 now) {
+  _stat_frames++;
+
+  for (int i = 0; i < REASON_COUNT; i++)
+    if (_frame_reasons & (1 << i))
+      _stat_reasons[i]++;
+
+  if (_frame_data_arrival >= 0) {
+    qint64 latency = now - _frame_data_arrival;
+    _stat_latency_count++;
+    _stat_latency_sum += latency;
+    _stat_latency_max = qMax(_stat_latency_max, latency);
+  }
+
+  qint64 elapsed = now - _stat_start;
+  if (elapsed < qint64(STAT_INTERVAL) * 1000000)
+    return;
+
+  double secs = elapsed / 1e9;
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+           << "Frames:" << _stat_frames << "in" << secs << "s," << _stat_frames / secs << "fps,"
+           << _stat_late << "over budget; by radar" << _stat_reasons[0] << "chart" << _stat_reasons[1]
+           << "layers" << _stat_reasons[2] << "input" << _stat_reasons[3] << "ship" << _stat_reasons[4]
+           << "; data to swap latency avg"
+           << (_stat_latency_count > 0 ? _stat_latency_sum / 1e6 / _stat_latency_count : 0.0)
+           << "ms, max" << _stat_latency_max / 1e6 << "ms";
+
+  _stat_start = now;
+  _stat_frames = 0;
+  _stat_late = 0;
+  for (int i = 0; i < REASON_COUNT; i++)
+    _stat_reasons[i] = 0;
+  _stat_latency_count = 0;
+  _stat_latency_sum = 0;
+  _stat_latency_max = 0;
+}
@@ -0,0 +1,81 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QOpenGLWidget>
+
+#include <functional>
+
+// Кадры по требованию. A frame is drawn only when something changed: the sources
+// call request() with a reason, the layers that change on their own are polled every
+// POLL_INTERVAL ms. The next frame is started after the previous one is swapped
+// (so at most one frame per vsync) and not earlier than min_interval ms after it.
+// Latency is measured from the first radar data not yet drawn to the swap of the frame
+// that draws it, with -stat it is logged every STAT_INTERVAL ms with the frame counts.
+class FrameScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  enum Reason { RADAR_DATA  = 1
+              , CHART       = 2
+              , LAYERS      = 4
+              , INPUT       = 8
+              , SHIP        = 16
+              , REASON_COUNT = 5 };
+
+  // poll returns true if a polled layer has changes to draw
+  FrameScheduler(QOpenGLWidget* widget, int min_interval, const std::function<bool()>& poll, QObject* parent = nullptr);
+
+  // Called from paintGL
+  void beginFrame();
+  void endFrame();
+
+public slots:
+  void request(int reasons);
+
+  void onRadarData();
+  void onChartImage();
+
+private slots:
+  void onFrameSwapped();
+  void onPoll();
+  void schedule();
+
+private:
+  enum { POLL_INTERVAL = 100, STAT_INTERVAL = 5000 };
+
+  void collectStat(qint64 now);
+
+  QOpenGLWidget* _widget;
+  std::function<bool()> _poll;
+  qint64 _min_interval; // ns
+
+  QElapsedTimer _clock;
+  QTimer _deadline;
+  QTimer _poll_timer;
+
+  int _pending = 0;
+  // update() is called and paintGL is not yet
+  bool _requested = false;
+  // paintGL is done and the frame is not yet swapped
+  bool _in_flight = false;
+  qint64 _last_frame = 0;
+
+  // Arrival of the first radar data not yet drawn and of the one of the frame in flight, -1 for none
+  qint64 _data_arrival = -1;
+  qint64 _frame_data_arrival = -1;
+  int _frame_reasons = 0;
+
+  bool _stat;
+  qint64 _stat_start = 0;
+  int _stat_frames = 0;
+  int _stat_late = 0;
+  int _stat_reasons[REASON_COUNT] { };
+  int _stat_latency_count = 0;
+  qint64 _stat_latency_sum = 0;
+  qint64 _stat_latency_max = 0;
+};
+
+#endif // FRAMESCHEDULER_H
@@ -22,6 +22,19 @@ static const char* PROPERTY_FRAME_DELAY         = const_cast<const char*>("PRPOP
 static const char* PROPERTY_DATA_DELAY          = const_cast<const char*>("PRPOPERTY_DATA_DELAY");
 static const char* PROPERTY_BLOCK_SIZE          = const_cast<const char*>("PRPOPERTY_BLOCK_SIZE");
 
+static const char* PROPERTY_RADAR_CPU           = const_cast<const char*>("PROPERTY_RADAR_CPU");
+static const char* PROPERTY_RADAR_CFAR          = const_cast<const char*>("PROPERTY_RADAR_CFAR");
+static const char* PROPERTY_RADAR_STAT          = const_cast<const char*>("PROPERTY_RADAR_STAT");
+static const char* PROPERTY_RADAR_HISTORY       = const_cast<const char*>("PROPERTY_RADAR_HISTORY");
+
+static const char* PROPERTY_RADAR_SOURCE        = const_cast<const char*>("PROPERTY_RADAR_SOURCE");
+static const char* PROPERTY_AIS_SOURCE          = const_cast<const char*>("PROPERTY_AIS_SOURCE");
+
+static const char* PROPERTY_RECORD              = const_cast<const char*>("PROPERTY_RECORD");
+static const char* PROPERTY_REPLAY              = const_cast<const char*>("PROPERTY_REPLAY");
+
 static const char* PROPERTY_RLI_WIDGET_SIZE     = const_cast<const char*>("PROPERTY_RLI_WIDGET_SIZE");
 
+static const char* PROPERTY_STARTUP_TRACE       = const_cast<const char*>("PROPERTY_STARTUP_TRACE");
+
 #endif // PROPERTIES_H
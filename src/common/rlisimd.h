@@ -0,0 +1,331 @@
+#ifndef RLISIMD_H
+#define RLISIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RLI_SIMD_NEON
+#endif
+
+// Vectorized kernels for peleng processing.
+// Every kernel has a scalar tail, so lengths need not be multiples of the vector width.
+namespace RLISimd {
+
+  // dst[i] = max(a[i], b[i])
+  inline void maxf(const float* a, const float* b, float* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE__)
+    for (; i + 4 <= n; i += 4)
+      _mm_storeu_ps(dst + i, _mm_max_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#elif defined(RLI_SIMD_NEON)
+    for (; i + 4 <= n; i += 4)
+      vst1q_f32(dst + i, vmaxq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+#endif
+
+    for (; i < n; i++)
+      dst[i] = a[i] > b[i] ? a[i] : b[i];
+  }
+
+  // out[i] = acc[i]*k, acc[i] = max(out[i], src[i])
+  inline void decayMaxf(float* acc, const float* src, float k, float* out, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE__)
+    __m128 vk = _mm_set1_ps(k);
+    for (; i + 4 <= n; i += 4) {
+      __m128 d = _mm_mul_ps(_mm_loadu_ps(acc + i), vk);
+      _mm_storeu_ps(out + i, d);
+      _mm_storeu_ps(acc + i, _mm_max_ps(d, _mm_loadu_ps(src + i)));
+    }
+#elif defined(RLI_SIMD_NEON)
+    float32x4_t vk = vdupq_n_f32(k);
+    for (; i + 4 <= n; i += 4) {
+      float32x4_t d = vmulq_f32(vld1q_f32(acc + i), vk);
+      vst1q_f32(out + i, d);
+      vst1q_f32(acc + i, vmaxq_f32(d, vld1q_f32(src + i)));
+    }
+#endif
+
+    for (; i < n; i++) {
+      out[i] = acc[i] * k;
+      acc[i] = out[i] > src[i] ? out[i] : src[i];
+    }
+  }
+
+  // dst[i] = max(0, a[i] - k*b[i])
+  inline void subScaledClampf(const float* a, const float* b, float k, float* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE__)
+    __m128 vk = _mm_set1_ps(k);
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+      _mm_storeu_ps(dst + i, _mm_max_ps(zero, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_mul_ps(vk, _mm_loadu_ps(b + i)))));
+#elif defined(RLI_SIMD_NEON)
+    float32x4_t vk = vdupq_n_f32(k);
+    float32x4_t zero = vdupq_n_f32(0.f);
+    for (; i + 4 <= n; i += 4)
+      vst1q_f32(dst + i, vmaxq_f32(zero, vmlsq_f32(vld1q_f32(a + i), vk, vld1q_f32(b + i))));
+#endif
+
+    for (; i < n; i++) {
+      float d = a[i] - k*b[i];
+      dst[i] = d > 0.f ? d : 0.f;
+    }
+  }
+
+  // dst[i] = min(hi, a[i]*k)
+  inline void scaleClampf(const float* a, float k, float hi, float* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE__)
+    __m128 vk = _mm_set1_ps(k);
+    __m128 vhi = _mm_set1_ps(hi);
+    for (; i + 4 <= n; i += 4)
+      _mm_storeu_ps(dst + i, _mm_min_ps(vhi, _mm_mul_ps(_mm_loadu_ps(a + i), vk)));
+#elif defined(RLI_SIMD_NEON)
+    float32x4_t vk = vdupq_n_f32(k);
+    float32x4_t vhi = vdupq_n_f32(hi);
+    for (; i + 4 <= n; i += 4)
+      vst1q_f32(dst + i, vminq_f32(vhi, vmulq_f32(vld1q_f32(a + i), vk)));
+#endif
+
+    for (; i < n; i++) {
+      float d = a[i] * k;
+      dst[i] = d < hi ? d : hi;
+    }
+  }
+
+  // dst[i] = a[i] >= k*b[i] ? a[i] : 0
+  inline void thresholdf(const float* a, const float* b, float k, float* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE__)
+    __m128 vk = _mm_set1_ps(k);
+    for (; i + 4 <= n; i += 4) {
+      __m128 va = _mm_loadu_ps(a + i);
+      __m128 mask = _mm_cmpge_ps(va, _mm_mul_ps(vk, _mm_loadu_ps(b + i)));
+      _mm_storeu_ps(dst + i, _mm_and_ps(mask, va));
+    }
+#elif defined(RLI_SIMD_NEON)
+    float32x4_t vk = vdupq_n_f32(k);
+    for (; i + 4 <= n; i += 4) {
+      float32x4_t va = vld1q_f32(a + i);
+      uint32x4_t mask = vcgeq_f32(va, vmulq_f32(vk, vld1q_f32(b + i)));
+      vst1q_f32(dst + i, vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(va))));
+    }
+#endif
+
+    for (; i < n; i++)
+      dst[i] = a[i] >= k*b[i] ? a[i] : 0.f;
+  }
+
+  // dst[0] = 0, dst[i+1] = dst[i] + a[i], dst has n+1 values.
+  // Vectors are scanned in registers and carry the last sum to the next one
+  inline void prefixSumf(const float* a, float* dst, size_t n) {
+    size_t i = 0;
+    dst[0] = 0.f;
+
+#if defined(__SSE2__)
+    __m128 carry = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+      __m128 v = _mm_loadu_ps(a + i);
+      v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+      v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+      v = _mm_add_ps(v, carry);
+      _mm_storeu_ps(dst + i + 1, v);
+      carry = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+#elif defined(RLI_SIMD_NEON)
+    float32x4_t zero = vdupq_n_f32(0.f);
+    float32x4_t carry = zero;
+    for (; i + 4 <= n; i += 4) {
+      float32x4_t v = vld1q_f32(a + i);
+      v = vaddq_f32(v, vextq_f32(zero, v, 3));
+      v = vaddq_f32(v, vextq_f32(zero, v, 2));
+      v = vaddq_f32(v, carry);
+      vst1q_f32(dst + i + 1, v);
+      carry = vdupq_n_f32(vgetq_lane_f32(v, 3));
+    }
+#endif
+
+    for (; i < n; i++)
+      dst[i+1] = dst[i] + a[i];
+  }
+
+  // dst[i] = (hi[i] - lo[i])*k, mean of a window from prefix sums
+  inline void windowMeanf(const float* hi, const float* lo, float k, float* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE__)
+    __m128 vk = _mm_set1_ps(k);
+    for (; i + 4 <= n; i += 4)
+      _mm_storeu_ps(dst + i, _mm_mul_ps(vk, _mm_sub_ps(_mm_loadu_ps(hi + i), _mm_loadu_ps(lo + i))));
+#elif defined(RLI_SIMD_NEON)
+    float32x4_t vk = vdupq_n_f32(k);
+    for (; i + 4 <= n; i += 4)
+      vst1q_f32(dst + i, vmulq_f32(vk, vsubq_f32(vld1q_f32(hi + i), vld1q_f32(lo + i))));
+#endif
+
+    for (; i < n; i++)
+      dst[i] = (hi[i] - lo[i]) * k;
+  }
+
+  // dst[i] = ((hi1[i] - lo1[i]) + (hi2[i] - lo2[i]))*k, mean of two windows from prefix sums
+  inline void windowMean2f(const float* hi1, const float* lo1, const float* hi2, const float* lo2, float k, float* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE__)
+    __m128 vk = _mm_set1_ps(k);
+    for (; i + 4 <= n; i += 4) {
+      __m128 s1 = _mm_sub_ps(_mm_loadu_ps(hi1 + i), _mm_loadu_ps(lo1 + i));
+      __m128 s2 = _mm_sub_ps(_mm_loadu_ps(hi2 + i), _mm_loadu_ps(lo2 + i));
+      _mm_storeu_ps(dst + i, _mm_mul_ps(vk, _mm_add_ps(s1, s2)));
+    }
+#elif defined(RLI_SIMD_NEON)
+    float32x4_t vk = vdupq_n_f32(k);
+    for (; i + 4 <= n; i += 4) {
+      float32x4_t s1 = vsubq_f32(vld1q_f32(hi1 + i), vld1q_f32(lo1 + i));
+      float32x4_t s2 = vsubq_f32(vld1q_f32(hi2 + i), vld1q_f32(lo2 + i));
+      vst1q_f32(dst + i, vmulq_f32(vk, vaddq_f32(s1, s2)));
+    }
+#endif
+
+    for (; i < n; i++)
+      dst[i] = ((hi1[i] - lo1[i]) + (hi2[i] - lo2[i])) * k;
+  }
+
+  // dst[i] = min(a[i], b[i])
+  inline void minu8(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+      _mm_storeu_si128( reinterpret_cast<__m128i*>(dst + i)
+                      , _mm_min_epu8( _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i))
+                                    , _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)) ) );
+#elif defined(RLI_SIMD_NEON)
+    for (; i + 16 <= n; i += 16)
+      vst1q_u8(dst + i, vminq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+#endif
+
+    for (; i < n; i++)
+      dst[i] = a[i] < b[i] ? a[i] : b[i];
+  }
+
+  // dst[i] = median(a[i], b[i], c[i])
+  inline void median3u8(const uint8_t* a, const uint8_t* b, const uint8_t* c, uint8_t* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+      __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+      __m128i lo = _mm_min_epu8(va, vb);
+      __m128i hi = _mm_max_epu8(va, vb);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(lo, _mm_min_epu8(hi, vc)));
+    }
+#elif defined(RLI_SIMD_NEON)
+    for (; i + 16 <= n; i += 16) {
+      uint8x16_t va = vld1q_u8(a + i);
+      uint8x16_t vb = vld1q_u8(b + i);
+      uint8x16_t vc = vld1q_u8(c + i);
+      vst1q_u8(dst + i, vmaxq_u8(vminq_u8(va, vb), vminq_u8(vmaxq_u8(va, vb), vc)));
+    }
+#endif
+
+    for (; i < n; i++) {
+      uint8_t lo = a[i] < b[i] ? a[i] : b[i];
+      uint8_t hi = a[i] < b[i] ? b[i] : a[i];
+      uint8_t m = hi < c[i] ? hi : c[i];
+      dst[i] = lo > m ? lo : m;
+    }
+  }
+
+  // Amplitudes 0..255 to bytes with truncation
+  inline void packu8(const float* src, uint8_t* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+      __m128i v0 = _mm_cvttps_epi32(_mm_loadu_ps(src + i));
+      __m128i v1 = _mm_cvttps_epi32(_mm_loadu_ps(src + i + 4));
+      __m128i v2 = _mm_cvttps_epi32(_mm_loadu_ps(src + i + 8));
+      __m128i v3 = _mm_cvttps_epi32(_mm_loadu_ps(src + i + 12));
+      __m128i w0 = _mm_packs_epi32(v0, v1);
+      __m128i w1 = _mm_packs_epi32(v2, v3);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(w0, w1));
+    }
+#elif defined(RLI_SIMD_NEON)
+    // Negative values convert to 0, narrowing saturates at 255
+    for (; i + 16 <= n; i += 16) {
+      uint16x8_t w0 = vcombine_u16( vqmovn_u32(vcvtq_u32_f32(vld1q_f32(src + i)))
+                                  , vqmovn_u32(vcvtq_u32_f32(vld1q_f32(src + i + 4))) );
+      uint16x8_t w1 = vcombine_u16( vqmovn_u32(vcvtq_u32_f32(vld1q_f32(src + i + 8)))
+                                  , vqmovn_u32(vcvtq_u32_f32(vld1q_f32(src + i + 12))) );
+      vst1q_u8(dst + i, vcombine_u8(vqmovn_u16(w0), vqmovn_u16(w1)));
+    }
+#endif
+
+    for (; i < n; i++) {
+      float v = src[i];
+      dst[i] = static_cast<uint8_t>(v <= 0.f ? 0.f : (v >= 255.f ? 255.f : v));
+    }
+  }
+
+  // dst[i] = min(a[i], b[i]), b in bytes
+  inline void minf_u8(const float* a, const uint8_t* b, float* dst, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      __m128i lo = _mm_unpacklo_epi8(vb, zero);
+      __m128i hi = _mm_unpackhi_epi8(vb, zero);
+
+      __m128 f[4] = { _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero))
+                    , _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero))
+                    , _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero))
+                    , _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)) };
+
+      for (int k = 0; k < 4; k++)
+        _mm_storeu_ps(dst + i + 4*k, _mm_min_ps(_mm_loadu_ps(a + i + 4*k), f[k]));
+    }
+#elif defined(RLI_SIMD_NEON)
+    for (; i + 16 <= n; i += 16) {
+      uint8x16_t vb = vld1q_u8(b + i);
+      uint16x8_t lo = vmovl_u8(vget_low_u8(vb));
+      uint16x8_t hi = vmovl_u8(vget_high_u8(vb));
+
+      float32x4_t f[4] = { vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo)))
+                         , vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo)))
+                         , vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi)))
+                         , vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))) };
+
+      for (int k = 0; k < 4; k++)
+        vst1q_f32(dst + i + 4*k, vminq_f32(vld1q_f32(a + i + 4*k), f[k]));
+    }
+#endif
+
+    for (; i < n; i++) {
+      float fb = static_cast<float>(b[i]);
+      dst[i] = a[i] < fb ? a[i] : fb;
+    }
+  }
+
+}
+
+#endif // RLISIMD_H
@@ -46,6 +46,8 @@ struct RLIState {
   float apch                { 0.f };
   float emission            { 0.f };
 
+  bool interference_rejection { false };
+
   // Radar parameters
 
   // Chart parameters
@@ -73,11 +75,23 @@ struct RLIState {
   int peleng_length   { 800 };
   int peleng_count    { 4096 };
 
+  // Capture zone parameters, radii in pixels
+  float capt_min_angle  { 280.f };
+  float capt_max_angle  { 340.f };
+  float capt_min_rad    { 48.f };
+  float capt_max_rad    { 112.f };
+
   // Magnifier parameters
   int magn_min_rad    { 96 };
   int magn_min_peleng { 90 };
   int magn_height     { 224 };
   int magn_width      { 224 };
+  int magn_zoom       { 0 };      // 2^magn_zoom pixels per sample, see MagnifierEngine
+  bool magn_bilinear  { false };
+
+  // Pelengs and radii covered by the magnifier at magn_zoom
+  inline int magnPelengs()  const { return magn_zoom >= 0 ? magn_width >> magn_zoom : magn_width << -magn_zoom; }
+  inline int magnRadii()    const { return magn_zoom >= 0 ? magn_height >> magn_zoom : magn_height << -magn_zoom; }
 };
 
 #endif // RLISTATE_H
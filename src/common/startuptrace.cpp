@@ -0,0 +1,109 @@
+#include "startuptrace.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QStringList>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+
+#include <algorithm>
+
+namespace {
+  struct TraceEvent {
+    QString name;
+    int thread;
+    qint64 begin;
+    qint64 end;   // -1 for marks
+  };
+
+  QElapsedTimer trace_clock;
+  QMutex trace_mutex;
+  QVector<TraceEvent> trace_events;
+  QVector<QThread*> trace_threads;
+  bool trace_finished = false;
+
+  // Threads are numbered in order of their first event, the GUI thread is 0
+  int threadIndex(QThread* thread) {
+    if (trace_threads.isEmpty() && qApp != nullptr)
+      trace_threads.push_back(qApp->thread());
+
+    int index = trace_threads.indexOf(thread);
+    if (index < 0) {
+      index = trace_threads.size();
+      trace_threads.push_back(thread);
+    }
+    return index;
+  }
+}
+
+void StartupTrace::start() {
+  trace_clock.start();
+}
+
+qint64 StartupTrace::now() {
+  return trace_clock.isValid() ? trace_clock.nsecsElapsed() / 1000 : 0;
+}
+
+void StartupTrace::record(const QString& name, qint64 begin_us, qint64 end_us) {
+  QMutexLocker locker(&trace_mutex);
+  if (trace_finished)
+    return;
+
+  trace_events.push_back(TraceEvent { name, threadIndex(QThread::currentThread()), begin_us, end_us });
+}
+
+void StartupTrace::mark(const QString& name) {
+  record(name, now(), -1);
+}
+
+bool StartupTrace::finished() {
+  QMutexLocker locker(&trace_mutex);
+  return trace_finished;
+}
+
+void StartupTrace::finish(const QString& trace_path) {
+  QVector<TraceEvent> events;
+  {
+    QMutexLocker locker(&trace_mutex);
+    if (trace_finished)
+      return;
+
+    trace_finished = true;
+    events.swap(trace_events);
+  }
+
+  std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.begin < b.begin; });
+
+  qDebug() << "Startup trace, ms from start (thread 0 is GUI):";
+  for (const TraceEvent& e : events) {
+    if (e.end < 0)
+      qDebug() << qPrintable(QString("  %1          thread %2  * %3").arg(e.begin / 1000.0, 8, 'f', 1).arg(e.thread).arg(e.name));
+    else
+      qDebug() << qPrintable(QString("  %1 %2  thread %3  %4").arg(e.begin / 1000.0, 8, 'f', 1).arg((e.end - e.begin) / 1000.0, 8, 'f', 1).arg(e.thread).arg(e.name));
+  }
+
+  if (trace_path.isEmpty())
+    return;
+
+  QFile file(trace_path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qDebug() << "Can't write startup trace to" << trace_path;
+    return;
+  }
+
+  QStringList lines;
+  for (const TraceEvent& e : events) {
+    QString name = e.name;
+    name.replace('\\', "\\\\").replace('"', "\\\"");
+
+    if (e.end < 0)
+      lines << QString("{\"name\":\"%1\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%2,\"pid\":1,\"tid\":%3}").arg(name).arg(e.begin).arg(e.thread);
+    else
+      lines << QString("{\"name\":\"%1\",\"ph\":\"X\",\"ts\":%2,\"dur\":%3,\"pid\":1,\"tid\":%4}").arg(name).arg(e.begin).arg(e.end - e.begin).arg(e.thread);
+  }
+
+  file.write(("{\"traceEvents\":[\n" + lines.join(",\n") + "\n]}\n").toUtf8());
+}
@@ -0,0 +1,36 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QString>
+
+// Трасса запуска: интервалы работы потоков и отметки от старта процесса.
+// Spans may be recorded from any thread until finish(), which prints them sorted
+// by start and, with -trace <file>, writes them in Chrome trace format
+// (chrome://tracing, ui.perfetto.dev). Nothing is recorded after finish().
+class StartupTrace {
+public:
+  // Starts the clock, call it first in main
+  static void start();
+  // Microseconds since start()
+  static qint64 now();
+
+  static void record(const QString& name, qint64 begin_us, qint64 end_us);
+  // Instant event, e.g. the first radar frame
+  static void mark(const QString& name);
+
+  static void finish(const QString& trace_path = QString());
+  static bool finished();
+
+  // Records the span from construction to destruction
+  class Span {
+  public:
+    explicit Span(const QString& name) : _name(name), _begin(StartupTrace::now()) { }
+    ~Span() { StartupTrace::record(_name, _begin, StartupTrace::now()); }
+
+  private:
+    QString _name;
+    qint64 _begin;
+  };
+};
+
+#endif // STARTUPTRACE_H
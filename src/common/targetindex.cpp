@@ -0,0 +1,143 @@
+#include "targetindex.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+TargetIndex::TargetIndex(double cell_size) {
+  _cell_size = cell_size;
+}
+
+void TargetIndex::clear() {
+  _items.clear();
+  _cells.clear();
+  _count = 0;
+}
+
+int TargetIndex::cellCoord(double v) const {
+  return static_cast<int>(std::floor(v / _cell_size));
+}
+
+void TargetIndex::update(int id, double x, double y) {
+  if (id < 0)
+    return;
+
+  if (id >= static_cast<int>(_items.size()))
+    _items.resize(id + 1, Item { 0.0, 0.0, 0, -1, false });
+
+  Item& item = _items[id];
+  CellKey cell = cellKey(cellCoord(x), cellCoord(y));
+
+  item.x = x;
+  item.y = y;
+
+  if (item.used && item.cell == cell)
+    return;
+
+  if (item.used)
+    removeFromCell(id);
+  else
+    _count++;
+
+  std::vector<int>& list = _cells[cell];
+  item.cell = cell;
+  item.pos = static_cast<int>(list.size());
+  item.used = true;
+  list.push_back(id);
+}
+
+void TargetIndex::remove(int id) {
+  if (!contains(id))
+    return;
+
+  removeFromCell(id);
+  _items[id].used = false;
+  _count--;
+}
+
+void TargetIndex::removeFromCell(int id) {
+  Item& item = _items[id];
+
+  auto it = _cells.find(item.cell);
+  std::vector<int>& list = it->second;
+
+  int moved = list.back();
+  list[item.pos] = moved;
+  _items[moved].pos = item.pos;
+  list.pop_back();
+
+  if (list.empty())
+    _cells.erase(it);
+}
+
+
+// Calls f for every id list of cells touched by the circle.
+// When the circle covers more cells than there are non-empty ones, walks the map instead
+template<class F> void TargetIndex::forCells(double x, double y, double r, F f) const {
+  double span = std::ceil(2*r / _cell_size) + 1;
+
+  if (!(r < std::numeric_limits<double>::max()) || span*span > static_cast<double>(_cells.size())) {
+    for (const auto& cell : _cells)
+      f(cell.second);
+    return;
+  }
+
+  int cx0 = cellCoord(x - r), cx1 = cellCoord(x + r);
+  int cy0 = cellCoord(y - r), cy1 = cellCoord(y + r);
+
+  for (int cx = cx0; cx <= cx1; cx++) {
+    for (int cy = cy0; cy <= cy1; cy++) {
+      auto it = _cells.find(cellKey(cx, cy));
+      if (it != _cells.end())
+        f(it->second);
+    }
+  }
+}
+
+void TargetIndex::radius(double x, double y, double r, std::vector<int>& ids) const {
+  ids.clear();
+
+  if (r < 0 || _count == 0)
+    return;
+
+  double r2 = r*r;
+
+  forCells(x, y, r, [&](const std::vector<int>& list) {
+    for (int id : list) {
+      double dx = _items[id].x - x;
+      double dy = _items[id].y - y;
+      if (dx*dx + dy*dy <= r2)
+        ids.push_back(id);
+    }
+  });
+}
+
+// The search circle grows twice until it holds k ids, everything
+// within the circle is found, so the k nearest are among them
+void TargetIndex::nearest(double x, double y, int k, double max_r, std::vector<int>& ids) const {
+  ids.clear();
+
+  if (k <= 0 || _count == 0)
+    return;
+
+  double r = std::min(_cell_size, max_r);
+  for (;;) {
+    radius(x, y, r, ids);
+
+    if (static_cast<int>(ids.size()) >= std::min(k, _count) || r >= max_r)
+      break;
+
+    r = std::min(2*r, max_r);
+  }
+
+  auto dist2 = [this, x, y](int id) {
+    double dx = _items[id].x - x;
+    double dy = _items[id].y - y;
+    return dx*dx + dy*dy;
+  };
+
+  std::sort(ids.begin(), ids.end(), [&dist2](int a, int b) { return dist2(a) < dist2(b); });
+
+  if (static_cast<int>(ids.size()) > k)
+    ids.resize(k);
+}
@@ -0,0 +1,57 @@
+#ifndef TARGETINDEX_H
+#define TARGETINDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+// Пространственный индекс целей.
+// Uniform grid over a local metric plane, only non-empty cells are stored.
+// Ids are small non-negative integers (slots, track or plot numbers),
+// a position update which stays in the same cell costs a couple of stores.
+class TargetIndex {
+public:
+  explicit TargetIndex(double cell_size = 1000.0);
+
+  void clear();
+
+  // Inserts the id if it is not indexed yet
+  void update(int id, double x, double y);
+  void remove(int id);
+
+  inline bool contains(int id) const  { return id >= 0 && id < static_cast<int>(_items.size()) && _items[id].used; }
+  inline int size() const             { return _count; }
+  inline double cellSize() const      { return _cell_size; }
+
+  // Ids within r of (x, y), in no particular order
+  void radius(double x, double y, double r, std::vector<int>& ids) const;
+  // Up to k ids within max_r of (x, y), nearest first
+  void nearest(double x, double y, int k, double max_r, std::vector<int>& ids) const;
+
+private:
+  typedef uint64_t CellKey;
+
+  struct Item {
+    double x, y;
+    CellKey cell;
+    int pos;        // Position in the cell list
+    bool used;
+  };
+
+  inline int cellCoord(double v) const;
+  static inline CellKey cellKey(int cx, int cy) {
+    return (static_cast<CellKey>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+  }
+
+  void removeFromCell(int id);
+
+  template<class F> void forCells(double x, double y, double r, F f) const;
+
+  double _cell_size;
+  int _count = 0;
+
+  std::vector<Item> _items;
+  std::unordered_map<CellKey, std::vector<int> > _cells;
+};
+
+#endif // TARGETINDEX_H
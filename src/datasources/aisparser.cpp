@@ -0,0 +1,264 @@
+#include "aisparser.h"
+
+#include <cmath>
+#include <cstring>
+
+static inline int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// Small non-negative integer field, -1 if empty or malformed
+static inline int intField(const char* begin, const char* end) {
+  if (begin == end)
+    return -1;
+
+  int v = 0;
+  for (const char* p = begin; p < end; p++) {
+    if (*p < '0' || *p > '9')
+      return -1;
+    v = 10*v + (*p - '0');
+  }
+  return v;
+}
+
+
+AISParser::AISParser() {
+  _line_len = 0;
+  _line_overflow = false;
+
+  for (int i = 0; i < SEQ_SLOTS; i++) {
+    _fragments[i].len = 0;
+    _fragments[i].next = 1;
+    _fragments[i].total = 0;
+  }
+
+  _bit_count = 0;
+
+  _sentences = 0;
+  _messages = 0;
+  _errors = 0;
+
+  _reports.reserve(1024);
+}
+
+int AISParser::parse(const char* data, size_t len) {
+  size_t count = _reports.size();
+
+  for (size_t i = 0; i < len; i++) {
+    char c = data[i];
+
+    if (c == '\n' || c == '\r') {
+      if (_line_len > 0 && !_line_overflow)
+        parseLine();
+      else if (_line_overflow)
+        _errors++;
+
+      _line_len = 0;
+      _line_overflow = false;
+    } else if (_line_len < MAX_LINE) {
+      _line[_line_len++] = c;
+    } else {
+      _line_overflow = true;
+    }
+  }
+
+  return static_cast<int>(_reports.size() - count);
+}
+
+
+// !AIVDM,<total>,<number>,<seq id>,<channel>,<payload>,<fill bits>*<checksum>
+void AISParser::parseLine() {
+  const char* line = _line;
+  const char* end = _line + _line_len;
+
+  if (line[0] != '!' || _line_len < 7 || memcmp(line + 3, "VD", 2) != 0 || (line[5] != 'M' && line[5] != 'O'))
+    return;
+
+  _sentences++;
+
+  const char* star = static_cast<const char*>(memchr(line, '*', _line_len));
+  if (star == nullptr || end - star < 3) {
+    _errors++;
+    return;
+  }
+
+  uint8_t sum = 0;
+  for (const char* p = line + 1; p < star; p++)
+    sum ^= static_cast<uint8_t>(*p);
+
+  int hi = hexValue(star[1]), lo = hexValue(star[2]);
+  if (hi < 0 || lo < 0 || sum != ((hi << 4) | lo)) {
+    _errors++;
+    return;
+  }
+
+  const char* fields[MAX_FIELDS + 1];
+  int field_count = 0;
+
+  fields[field_count++] = line;
+  for (const char* p = line; p < star && field_count < MAX_FIELDS; p++)
+    if (*p == ',')
+      fields[field_count++] = p + 1;
+
+  if (field_count < 7) {
+    _errors++;
+    return;
+  }
+  fields[field_count] = star + 1;
+
+  auto fieldEnd = [&fields](int i) { return fields[i+1] - 1; };
+
+  int total = intField(fields[1], fieldEnd(1));
+  int number = intField(fields[2], fieldEnd(2));
+  int seq_id = intField(fields[3], fieldEnd(3));
+  int fill = intField(fields[6], fieldEnd(6));
+
+  const char* payload = fields[5];
+  int payload_len = static_cast<int>(fieldEnd(5) - payload);
+
+  if (total < 1 || number < 1 || number > total || fill < 0 || fill > 5) {
+    _errors++;
+    return;
+  }
+
+  if (total == 1) {
+    decode(payload, payload_len, fill);
+    return;
+  }
+
+  Fragment& frag = _fragments[(seq_id >= 0 && seq_id < SEQ_SLOTS - 1) ? seq_id : SEQ_SLOTS - 1];
+
+  // A new first sentence drops an unfinished message with the same id
+  if (number == 1) {
+    frag.len = 0;
+    frag.next = 1;
+    frag.total = total;
+  }
+
+  if (number != frag.next || total != frag.total || frag.len + payload_len > MAX_PAYLOAD) {
+    frag.next = 1;
+    frag.len = 0;
+    _errors++;
+    return;
+  }
+
+  memcpy(frag.payload + frag.len, payload, payload_len);
+  frag.len += payload_len;
+  frag.next++;
+
+  if (number == total) {
+    decode(frag.payload, frag.len, fill);
+    frag.len = 0;
+    frag.next = 1;
+  }
+}
+
+
+uint32_t AISParser::bits(int start, int count) const {
+  uint32_t v = 0;
+
+  for (int i = start; i < start + count; i++) {
+    int bit = (_sixbits[i / 6] >> (5 - i % 6)) & 1;
+    v = (v << 1) | static_cast<uint32_t>(bit);
+  }
+
+  return v;
+}
+
+int32_t AISParser::signedBits(int start, int count) const {
+  uint32_t v = bits(start, count);
+  if (v & (1u << (count - 1)))
+    return static_cast<int32_t>(v) - static_cast<int32_t>(1u << count);
+  return static_cast<int32_t>(v);
+}
+
+
+void AISParser::decode(const char* payload, int len, int fill) {
+  for (int i = 0; i < len; i++) {
+    int c = static_cast<uint8_t>(payload[i]) - 48;
+    if (c < 0 || c > 71 || (c > 39 && c < 48)) {
+      _errors++;
+      return;
+    }
+    _sixbits[i] = static_cast<uint8_t>(c >= 48 ? c - 8 : c);
+  }
+
+  _bit_count = 6*len - fill;
+  _messages++;
+
+  if (_bit_count < 38)
+    return;
+
+  AISReport r;
+  r.type = static_cast<int>(bits(0, 6));
+  r.mmsi = bits(8, 30);
+  r.sog = -1;
+  r.cog = -1;
+  r.heading = -1;
+  r.rot = 0;
+
+  // Bit offsets of speed, longitude, latitude, course and heading
+  int sog_at, lon_at, lat_at, cog_at, hdg_at, min_bits;
+
+  switch (r.type) {
+  case 1: case 2: case 3:
+    sog_at = 50; lon_at = 61; lat_at = 89; cog_at = 116; hdg_at = 128; min_bits = 137;
+    break;
+  case 18: case 19:
+    sog_at = 46; lon_at = 57; lat_at = 85; cog_at = 112; hdg_at = 124; min_bits = 133;
+    break;
+  case 27: {
+    if (_bit_count < 94)
+      return;
+
+    int32_t lon = signedBits(44, 18);
+    int32_t lat = signedBits(62, 17);
+    uint32_t sog = bits(79, 6);
+    uint32_t cog = bits(85, 9);
+
+    if (lon == 181*600 || lat == 91*600)
+      return;
+
+    r.lon = lon / 600.0;
+    r.lat = lat / 600.0;
+    r.sog = (sog == 63) ? -1 : sog;
+    r.cog = (cog == 511) ? -1 : cog;
+    _reports.push_back(r);
+    return;
+  }
+  default:
+    return;
+  }
+
+  if (_bit_count < min_bits)
+    return;
+
+  int32_t lon = signedBits(lon_at, 28);
+  int32_t lat = signedBits(lat_at, 27);
+  if (lon == 181*600000 || lat == 91*600000)
+    return;
+
+  r.lon = lon / 600000.0;
+  r.lat = lat / 600000.0;
+
+  uint32_t sog = bits(sog_at, 10);
+  uint32_t cog = bits(cog_at, 12);
+  uint32_t hdg = bits(hdg_at, 9);
+
+  r.sog = (sog == 1023) ? -1 : sog / 10.0;
+  r.cog = (cog >= 3600) ? -1 : cog / 10.0;
+  r.heading = (hdg >= 360) ? -1 : hdg;
+
+  if (r.type <= 3) {
+    int32_t rot = signedBits(42, 8);
+    if (rot != -128) {
+      double v = rot / 4.733;
+      r.rot = (rot < 0) ? -v*v : v*v;
+    }
+  }
+
+  _reports.push_back(r);
+}
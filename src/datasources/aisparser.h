@@ -0,0 +1,75 @@
+#ifndef AISPARSER_H
+#define AISPARSER_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+// Позиционное сообщение АИС
+struct AISReport {
+  uint32_t mmsi;
+  int type;
+  double lat, lon;    // Degrees
+  double sog;         // Knots, -1 if not available
+  double cog;         // Degrees, -1 if not available
+  double heading;     // Degrees, -1 if not available
+  double rot;         // Degrees per minute, 0 if not available
+};
+
+
+// Разбор потока NMEA-0183 с сообщениями АИС (!xxVDM, !xxVDO).
+// Input may be cut anywhere, partial lines are kept until the next call.
+// Multi-sentence messages are reassembled by sequential message id.
+// Position reports of types 1, 2, 3, 18, 19 and 27 are decoded, others are counted and skipped.
+// All buffers are fixed, reports are appended to a vector which keeps its capacity,
+// so after the first batches parsing does not allocate.
+class AISParser {
+public:
+  AISParser();
+
+  // Returns number of reports added
+  int parse(const char* data, size_t len);
+
+  inline const std::vector<AISReport>& reports() const { return _reports; }
+  inline void clearReports() { _reports.clear(); }
+
+  inline uint64_t sentenceCount() const { return _sentences; }
+  inline uint64_t messageCount()  const { return _messages; }
+  inline uint64_t errorCount()    const { return _errors; }
+
+private:
+  enum { MAX_LINE = 128
+       , MAX_PAYLOAD = 384
+       , MAX_FIELDS = 8
+       , SEQ_SLOTS = 11 };   // Ids 0..9 and messages without id
+
+  struct Fragment {
+    char payload[MAX_PAYLOAD];
+    int len;
+    int next;
+    int total;
+  };
+
+  void parseLine();
+  void decode(const char* payload, int len, int fill);
+
+  inline uint32_t bits(int start, int count) const;
+  inline int32_t signedBits(int start, int count) const;
+
+  char _line[MAX_LINE];
+  int _line_len;
+  bool _line_overflow;
+
+  Fragment _fragments[SEQ_SLOTS];
+
+  uint8_t _sixbits[MAX_PAYLOAD];
+  int _bit_count;
+
+  std::vector<AISReport> _reports;
+
+  uint64_t _sentences;
+  uint64_t _messages;
+  uint64_t _errors;
+};
+
+#endif // AISPARSER_H
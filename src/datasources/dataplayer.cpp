@@ -0,0 +1,150 @@
+#include "dataplayer.h"
+#include "../common/properties.h"
+
+#include <QFile>
+#include <QDebug>
+#include <QDateTime>
+#include <QCoreApplication>
+
+
+DataPlayer::DataPlayer(const QString& path, int records, QObject* parent)
+  : QThread(parent), _path(path), _records(records) {
+}
+
+DataPlayer::~DataPlayer() {
+  stop();
+  wait();
+}
+
+void DataPlayer::setTargetFeed(TargetFeed* feed) {
+  _feed = feed;
+}
+
+void DataPlayer::stop() {
+  _stop = true;
+}
+
+
+void DataPlayer::run() {
+  QFile file(_path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Replay: can't open" << _path;
+    return;
+  }
+
+  DataFileHeader header;
+  if ( file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+    || header.magic != DATA_RECORD_MAGIC || header.version != DATA_RECORD_VERSION ) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Replay: wrong file" << _path;
+    return;
+  }
+
+  _peleng_count = static_cast<int>(header.pel_count);
+  _peleng_len = static_cast<int>(header.pel_len);
+
+  if (_records & RADAR) {
+    int pel_count = qApp->property(PROPERTY_BEARINGS_PER_CYCLE).toInt();
+    int pel_len = qApp->property(PROPERTY_PELENG_SIZE).toInt();
+
+    if (pel_count != _peleng_count || pel_len != _peleng_len) {
+      qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Replay: radar was recorded with"
+               << _peleng_count << "x" << _peleng_len << "pelengs, use -b and -p to play it";
+      _records &= ~RADAR;
+    } else {
+      _ring.assign(static_cast<size_t>(_peleng_count) * _peleng_len, 0.f);
+    }
+  }
+
+  _clock.start();
+
+  QByteArray payload;
+  DataRecordHeader record;
+  quint64 played = 0;
+
+  while (!_stop.load()) {
+    if (file.read(reinterpret_cast<char*>(&record), sizeof(record)) != sizeof(record))
+      break;
+
+    int type = record.type == RECORD_RADAR ? RADAR : record.type == RECORD_SHIP ? SHIP : record.type == RECORD_TARGETS ? TARGETS : 0;
+    if (!(_records & type)) {
+      if (!file.seek(file.pos() + record.size))
+        break;
+      continue;
+    }
+
+    payload.resize(static_cast<int>(record.size));
+    if (file.read(payload.data(), record.size) != record.size)
+      break;
+
+    if (!waitUntil(record.time_us))
+      break;
+
+    switch (type) {
+    case RADAR:
+      playRadar(payload);
+      break;
+
+    case SHIP: {
+      RLIShipState state;
+      if (DataRecord::decodeShip(payload, state))
+        emit shipStateChanged(state);
+      break;
+    }
+
+    case TARGETS:
+      if (_feed != nullptr && DataRecord::decodeTargets(payload, _feed)) {
+        _targets_pending = true;
+        publishTargets();
+      }
+      break;
+    }
+
+    played++;
+  }
+
+  // Targets the renderer had not taken at the end
+  while (_targets_pending && !_stop.load()) {
+    msleep(WAIT_SLICE);
+    publishTargets();
+  }
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+           << "Replay of" << _path << "finished," << played << "records in" << _clock.elapsed() / 1000.0 << "s";
+}
+
+// Sleeps by slices, so stop() and unpublished targets are looked after
+bool DataPlayer::waitUntil(qint64 time_us) {
+  for (;;) {
+    if (_stop.load())
+      return false;
+
+    qint64 left = time_us - _clock.nsecsElapsed() / 1000;
+    if (left <= 0)
+      return true;
+
+    if (_targets_pending)
+      publishTargets();
+
+    usleep(static_cast<unsigned long>(qMin<qint64>(left, WAIT_SLICE * 1000)));
+  }
+}
+
+void DataPlayer::playRadar(const QByteArray& payload) {
+  int offset, count;
+  if (!DataRecord::decodeRadarHeader(payload, offset, count) || count <= 0)
+    return;
+
+  // Blocks never wrap the circle in the sources, others are skipped
+  offset %= _peleng_count;
+  if (offset + count > _peleng_count)
+    return;
+
+  GLfloat* amps = &_ring[static_cast<size_t>(offset) * _peleng_len];
+  if (DataRecord::decodeRadar(payload, _peleng_len, amps))
+    emit updateRadarData(offset, count, amps);
+}
+
+void DataPlayer::publishTargets() {
+  if (_feed->publish())
+    _targets_pending = false;
+}
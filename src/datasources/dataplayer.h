@@ -0,0 +1,61 @@
+#ifndef DATAPLAYER_H
+#define DATAPLAYER_H
+
+#include <QThread>
+#include <QString>
+#include <QElapsedTimer>
+#include <QOpenGLFunctions>
+
+#include <atomic>
+#include <vector>
+
+#include "datarecord.h"
+
+// Воспроизведение записи DataRecorder в своём потоке.
+// Records of the chosen types are sent at the times they were recorded, counted from start().
+// Radar blocks go out with updateRadarData from a ring of one revolution, so a block
+// stays valid for a revolution as with the other sources. Target changes are put into
+// the feed given by setTargetFeed and published from this thread, which becomes its producer.
+class DataPlayer : public QThread {
+  Q_OBJECT
+
+public:
+  enum { RADAR = 1, SHIP = 2, TARGETS = 4 };
+
+  DataPlayer(const QString& path, int records, QObject* parent = nullptr);
+  virtual ~DataPlayer();
+
+  void setTargetFeed(TargetFeed* feed);
+
+  // Thread-safe, run() returns within WAIT_SLICE ms
+  void stop();
+
+signals:
+  // Emitted from the player thread
+  void updateRadarData(int offset, int count, GLfloat* amps);
+  void shipStateChanged(RLIShipState state);
+
+protected:
+  void run() override;
+
+private:
+  enum { WAIT_SLICE = 50 };
+
+  bool waitUntil(qint64 time_us);
+  void playRadar(const QByteArray& payload);
+  void publishTargets();
+
+  QString _path;
+  int _records;
+  TargetFeed* _feed = nullptr;
+  bool _targets_pending = false;
+
+  std::atomic<bool> _stop { false };
+  QElapsedTimer _clock;
+
+  int _peleng_count = 0;
+  int _peleng_len = 0;
+  std::vector<GLfloat> _ring;
+};
+
+#endif // DATAPLAYER_H
@@ -0,0 +1,166 @@
+#include "datarecord.h"
+
+#include <cstring>
+
+namespace {
+
+template <typename T>
+inline void put(QByteArray& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+inline bool get(const char*& p, const char* end, T& value) {
+  if (end - p < static_cast<ptrdiff_t>(sizeof(T)))
+    return false;
+
+  memcpy(&value, p, sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+
+const int TARGET_BYTES = 2*sizeof(quint32) + 8*sizeof(double);
+
+}
+
+
+void DataRecord::encodeRadar(int offset, int count, int pel_len, const GLfloat* amps, QByteArray& out) {
+  put(out, static_cast<quint32>(offset));
+  put(out, static_cast<quint32>(count));
+
+  // Amplitudes are compared as words, so -0.f and NaNs are kept as they are
+  const quint32* words = reinterpret_cast<const quint32*>(amps);
+  int n = count * pel_len;
+  int i = 0;
+
+  while (i < n) {
+    int zeros = 0;
+    while (i + zeros < n && zeros < 0xFFFF && words[i + zeros] == 0)
+      zeros++;
+    i += zeros;
+
+    int literals = 0;
+    while (i + literals < n && literals < 0xFFFF && words[i + literals] != 0)
+      literals++;
+
+    put(out, static_cast<quint16>(zeros));
+    put(out, static_cast<quint16>(literals));
+    out.append(reinterpret_cast<const char*>(words + i), literals * static_cast<int>(sizeof(quint32)));
+    i += literals;
+  }
+}
+
+bool DataRecord::decodeRadarHeader(const QByteArray& payload, int& offset, int& count) {
+  const char* p = payload.constData();
+  const char* end = p + payload.size();
+
+  quint32 off, cnt;
+  if (!get(p, end, off) || !get(p, end, cnt))
+    return false;
+
+  offset = static_cast<int>(off);
+  count = static_cast<int>(cnt);
+  return true;
+}
+
+bool DataRecord::decodeRadar(const QByteArray& payload, int pel_len, GLfloat* amps) {
+  const char* p = payload.constData();
+  const char* end = p + payload.size();
+
+  quint32 offset, count;
+  if (!get(p, end, offset) || !get(p, end, count))
+    return false;
+
+  quint32* words = reinterpret_cast<quint32*>(amps);
+  size_t n = static_cast<size_t>(count) * pel_len;
+  size_t i = 0;
+
+  while (i < n) {
+    quint16 zeros, literals;
+    if (!get(p, end, zeros) || !get(p, end, literals))
+      return false;
+
+    size_t bytes = literals * sizeof(quint32);
+    if (i + zeros + literals > n || static_cast<size_t>(end - p) < bytes)
+      return false;
+
+    memset(words + i, 0, zeros * sizeof(quint32));
+    i += zeros;
+    memcpy(words + i, p, bytes);
+    i += literals;
+    p += bytes;
+  }
+
+  return true;
+}
+
+
+void DataRecord::encodeShip(const RLIShipState& state, QByteArray& out) {
+  put(out, state.position.lat);
+  put(out, state.position.lon);
+  put(out, state.course);
+  put(out, state.speed);
+}
+
+bool DataRecord::decodeShip(const QByteArray& payload, RLIShipState& state) {
+  const char* p = payload.constData();
+  const char* end = p + payload.size();
+
+  return get(p, end, state.position.lat) && get(p, end, state.position.lon)
+      && get(p, end, state.course) && get(p, end, state.speed);
+}
+
+
+void DataRecord::encodeTargets(const TargetBatch& batch, QByteArray& out) {
+  out.reserve(out.size() + static_cast<int>(sizeof(quint32)) + batch.size() * TARGET_BYTES);
+  put(out, static_cast<quint32>(batch.size()));
+
+  for (int i = 0; i < batch.size(); i++) {
+    const RLITarget& t = batch.targets[i];
+    quint32 flags = (batch.removed[i] ? TARGET_REMOVED : 0) | (t.lost ? TARGET_LOST : 0);
+
+    put(out, batch.ids[i]);
+    put(out, flags);
+    put(out, t.latitude);
+    put(out, t.longtitude);
+    put(out, t.heading);
+    put(out, t.rotation);
+    put(out, t.course_grnd);
+    put(out, t.speed_grnd);
+    put(out, t.cpa);
+    put(out, t.tcpa);
+  }
+}
+
+bool DataRecord::decodeTargets(const QByteArray& payload, TargetFeed* feed) {
+  const char* p = payload.constData();
+  const char* end = p + payload.size();
+
+  quint32 count;
+  if (!get(p, end, count) || static_cast<quint32>((end - p) / TARGET_BYTES) < count)
+    return false;
+
+  for (quint32 i = 0; i < count; i++) {
+    quint32 id, flags;
+    RLITarget t;
+
+    get(p, end, id);
+    get(p, end, flags);
+    get(p, end, t.latitude);
+    get(p, end, t.longtitude);
+    get(p, end, t.heading);
+    get(p, end, t.rotation);
+    get(p, end, t.course_grnd);
+    get(p, end, t.speed_grnd);
+    get(p, end, t.cpa);
+    get(p, end, t.tcpa);
+    t.lost = flags & TARGET_LOST;
+
+    if (flags & TARGET_REMOVED)
+      feed->remove(id);
+    else
+      feed->put(id, t);
+  }
+
+  return true;
+}
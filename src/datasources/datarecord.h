@@ -0,0 +1,61 @@
+#ifndef DATARECORD_H
+#define DATARECORD_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QOpenGLFunctions>
+
+#include "shipdatasource.h"
+#include "targetfeed.h"
+
+// Файл записи входных данных (DataRecorder пишет, DataPlayer воспроизводит).
+// The file is a DataFileHeader and records of a DataRecordHeader and `size` bytes
+// of payload, all fields little-endian:
+//   RECORD_RADAR    quint32 offset, quint32 count, then count pelengs of amplitudes
+//                   as runs of 32-bit words: quint16 zeros, quint16 literals, literal words.
+//                   Zero runs make the usual video small, the amplitudes stay exact
+//   RECORD_SHIP     double latitude, longtitude, course, speed
+//   RECORD_TARGETS  quint32 count, then quint32 id, quint32 flags (DataRecordTargetFlags)
+//                   and the 8 doubles of RLITarget from latitude to tcpa per target
+struct DataFileHeader {
+  quint32 magic;      // DATA_RECORD_MAGIC
+  quint32 version;    // DATA_RECORD_VERSION
+  quint32 pel_count;
+  quint32 pel_len;
+};
+
+struct DataRecordHeader {
+  quint32 type;       // DataRecordType
+  quint32 size;       // Payload bytes
+  qint64  time_us;    // Since the start of the recording
+};
+
+static_assert(sizeof(DataFileHeader) == 16, "DataFileHeader must not be padded");
+static_assert(sizeof(DataRecordHeader) == 16, "DataRecordHeader must not be padded");
+
+enum { DATA_RECORD_MAGIC    = 0x52494C52   // "RLIR"
+     , DATA_RECORD_VERSION  = 1 };
+
+enum DataRecordType { RECORD_RADAR    = 1
+                    , RECORD_SHIP     = 2
+                    , RECORD_TARGETS  = 3 };
+
+enum DataRecordTargetFlags { TARGET_REMOVED = 1
+                           , TARGET_LOST    = 2 };
+
+namespace DataRecord {
+  // Payload encoders append to out
+  void encodeRadar(int offset, int count, int pel_len, const GLfloat* amps, QByteArray& out);
+  void encodeShip(const RLIShipState& state, QByteArray& out);
+  void encodeTargets(const TargetBatch& batch, QByteArray& out);
+
+  // Decoders return false on a broken payload.
+  // Radar amplitudes are written to amps, which must hold count pelengs of pel_len
+  bool decodeRadarHeader(const QByteArray& payload, int& offset, int& count);
+  bool decodeRadar(const QByteArray& payload, int pel_len, GLfloat* amps);
+  bool decodeShip(const QByteArray& payload, RLIShipState& state);
+  // Applies the targets to the producer side of the feed
+  bool decodeTargets(const QByteArray& payload, TargetFeed* feed);
+}
+
+#endif // DATARECORD_H
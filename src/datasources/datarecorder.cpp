@@ -0,0 +1,246 @@
+#include "datarecorder.h"
+#include "../common/properties.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+DataRecorder::DataRecorder(const QString& path, int pel_count, int pel_len, QObject* parent)
+  : QThread(parent), _path(path), _peleng_count(pel_count), _peleng_len(pel_len) {
+  _cells.reset(new Cell[QUEUE_SIZE]);
+  for (size_t i = 0; i < QUEUE_SIZE; i++) {
+    _cells[i].seq.store(i, std::memory_order_relaxed);
+    _cells[i].record = nullptr;
+  }
+
+  _stat = qApp != nullptr && qApp->property(PROPERTY_RADAR_STAT).toBool();
+  _clock.start();
+}
+
+DataRecorder::~DataRecorder() {
+  stop();
+  wait();
+
+  // Records pushed after the writer stopped
+  while (Record* record = pop())
+    delete record;
+}
+
+void DataRecorder::stop() {
+  _stop = true;
+}
+
+
+bool DataRecorder::push(Record* record) {
+  size_t pos = _push_pos.load(std::memory_order_relaxed);
+
+  for (;;) {
+    Cell& cell = _cells[pos % QUEUE_SIZE];
+    size_t seq = cell.seq.load(std::memory_order_acquire);
+    qint64 diff = static_cast<qint64>(seq) - static_cast<qint64>(pos);
+
+    if (diff == 0) {
+      if (_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        cell.record = record;
+        cell.seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // Full
+      return false;
+    } else {
+      pos = _push_pos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+DataRecorder::Record* DataRecorder::pop() {
+  Cell& cell = _cells[_pop_pos % QUEUE_SIZE];
+  if (cell.seq.load(std::memory_order_acquire) != _pop_pos + 1)
+    return nullptr;
+
+  Record* record = cell.record;
+  cell.seq.store(_pop_pos + QUEUE_SIZE, std::memory_order_release);
+  _pop_pos++;
+  return record;
+}
+
+
+void DataRecorder::recordRadar(int offset, int count, GLfloat* amps) {
+  qint64 bytes = static_cast<qint64>(count) * _peleng_len * sizeof(GLfloat);
+  if (_stop.load() || _backlog_bytes.load(std::memory_order_relaxed) + bytes > MAX_BACKLOG) {
+    _dropped++;
+    return;
+  }
+
+  // Only a copy is made here, the encoding is left to the writer
+  Record* record = new Record { RECORD_RADAR, _clock.nsecsElapsed() / 1000, offset, count
+                              , QByteArray(reinterpret_cast<const char*>(amps), static_cast<int>(bytes)) };
+
+  _backlog_bytes += bytes;
+  _backlog_records++;
+  if (!push(record)) {
+    _backlog_bytes -= bytes;
+    _backlog_records--;
+    _dropped++;
+    delete record;
+  }
+}
+
+void DataRecorder::recordShip(const RLIShipState& state) {
+  Record* record = new Record { RECORD_SHIP, _clock.nsecsElapsed() / 1000, 0, 0, QByteArray() };
+  DataRecord::encodeShip(state, record->data);
+
+  _backlog_records++;
+  if (_stop.load() || !push(record)) {
+    _backlog_records--;
+    _dropped++;
+    delete record;
+  }
+}
+
+void DataRecorder::recordTargets(const TargetBatch& batch) {
+  if (batch.empty())
+    return;
+
+  Record* record = new Record { RECORD_TARGETS, _clock.nsecsElapsed() / 1000, 0, 0, QByteArray() };
+  DataRecord::encodeTargets(batch, record->data);
+
+  _backlog_records++;
+  if (_stop.load() || !push(record)) {
+    _backlog_records--;
+    _dropped++;
+    delete record;
+  }
+}
+
+
+void DataRecorder::run() {
+  _fd = ::open(_path.toLocal8Bit().constData(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (_fd < 0) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Recorder: can't open" << _path << strerror(errno);
+    return;
+  }
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Recording to" << _path;
+
+  _out.reserve(WRITE_CHUNK + 64*1024);
+
+  DataFileHeader header { DATA_RECORD_MAGIC, DATA_RECORD_VERSION
+                        , static_cast<quint32>(_peleng_count), static_cast<quint32>(_peleng_len) };
+  _out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  _stat_timer.start();
+  _flush_timer.start();
+
+  for (;;) {
+    Record* record = pop();
+
+    if (record == nullptr) {
+      if (_stop.load())
+        break;
+
+      // A slow stream reaches the disk at least every FLUSH_INTERVAL
+      if (!_out.isEmpty() && _flush_timer.elapsed() >= FLUSH_INTERVAL)
+        flush();
+
+      msleep(IDLE_SLEEP);
+    } else {
+      write(record);
+      delete record;
+
+      if (_out.size() >= WRITE_CHUNK)
+        flush();
+    }
+
+    if (_stat && _stat_timer.elapsed() >= STAT_INTERVAL)
+      logStat(false);
+  }
+
+  flush();
+  ::close(_fd);
+  _fd = -1;
+
+  logStat(true);
+}
+
+void DataRecorder::write(Record* record) {
+  int start = _out.size();
+
+  DataRecordHeader header { static_cast<quint32>(record->type), 0, record->time_us };
+  _out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  if (record->type == RECORD_RADAR)
+    DataRecord::encodeRadar( record->offset, record->count, _peleng_len
+                           , reinterpret_cast<const GLfloat*>(record->data.constData()), _out );
+  else
+    _out.append(record->data);
+
+  // The payload size is known after the encoding
+  quint32 size = static_cast<quint32>(_out.size() - start - static_cast<int>(sizeof(header)));
+  memcpy(_out.data() + start + offsetof(DataRecordHeader, size), &size, sizeof(size));
+
+  if (record->type == RECORD_RADAR)
+    _backlog_bytes -= record->data.size();
+  _backlog_records--;
+
+  _records++;
+  _in_bytes += record->data.size();
+}
+
+void DataRecorder::flush() {
+  const char* p = _out.constData();
+  qint64 left = _out.size();
+
+  while (left > 0 && _fd >= 0) {
+    ssize_t n = ::write(_fd, p, static_cast<size_t>(left));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+
+      qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Recorder: write failed" << strerror(errno);
+      break;
+    }
+
+    p += n;
+    left -= n;
+    _written_bytes += n;
+  }
+
+  _out.resize(0);
+  _flush_timer.restart();
+}
+
+void DataRecorder::logStat(bool final) {
+  double secs = qMax<qint64>(1, _stat_timer.elapsed()) / 1000.0;
+
+  if (final) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+             << "Recorder:" << _records << "records," << _in_bytes / (1024*1024) << "MB of data written as"
+             << _written_bytes / (1024*1024) << "MB," << _dropped.load() << "dropped";
+    return;
+  }
+
+  qint64 in = _in_bytes - _stat_in_bytes;
+  qint64 written = _written_bytes - _stat_written_bytes;
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+           << "Recorder:" << qRound((_records - _stat_records) / secs) << "records/s,"
+           << QString("in %1 MB/s, written %2 MB/s (%3%),").arg(in / secs / 1e6, 0, 'f', 2)
+                                                         .arg(written / secs / 1e6, 0, 'f', 2)
+                                                         .arg(in > 0 ? 100.0 * written / in : 0.0, 0, 'f', 1)
+           << "backlog" << _backlog_records.load() << "records" << _backlog_bytes.load() / 1024 << "KB,"
+           << _dropped.load() << "dropped";
+
+  _stat_records = _records;
+  _stat_in_bytes = _in_bytes;
+  _stat_written_bytes = _written_bytes;
+  _stat_timer.restart();
+}
@@ -0,0 +1,99 @@
+#ifndef DATARECORDER_H
+#define DATARECORDER_H
+
+#include <QThread>
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QOpenGLFunctions>
+
+#include <atomic>
+#include <memory>
+
+#include "datarecord.h"
+
+// Запись входных данных в файл (see datarecord.h) для воспроизведения DataPlayer.
+// Producers copy the data into a record and push it to a bounded lock-free queue,
+// they may be any threads and never wait: when the queue or the backlog limit is full
+// the record is dropped and counted. The writer thread encodes records and writes
+// them by WRITE_CHUNK, so the disk sees few large writes.
+class DataRecorder : public QThread {
+  Q_OBJECT
+
+public:
+  DataRecorder(const QString& path, int pel_count, int pel_len, QObject* parent = nullptr);
+  virtual ~DataRecorder();
+
+  // Thread-safe, the writer stores the queued records and returns
+  void stop();
+
+  // Thread-safe, may be called from any producer
+  void recordTargets(const TargetBatch& batch);
+
+public slots:
+  // Meant for Qt::DirectConnection, they run in the producer thread
+  void recordRadar(int offset, int count, GLfloat* amps);
+  void recordShip(const RLIShipState& state);
+
+protected:
+  void run() override;
+
+private:
+  enum { QUEUE_SIZE     = 4096
+       , WRITE_CHUNK    = 4*1024*1024
+       , MAX_BACKLOG    = 64*1024*1024
+       , IDLE_SLEEP     = 2
+       , FLUSH_INTERVAL = 1000
+       , STAT_INTERVAL  = 5000 };
+
+  struct Record {
+    DataRecordType type;
+    qint64 time_us;
+    int offset, count;
+    QByteArray data;
+  };
+
+  // Bounded multi-producer queue, a cell sequence tells whose turn the cell is
+  struct Cell {
+    std::atomic<size_t> seq;
+    Record* record;
+  };
+
+  bool push(Record* record);
+  Record* pop();
+
+  void write(Record* record);
+  void flush();
+  void logStat(bool final);
+
+  QString _path;
+  int _peleng_count;
+  int _peleng_len;
+
+  std::atomic<bool> _stop { false };
+  QElapsedTimer _clock;
+
+  std::unique_ptr<Cell[]> _cells;
+  std::atomic<size_t> _push_pos { 0 };
+  size_t _pop_pos = 0;
+
+  // Writer side
+  int _fd = -1;
+  QByteArray _out;
+  QElapsedTimer _flush_timer;
+
+  // Statistics, the backlog is the queued payload
+  bool _stat;
+  std::atomic<qint64> _backlog_bytes { 0 };
+  std::atomic<qint64> _backlog_records { 0 };
+  std::atomic<quint64> _dropped { 0 };
+  quint64 _records = 0;
+  qint64 _in_bytes = 0;
+  qint64 _written_bytes = 0;
+  QElapsedTimer _stat_timer;
+  quint64 _stat_records = 0;
+  qint64 _stat_in_bytes = 0;
+  qint64 _stat_written_bytes = 0;
+};
+
+#endif // DATARECORDER_H
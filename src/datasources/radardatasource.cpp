@@ -1,4 +1,6 @@
 #include "radardatasource.h"
+#include "radarudpreceiver.h"
+#include "dataplayer.h"
 #include "../mainwindow.h"
 
 #include "../common/properties.h"
@@ -24,11 +26,15 @@ RadarDataSource::RadarDataSource(QObject* parent) : QObject(parent) {
   _bearings_per_cycle  = qApp->property(PROPERTY_BEARINGS_PER_CYCLE).toInt();
   _timer_period        = qApp->property(PROPERTY_DATA_DELAY).toInt();
   _blocks_to_send      = qApp->property(PROPERTY_BLOCK_SIZE).toInt();
+  _source              = qApp->property(PROPERTY_RADAR_SOURCE).toString();
+  _replay              = qApp->property(PROPERTY_REPLAY).toString();
+
+  // The receiver and the player keep their own rings
+  if (!_source.isEmpty() || !_replay.isEmpty())
+    return;
 
   file_amps1[0] = new GLfloat[_peleng_size*_bearings_per_cycle];
   file_amps1[1] = new GLfloat[_peleng_size*_bearings_per_cycle];
-  file_amps2[0] = new GLfloat[_peleng_size*_bearings_per_cycle];
-  file_amps2[1] = new GLfloat[_peleng_size*_bearings_per_cycle];
 
   loadData();
 }
@@ -38,16 +44,51 @@ RadarDataSource::~RadarDataSource() {
 
   delete file_amps1[0];
   delete file_amps1[1];
-  delete file_amps2[0];
-  delete file_amps2[1];
 }
 
 void RadarDataSource::start() {
+  if (!_replay.isEmpty()) {
+    if (_player == nullptr) {
+      _player = new DataPlayer(_replay, DataPlayer::RADAR);
+      connect( _player, SIGNAL(updateRadarData(int, int, GLfloat*))
+             , this, SIGNAL(updateRadarData(int, int, GLfloat*))
+             , Qt::DirectConnection );
+      _player->start();
+    }
+    return;
+  }
+
+  if (!_source.isEmpty()) {
+    if (_receiver == nullptr) {
+      _receiver = new RadarUdpReceiver(_bearings_per_cycle, _peleng_size, _source);
+      // Re-emitted in the receiver thread, the receivers are queued
+      connect( _receiver, SIGNAL(updateRadarData(int, int, GLfloat*))
+             , this, SIGNAL(updateRadarData(int, int, GLfloat*))
+             , Qt::DirectConnection );
+      _receiver->start();
+    }
+    return;
+  }
+
   if (_timerId == -1)
     _timerId = startTimer(_timer_period, Qt::PreciseTimer);
 }
 
 void RadarDataSource::finish() {
+  if (_player != nullptr) {
+    _player->stop();
+    _player->wait();
+    delete _player;
+    _player = nullptr;
+  }
+
+  if (_receiver != nullptr) {
+    _receiver->stop();
+    _receiver->wait();
+    delete _receiver;
+    _receiver = nullptr;
+  }
+
   if (_timerId != -1) {
     killTimer(_timerId);
     _timerId = -1;
@@ -59,11 +100,9 @@ void RadarDataSource::timerEvent(QTimerEvent* e) {
 
   //QtConcurrent::run([&](int offset, int file) {
   //  emit updateRadarData(offset, _blocks_to_send, &file_amps1[file][offset * _peleng_size]);
-  //  emit updateTrailData(offset, _blocks_to_send, &file_amps2[file][offset * _peleng_size]);
   //}, _offset, _file);
 
   emit updateRadarData(_offset, _blocks_to_send, &file_amps1[_file][_offset * _peleng_size]);
-  emit updateTrailData(_offset, _blocks_to_send, &file_amps2[_file][_offset * _peleng_size]);
 
   _offset = (_offset + _blocks_to_send) % _bearings_per_cycle;
   if (_offset == 0) _file = 1 - _file;
@@ -86,12 +125,6 @@ bool RadarDataSource::loadData() {
   if (!initWithDummy2(file_amps1[1]))
     return false;
 
-  if (!initWithDummy3(file_amps2[1]))
-    return false;
-
-  if (!initWithDummy4(file_amps2[0]))
-    return false;
-
   return true;
 }
 
@@ -147,25 +180,3 @@ bool RadarDataSource::initWithDummy2(GLfloat* amps) {
 
   return true;
 }
-
-bool RadarDataSource::initWithDummy3(GLfloat* amps) {
-  for (int i = 0; i < _bearings_per_cycle; i++)
-    for (int j = 0; j < _peleng_size; j++)
-      if (i % 256 < 137 && i % 256 > 121)
-        amps[i*_peleng_size+j] = (255.f * j) / _peleng_size;
-      else
-        amps[i*_peleng_size+j] = 0.f;
-
-  return true;
-}
-
-bool RadarDataSource::initWithDummy4(GLfloat* amps) {
-  for (int i = 0; i < _bearings_per_cycle; i++)
-    for (int j = 0; j < _peleng_size; j++)
-      if (j > 131 && j < 140)
-        amps[i*_peleng_size+j] = 255.f - (255.f * i) / _bearings_per_cycle;
-      else
-        amps[i*_peleng_size+j] = 0.f;
-
-  return true;
-}
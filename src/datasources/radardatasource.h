@@ -8,6 +8,12 @@
 #include <QtGlobal>
 #include <QOpenGLFunctions>
 
+class RadarUdpReceiver;
+class DataPlayer;
+
+// Источник радарного видео: two simulated revolutions by a timer,
+// with PROPERTY_RADAR_SOURCE set pelengs received over UDP by RadarUdpReceiver
+// or, with PROPERTY_REPLAY set, a recording played by DataPlayer
 class RadarDataSource : public QObject {
   Q_OBJECT
 public:
@@ -20,7 +26,6 @@ public slots:
 
 signals:
   void updateRadarData(int offset, int count, GLfloat* amps);
-  void updateTrailData(int offset, int count, GLfloat* amps);
 
 protected slots:
   void timerEvent(QTimerEvent* e);
@@ -32,13 +37,16 @@ private:
 
   bool initWithDummy1(float* amps);
   bool initWithDummy2(float* amps);
-  bool initWithDummy3(float* amps);
-  bool initWithDummy4(float* amps);
 
   int _timerId = -1;
 
-  GLfloat* file_amps1[2];
-  GLfloat* file_amps2[2];
+  QString _source;
+  RadarUdpReceiver* _receiver = nullptr;
+
+  QString _replay;
+  DataPlayer* _player = nullptr;
+
+  GLfloat* file_amps1[2] { nullptr, nullptr };
 
   int _timer_period;
   int _blocks_to_send;
@@ -0,0 +1,24 @@
+#ifndef RADARPACKET_H
+#define RADARPACKET_H
+
+#include <QtGlobal>
+
+// Пакет радарного видео по UDP.
+// One datagram is a header and `count` float amplitudes of one peleng, samples
+// [first, first + count). A peleng is split into fragments of equal length, the last
+// one is shorter, so a datagram fits into the Ethernet MTU. All fields are little-endian.
+struct RadarPacketHeader {
+  quint32 magic;      // RADAR_PACKET_MAGIC
+  quint32 seq;        // Packet number, loss is counted by its gaps
+  quint16 bearing;    // Peleng index in [0, bearings)
+  quint16 bearings;   // Pelengs per revolution
+  quint16 first;      // First sample of the fragment, a multiple of the fragment length
+  quint16 count;      // Samples in the fragment
+};
+
+static_assert(sizeof(RadarPacketHeader) == 16, "RadarPacketHeader must not be padded");
+
+enum { RADAR_PACKET_MAGIC       = 0x31564452   // "RDV1"
+     , RADAR_PACKET_MAX_SAMPLES = 360 };       // 16 + 1440 bytes, fits 1472
+
+#endif // RADARPACKET_H
@@ -0,0 +1,383 @@
+#include "radarudpreceiver.h"
+#include "../common/properties.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QStringList>
+#include <QDebug>
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+RadarUdpReceiver::RadarUdpReceiver(int pel_count, int pel_len, const QString& source, QObject* parent)
+  : QThread(parent), _peleng_count(pel_count), _peleng_len(pel_len), _source(source) {
+  _ring.assign(static_cast<size_t>(pel_count) * pel_len, 0.f);
+  _fragments.assign(pel_count, 0);
+
+  _msgs.resize(BATCH);
+  _iovs.resize(3*BATCH);
+  _headers.resize(BATCH);
+  _spare.resize(BATCH * RADAR_PACKET_MAX_SAMPLES);
+  _stage.resize(BATCH * RADAR_PACKET_MAX_SAMPLES);
+  _slot_bearing.resize(BATCH);
+  _slot_first.resize(BATCH);
+  _slot_len.resize(BATCH);
+  _staged.resize(BATCH);
+
+  _stat = qApp != nullptr && qApp->property(PROPERTY_RADAR_STAT).toBool();
+}
+
+RadarUdpReceiver::~RadarUdpReceiver() {
+  stop();
+  wait();
+}
+
+void RadarUdpReceiver::stop() {
+  _stop = true;
+}
+
+RadarUdpReceiver::Stat RadarUdpReceiver::stat() const {
+  Stat s;
+  s.packets       = _packets.load();
+  s.bad_packets   = _bad_packets.load();
+  s.late_packets  = _late_packets.load();
+  s.duplicates    = _duplicates.load();
+  s.moved         = _moved.load();
+  s.pelengs       = _pelengs.load();
+  s.lost_pelengs  = _lost_pelengs.load();
+
+  quint64 unique = s.packets - s.duplicates;
+  quint64 span = _seq_span.load();
+  s.lost_packets  = span > unique ? span - unique : 0;
+  return s;
+}
+
+
+bool RadarUdpReceiver::openSocket() {
+  // udp:<port> or udp:<address>:<port>
+  QStringList parts = _source.split(":");
+  if (parts.size() < 2 || parts.size() > 3 || parts[0] != "udp") {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar: wrong source" << _source;
+    return false;
+  }
+
+  quint16 port = parts.last().toUShort();
+  in_addr addr;
+  addr.s_addr = htonl(INADDR_ANY);
+  if (parts.size() == 3 && inet_pton(AF_INET, parts[1].toLatin1().constData(), &addr) != 1) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar: wrong address" << _source;
+    return false;
+  }
+  bool multicast = IN_MULTICAST(ntohl(addr.s_addr));
+
+  _fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (_fd < 0)
+    return false;
+
+  int one = 1;
+  setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  // A revolution of 4096x800 samples is ~13 MB, the buffer has to ride out scheduling delays
+  int rcvbuf = 16 << 20;
+  setsockopt(_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+  timeval tv { 0, RECV_TIMEOUT * 1000 };
+  setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr = addr;
+
+  if (bind(_fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar: can't bind" << _source << strerror(errno);
+    close(_fd);
+    _fd = -1;
+    return false;
+  }
+
+  if (multicast) {
+    ip_mreq mreq;
+    mreq.imr_multiaddr = addr;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+      qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar: can't join" << _source << strerror(errno);
+      close(_fd);
+      _fd = -1;
+      return false;
+    }
+  }
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar: receiving from" << _source;
+  return true;
+}
+
+
+void RadarUdpReceiver::run() {
+  if (!openSocket())
+    return;
+
+  _stat_timer.start();
+
+  while (!_stop.load()) {
+    prepareBatch();
+
+    int count = recvmmsg(_fd, _msgs.data(), BATCH, MSG_WAITFORONE, nullptr);
+    if (count < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        continue;
+
+      qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar: receive failed" << strerror(errno);
+      break;
+    }
+
+    handleBatch(count);
+    publish();
+
+    if (_stat && _stat_timer.elapsed() >= STAT_INTERVAL)
+      logStat();
+  }
+
+  close(_fd);
+  _fd = -1;
+}
+
+
+void RadarUdpReceiver::prepareBatch() {
+  int bearing = _next_bearing;
+  int first = _next_first;
+
+  for (int i = 0; i < BATCH; i++) {
+    iovec* iov = &_iovs[3*i];
+    GLfloat* spare = &_spare[static_cast<size_t>(i) * RADAR_PACKET_MAX_SAMPLES];
+
+    iov[0].iov_base = &_headers[i];
+    iov[0].iov_len = sizeof(RadarPacketHeader);
+
+    // The expected fragment goes in place unless it is already there
+    int len = 0;
+    if (_synced && _frag_len > 0 && !(_fragments[bearing] & (1u << (first / _frag_len))))
+      len = std::min(_frag_len, _peleng_len - first);
+
+    _slot_bearing[i] = bearing;
+    _slot_first[i] = first;
+    _slot_len[i] = len;
+
+    int iov_count = 2;
+    if (len > 0) {
+      iov[1].iov_base = &_ring[static_cast<size_t>(bearing) * _peleng_len + first];
+      iov[1].iov_len = len * sizeof(GLfloat);
+      iov[2].iov_base = spare;
+      iov[2].iov_len = RADAR_PACKET_MAX_SAMPLES * sizeof(GLfloat);
+      iov_count = 3;
+    } else {
+      iov[1].iov_base = spare;
+      iov[1].iov_len = RADAR_PACKET_MAX_SAMPLES * sizeof(GLfloat);
+    }
+
+    msghdr& hdr = _msgs[i].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = iov;
+    hdr.msg_iovlen = iov_count;
+    _msgs[i].msg_len = 0;
+
+    if (_frag_len > 0) {
+      first += _frag_len;
+      if (first >= _peleng_len) {
+        first = 0;
+        bearing = (bearing + 1) % _peleng_count;
+      }
+    }
+  }
+}
+
+bool RadarUdpReceiver::checkHeader(const RadarPacketHeader& h, unsigned int size) {
+  if ( h.magic != RADAR_PACKET_MAGIC || h.bearings != _peleng_count || h.bearing >= _peleng_count
+    || h.count == 0 || h.count > RADAR_PACKET_MAX_SAMPLES || h.first + h.count > _peleng_len
+    || size != sizeof(RadarPacketHeader) + h.count * sizeof(GLfloat) )
+    return false;
+
+  // The fragment length is taken from the first fragment 0, a peleng has at most 32 fragments
+  if (_frag_len == 0) {
+    if (h.first != 0)
+      return false;
+
+    int frag_count = (_peleng_len + h.count - 1) / h.count;
+    if (frag_count > 32)
+      return false;
+
+    _frag_len = h.count;
+    _frag_count = frag_count;
+    _complete = (frag_count == 32) ? 0xFFFFFFFFu : ((1u << frag_count) - 1);
+  }
+
+  return h.first % _frag_len == 0 && h.count == std::min(_frag_len, _peleng_len - h.first);
+}
+
+void RadarUdpReceiver::countSeq(quint32 seq) {
+  if (!_seq_synced) {
+    _seq_first = _seq_max = seq;
+    _seq_synced = true;
+  } else {
+    // Wrapping difference to the newest one
+    qint64 s = _seq_max + static_cast<qint32>(seq - static_cast<quint32>(_seq_max));
+    _seq_max = std::max(_seq_max, s);
+  }
+
+  _seq_span = static_cast<quint64>(_seq_max - _seq_first + 1);
+}
+
+void RadarUdpReceiver::handleBatch(int count) {
+  int last_bearing = -1, last_first = 0;
+
+  // First pass: fragments in place are marked, the others are staged, since their
+  // payload may lie where another fragment of the batch belongs
+  for (int i = 0; i < count; i++) {
+    _staged[i] = 0;
+
+    const RadarPacketHeader& h = _headers[i];
+    if ((_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) || !checkHeader(h, _msgs[i].msg_len)) {
+      _bad_packets++;
+      continue;
+    }
+
+    _packets++;
+    countSeq(h.seq);
+
+    if (!_synced) {
+      _synced = true;
+      _publish_next = h.bearing;
+    }
+
+    // Pelengs behind the published one are late, the window ahead of it is open
+    int distance = (h.bearing - _publish_next + _peleng_count) % _peleng_count;
+    if (distance >= _peleng_count - REORDER_WINDOW) {
+      _late_packets++;
+      continue;
+    }
+    _ahead = std::max(_ahead, distance);
+
+    last_bearing = h.bearing;
+    last_first = h.first;
+
+    quint32 bit = 1u << (h.first / _frag_len);
+
+    if (_slot_len[i] > 0 && _slot_bearing[i] == h.bearing && _slot_first[i] == h.first) {
+      _fragments[h.bearing] |= bit;
+      continue;
+    }
+
+    // Payload is in the ring slot then the spare buffer, or in the spare buffer only
+    GLfloat* stage = &_stage[static_cast<size_t>(i) * RADAR_PACKET_MAX_SAMPLES];
+    const GLfloat* spare = &_spare[static_cast<size_t>(i) * RADAR_PACKET_MAX_SAMPLES];
+    int in_slot = std::min<int>(_slot_len[i], h.count);
+
+    if (in_slot > 0)
+      memcpy(stage, &_ring[static_cast<size_t>(_slot_bearing[i]) * _peleng_len + _slot_first[i]], in_slot * sizeof(GLfloat));
+    memcpy(stage + in_slot, spare, (h.count - in_slot) * sizeof(GLfloat));
+
+    _staged[i] = 1;
+  }
+
+  // Second pass: staged fragments go to their places
+  for (int i = 0; i < count; i++) {
+    if (!_staged[i])
+      continue;
+
+    const RadarPacketHeader& h = _headers[i];
+    quint32 bit = 1u << (h.first / _frag_len);
+
+    if (_fragments[h.bearing] & bit) {
+      _duplicates++;
+      continue;
+    }
+
+    memcpy( &_ring[static_cast<size_t>(h.bearing) * _peleng_len + h.first]
+          , &_stage[static_cast<size_t>(i) * RADAR_PACKET_MAX_SAMPLES]
+          , h.count * sizeof(GLfloat) );
+    _fragments[h.bearing] |= bit;
+    _moved++;
+  }
+
+  // The next batch expects the stream to go on after its last fragment
+  if (last_bearing >= 0) {
+    _next_bearing = last_bearing;
+    _next_first = last_first + _frag_len;
+    if (_next_first >= _peleng_len) {
+      _next_first = 0;
+      _next_bearing = (_next_bearing + 1) % _peleng_count;
+    }
+  }
+}
+
+
+void RadarUdpReceiver::publish() {
+  if (!_synced || _frag_len == 0)
+    return;
+
+  int first = _publish_next;
+  int count = 0;
+
+  for (;;) {
+    quint32& frags = _fragments[_publish_next];
+
+    if (frags != _complete) {
+      if (_ahead <= REORDER_WINDOW)
+        break;
+
+      // Lost: what is missing is zeroed
+      GLfloat* peleng = &_ring[static_cast<size_t>(_publish_next) * _peleng_len];
+      for (int f = 0; f < _frag_count; f++)
+        if (!(frags & (1u << f)))
+          std::fill(peleng + f * _frag_len, peleng + std::min(_peleng_len, (f + 1) * _frag_len), 0.f);
+      _lost_pelengs++;
+    } else {
+      _pelengs++;
+    }
+
+    frags = 0;
+    count++;
+    _ahead = std::max(0, _ahead - 1);
+    _publish_next = (_publish_next + 1) % _peleng_count;
+
+    // Blocks do not wrap around the ring
+    if (_publish_next == 0) {
+      emitRange(first, count);
+      first = 0;
+      count = 0;
+    }
+  }
+
+  if (count > 0)
+    emitRange(first, count);
+}
+
+void RadarUdpReceiver::emitRange(int first, int count) {
+  emit updateRadarData(first, count, &_ring[static_cast<size_t>(first) * _peleng_len]);
+}
+
+
+void RadarUdpReceiver::logStat() {
+  Stat s = stat();
+  double secs = _stat_timer.nsecsElapsed() / 1e9;
+
+  quint64 pelengs = s.pelengs - _stat_last.pelengs;
+  quint64 lost = s.lost_pelengs - _stat_last.lost_pelengs;
+  quint64 packets = s.packets - _stat_last.packets;
+  quint64 lost_packets = s.lost_packets - _stat_last.lost_packets;
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+           << "Radar UDP:" << packets / secs << "packets/s," << pelengs / secs << "pelengs/s,"
+           << "lost" << lost_packets << "packets and" << lost << "pelengs,"
+           << s.moved - _stat_last.moved << "moved," << s.late_packets - _stat_last.late_packets << "late,"
+           << s.duplicates - _stat_last.duplicates << "duplicates," << s.bad_packets - _stat_last.bad_packets << "bad";
+
+  _stat_last = s;
+  _stat_timer.restart();
+}
@@ -0,0 +1,115 @@
+#ifndef RADARUDPRECEIVER_H
+#define RADARUDPRECEIVER_H
+
+#include <QThread>
+#include <QString>
+#include <QElapsedTimer>
+#include <QOpenGLFunctions>
+
+#include <atomic>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "radarpacket.h"
+
+// Приём радарного видео по UDP (see RadarPacketHeader) в своём потоке.
+// Source is "udp:<port>", "udp:<address>:<port>" or "udp:<multicast group>:<port>".
+// Datagrams are read by batches of BATCH with recvmmsg. Before a batch is read,
+// the payload buffer of every message points straight into the amplitude ring at the
+// fragment expected next, so an in-order stream is written in place without copies.
+// A fragment which came elsewhere is moved to its place after the batch.
+// Pelengs are published with updateRadarData in bearing order as they become complete.
+// A peleng still incomplete when the stream is REORDER_WINDOW pelengs ahead of it
+// is lost: its missing fragments are zeroed and it is published as is.
+// The ring keeps one revolution, a published block stays valid for a revolution.
+class RadarUdpReceiver : public QThread {
+  Q_OBJECT
+
+public:
+  RadarUdpReceiver(int pel_count, int pel_len, const QString& source, QObject* parent = nullptr);
+  virtual ~RadarUdpReceiver();
+
+  // Thread-safe, run() returns within RECV_TIMEOUT ms
+  void stop();
+
+  struct Stat {
+    quint64 packets       = 0;  // Valid packets
+    quint64 bad_packets   = 0;  // Wrong header or size
+    quint64 lost_packets  = 0;  // Gaps in seq
+    quint64 late_packets  = 0;  // Came after their peleng was published
+    quint64 duplicates    = 0;
+    quint64 moved         = 0;  // Not written in place
+    quint64 pelengs       = 0;  // Published complete
+    quint64 lost_pelengs  = 0;  // Published incomplete
+  };
+  Stat stat() const;
+
+signals:
+  // Emitted from the receiver thread
+  void updateRadarData(int offset, int count, GLfloat* amps);
+
+protected:
+  void run() override;
+
+private:
+  enum { BATCH = 64, REORDER_WINDOW = 64, RECV_TIMEOUT = 100, STAT_INTERVAL = 5000 };
+
+  bool openSocket();
+  void prepareBatch();
+  void handleBatch(int count);
+  bool checkHeader(const RadarPacketHeader& h, unsigned int size);
+  void countSeq(quint32 seq);
+  void publish();
+  void emitRange(int first, int count);
+  void logStat();
+
+  int _peleng_count;
+  int _peleng_len;
+  QString _source;
+  int _fd = -1;
+  std::atomic<bool> _stop { false };
+
+  std::vector<GLfloat> _ring;
+  // Received fragments of every peleng, bit per fragment
+  std::vector<quint32> _fragments;
+  // Samples per fragment, taken from the first fragment 0 received
+  int _frag_len = 0;
+  int _frag_count = 0;
+  quint32 _complete = 0;
+
+  // Next peleng to publish and the farthest peleng received after it
+  bool _synced = false;
+  int _publish_next = 0;
+  int _ahead = 0;
+
+  // Fragment expected next
+  int _next_bearing = 0;
+  int _next_first = 0;
+
+  // Batch buffers. Message i reads the header, then the payload either into the ring
+  // (_slot_len[i] samples at _slot_bearing[i], _slot_first[i]) followed by the spare
+  // buffer, or into the spare buffer only when _slot_len[i] is 0
+  std::vector<mmsghdr> _msgs;
+  std::vector<iovec> _iovs;
+  std::vector<RadarPacketHeader> _headers;
+  std::vector<GLfloat> _spare;
+  std::vector<GLfloat> _stage;
+  std::vector<int> _slot_bearing, _slot_first, _slot_len;
+  std::vector<char> _staged;
+
+  // Sequence numbers, extended to 64 bits
+  bool _seq_synced = false;
+  qint64 _seq_first = 0;
+  qint64 _seq_max = 0;
+
+  std::atomic<quint64> _packets { 0 }, _bad_packets { 0 }, _late_packets { 0 }, _duplicates { 0 }
+                     , _moved { 0 }, _pelengs { 0 }, _lost_pelengs { 0 }, _seq_span { 0 };
+
+  bool _stat;
+  QElapsedTimer _stat_timer;
+  Stat _stat_last;
+};
+
+#endif // RADARUDPRECEIVER_H
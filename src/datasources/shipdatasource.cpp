@@ -1,4 +1,8 @@
 #include "shipdatasource.h"
+#include "dataplayer.h"
+#include "../common/properties.h"
+
+#include <QApplication>
 
 #include <cmath>
 
@@ -29,6 +33,18 @@ void ShipDataSource::timerEvent(QTimerEvent* e) {
 }
 
 void ShipDataSource::start() {
+  QString replay = qApp->property(PROPERTY_REPLAY).toString();
+
+  if (!replay.isEmpty()) {
+    if (_player == nullptr) {
+      _player = new DataPlayer(replay, DataPlayer::SHIP);
+      connect( _player, SIGNAL(shipStateChanged(RLIShipState))
+             , this, SLOT(onReplayedState(RLIShipState)) );
+      _player->start();
+    }
+    return;
+  }
+
   if (_timerId == -1)  {
     _timerId = startTimer(1000);
     _startTime = QDateTime::currentDateTime();
@@ -36,8 +52,20 @@ void ShipDataSource::start() {
 }
 
 void ShipDataSource::finish() {
+  if (_player != nullptr) {
+    _player->stop();
+    _player->wait();
+    delete _player;
+    _player = nullptr;
+  }
+
   if (_timerId != -1) {
     killTimer(_timerId);
     _timerId = -1;
   }
 }
+
+void ShipDataSource::onReplayedState(const RLIShipState& state) {
+  _ship_state = state;
+  emit shipStateChanged(_ship_state);
+}
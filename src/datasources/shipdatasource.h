@@ -8,12 +8,15 @@
 
 #include "../common/rlimath.h"
 
+class DataPlayer;
+
 struct RLIShipState {
   GeoPos position  { 0.0, 0.0 };
   double course    { 0.0 };
   double speed     { 0.0 };
 };
 
+// Источник собственных данных: a simulated circulation or, with PROPERTY_REPLAY set, a recording
 
 class ShipDataSource : public QObject
 {
@@ -34,8 +37,12 @@ public slots:
   void start();
   void finish();
 
+private slots:
+  void onReplayedState(const RLIShipState& state);
+
 private:
   int _timerId = -1;
+  DataPlayer* _player = nullptr;
   QDateTime _startTime;  
 
   RLIShipState _ship_state;
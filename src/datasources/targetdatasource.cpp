@@ -1,9 +1,29 @@
 #include "targetdatasource.h"
+#include "targetfeed.h"
+#include "dataplayer.h"
+#include "../common/properties.h"
 
 #include <qmath.h>
+#include <unistd.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QApplication>
+#include <QSocketNotifier>
+
+static const int TICK_MSECS     = 200;
+// Recorded logs are replayed by this many bytes per tick
+static const int REPLAY_CHUNK   = 16*1024;
+static const int READ_CHUNK     = 64*1024;
 
 
 TargetDataSource::TargetDataSource(QObject *parent) : QObject(parent) {
+  _feed = new TargetFeed();
+  _ais_source = qApp->property(PROPERTY_AIS_SOURCE).toString();
+  _stat = qApp->property(PROPERTY_RADAR_STAT).toBool();
+
   RLITarget trgt;
 
   trgt.lost = false;
@@ -46,27 +66,199 @@ TargetDataSource::TargetDataSource(QObject *parent) : QObject(parent) {
 
 TargetDataSource::~TargetDataSource() {
   finish();
+  delete _feed;
 }
 
 void TargetDataSource::start() {
+  QString replay = qApp->property(PROPERTY_REPLAY).toString();
+
+  if (!replay.isEmpty()) {
+    if (_player == nullptr) {
+      _player = new DataPlayer(replay, DataPlayer::TARGETS);
+      _player->setTargetFeed(_feed);
+      _player->start();
+    }
+    return;
+  }
+
   if (_timerId == -1) {
+    if (!_ais_source.isEmpty() && !openAisSource())
+      return;
+
     _startTime = QDateTime::currentDateTime();
-    _timerId = startTimer(200);
+    _timerId = startTimer(TICK_MSECS);
   }
 }
 
 void TargetDataSource::finish() {
+  if (_player != nullptr) {
+    _player->stop();
+    _player->wait();
+    delete _player;
+    _player = nullptr;
+  }
+
   if (_timerId != -1) {
     killTimer(_timerId);
     _timerId = -1;
   }
-}
 
-const float PI = 3.14159265359f;
+  closeAisSource();
+}
 
 void TargetDataSource::timerEvent(QTimerEvent* e) {
   Q_UNUSED(e);
 
+  if (_ais_source.isEmpty()) {
+    simulate();
+  } else {
+    if (_replay) {
+      qint64 len = _device->read(_read_buffer.data(), REPLAY_CHUNK);
+      if (len > 0)
+        parseAis(_read_buffer.constData(), len);
+    }
+
+    logAisStat();
+  }
+
+  _feed->publish();
+}
+
+
+bool TargetDataSource::openAisSource() {
+  _read_buffer.resize(READ_CHUNK);
+
+  if (_ais_source.startsWith("udp:")) {
+    _udp = new QUdpSocket(this);
+    if (!_udp->bind(QHostAddress::Any, _ais_source.mid(4).toUShort())) {
+      qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "AIS: can't bind" << _ais_source << _udp->errorString();
+      closeAisSource();
+      return false;
+    }
+    connect(_udp, SIGNAL(readyRead()), SLOT(readDatagrams()));
+
+  } else if (_ais_source.startsWith("tcp:")) {
+    QStringList addr = _ais_source.split(":");
+    QTcpSocket* socket = new QTcpSocket(this);
+    socket->connectToHost(addr.value(1), addr.value(2).toUShort());
+    connect(socket, SIGNAL(readyRead()), SLOT(readDevice()));
+    _device = socket;
+
+  } else {
+    QFile* file = new QFile(this);
+    bool ok;
+    if (_ais_source == "-") {
+      ok = file->open(stdin, QIODevice::ReadOnly);
+    } else {
+      file->setFileName(_ais_source);
+      ok = file->open(QIODevice::ReadOnly);
+    }
+
+    if (!ok) {
+      qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "AIS: can't open" << _ais_source;
+      delete file;
+      return false;
+    }
+    _device = file;
+
+    // Pipes are read when data comes, regular files are replayed by the timer
+    if (file->isSequential()) {
+      _notifier = new QSocketNotifier(file->handle(), QSocketNotifier::Read, this);
+      connect(_notifier, SIGNAL(activated(int)), SLOT(readDevice()));
+    } else {
+      _replay = true;
+    }
+  }
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "AIS source" << _ais_source;
+  return true;
+}
+
+void TargetDataSource::closeAisSource() {
+  delete _notifier;
+  delete _device;
+  delete _udp;
+
+  _notifier = nullptr;
+  _device = nullptr;
+  _udp = nullptr;
+  _replay = false;
+}
+
+
+void TargetDataSource::readDevice() {
+  // Pipe notifier: read what is there now bypassing QFile buffering,
+  // end of stream stops the notifier
+  if (_notifier != nullptr) {
+    qint64 len = ::read(_notifier->socket(), _read_buffer.data(), READ_CHUNK);
+    if (len > 0)
+      parseAis(_read_buffer.constData(), len);
+    else
+      _notifier->setEnabled(false);
+    return;
+  }
+
+  while (_device->bytesAvailable() > 0) {
+    qint64 len = _device->read(_read_buffer.data(), READ_CHUNK);
+    if (len <= 0)
+      break;
+    parseAis(_read_buffer.constData(), len);
+  }
+}
+
+void TargetDataSource::readDatagrams() {
+  while (_udp->hasPendingDatagrams()) {
+    qint64 len = _udp->readDatagram(_read_buffer.data(), READ_CHUNK);
+    if (len > 0)
+      parseAis(_read_buffer.constData(), len);
+  }
+}
+
+
+// Reports of one MMSI are folded by the feed batch
+void TargetDataSource::parseAis(const char* data, qint64 len) {
+  if (_stat)
+    _stat_timer.start();
+
+  _parser.parse(data, static_cast<size_t>(len));
+
+  for (const AISReport& r : _parser.reports()) {
+    RLITarget trgt;
+
+    trgt.latitude = r.lat;
+    trgt.longtitude = r.lon;
+    trgt.heading = r.heading;
+    trgt.rotation = r.rot;
+    trgt.course_grnd = (r.cog >= 0) ? r.cog : 0;
+    trgt.speed_grnd = (r.sog >= 0) ? r.sog : 0;
+
+    _feed->put(r.mmsi, trgt);
+  }
+  _parser.clearReports();
+
+  if (_stat) {
+    _stat_nsecs += _stat_timer.nsecsElapsed();
+    _stat_bytes += len;
+  }
+}
+
+void TargetDataSource::logAisStat() {
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if (_stat && now - _stat_since >= 1000) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+             << "AIS:" << _parser.sentenceCount() << "sentences," << _parser.messageCount() << "messages,"
+             << _parser.errorCount() << "errors," << _stat_bytes << "bytes parsed in" << _stat_nsecs / 1e6 << "ms";
+
+    _stat_nsecs = 0;
+    _stat_bytes = 0;
+    _stat_since = now;
+  }
+}
+
+
+const float PI = 3.14159265359f;
+
+void TargetDataSource::simulate() {
   QDateTime now = QDateTime::currentDateTime();
 
   for (int i = 0; i < _targets.size(); i++) {
@@ -81,7 +273,7 @@ void TargetDataSource::timerEvent(QTimerEvent* e) {
       target.heading = -1;
     target.speed_grnd = _targets[i].speed_grnd;
 
-    emit updateTarget(QString::number(i+1), target);
+    _feed->put(static_cast<quint32>(i+1), target);
   }
 }
 
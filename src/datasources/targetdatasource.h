@@ -6,6 +6,15 @@
 #include <QVector2D>
 #include <QDateTime>
 #include <QTimerEvent>
+#include <QElapsedTimer>
+
+#include "aisparser.h"
+
+class TargetFeed;
+class DataPlayer;
+class QIODevice;
+class QUdpSocket;
+class QSocketNotifier;
 
 struct RLITarget {
   RLITarget() { }
@@ -17,7 +26,9 @@ struct RLITarget {
         heading     { o.heading },
         rotation    { o.rotation },
         course_grnd { o.course_grnd },
-        speed_grnd  { o.speed_grnd }
+        speed_grnd  { o.speed_grnd },
+        cpa         { o.cpa },
+        tcpa        { o.tcpa }
   { }
 
   ~RLITarget() { }
@@ -29,8 +40,16 @@ struct RLITarget {
   double rotation    { 0 };
   double course_grnd { 0 };
   double speed_grnd  { 0 };
+  double cpa         { 0 };  // Miles
+  double tcpa        { 0 };  // Minutes
 };
 
+// Источник целей.
+// Without an AIS source four targets are simulated. With PROPERTY_AIS_SOURCE set
+// NMEA sentences are read from "udp:<port>", "tcp:<host>:<port>", "-" (stdin),
+// a pipe or a recorded log file, which is replayed by chunks.
+// Targets go to the renderer through a TargetFeed (ids are MMSI for AIS),
+// one batch per timer tick. With PROPERTY_REPLAY set DataPlayer fills the feed instead.
 class TargetDataSource : public QObject
 {
   Q_OBJECT
@@ -38,8 +57,7 @@ public:
   explicit TargetDataSource(QObject *parent = nullptr);
   virtual ~TargetDataSource();
 
-signals:
-  void updateTarget(const QString& tag, const RLITarget& target);
+  inline TargetFeed* feed() const { return _feed; }
 
 protected slots:
   void timerEvent(QTimerEvent* e);
@@ -48,10 +66,39 @@ public slots:
   void start();
   void finish();
 
+private slots:
+  void readDevice();
+  void readDatagrams();
+
 private:
+  void simulate();
+
+  bool openAisSource();
+  void closeAisSource();
+  void parseAis(const char* data, qint64 len);
+  void logAisStat();
+
   int _timerId = -1;
   QDateTime _startTime;
   QVector<RLITarget> _targets;
+
+  TargetFeed* _feed;
+  DataPlayer* _player = nullptr;
+
+  QString _ais_source;
+  QIODevice* _device = nullptr;
+  QUdpSocket* _udp = nullptr;
+  QSocketNotifier* _notifier = nullptr;
+  bool _replay = false;
+
+  AISParser _parser;
+  QByteArray _read_buffer;
+
+  bool _stat;
+  QElapsedTimer _stat_timer;
+  qint64 _stat_nsecs = 0;
+  qint64 _stat_bytes = 0;
+  qint64 _stat_since = 0;
 };
 
 #endif // TARGETDATASOURCE_H
@@ -0,0 +1,60 @@
+#include "targetfeed.h"
+
+void TargetBatch::clear() {
+  ids.clear();
+  targets.clear();
+  removed.clear();
+  _positions.clear();
+}
+
+void TargetBatch::put(quint32 id, const RLITarget& target, bool remove) {
+  auto it = _positions.find(id);
+
+  if (it == _positions.end()) {
+    _positions.emplace(id, size());
+    ids.push_back(id);
+    targets.push_back(target);
+    removed.push_back(remove ? 1 : 0);
+  } else {
+    targets[it->second] = target;
+    removed[it->second] = remove ? 1 : 0;
+  }
+}
+
+
+TargetFeed::TargetFeed(const QString& tag_prefix) : _tag_prefix(tag_prefix) {
+}
+
+void TargetFeed::put(quint32 id, const RLITarget& target) {
+  _batches[_back].put(id, target, false);
+}
+
+void TargetFeed::remove(quint32 id) {
+  _batches[_back].put(id, RLITarget(), true);
+}
+
+bool TargetFeed::publish() {
+  if (_batches[_back].empty())
+    return true;
+
+  // Only the consumer clears FRESH, so the slot can't change between the check and the exchange
+  if (_ready.load(std::memory_order_acquire) & FRESH)
+    return false;
+
+  if (_publish_hook)
+    _publish_hook(_batches[_back]);
+
+  int old = _ready.exchange(_back | FRESH, std::memory_order_acq_rel);
+  _back = old & INDEX_MASK;
+  _batches[_back].clear();
+  return true;
+}
+
+const TargetBatch* TargetFeed::take() {
+  if (!(_ready.load(std::memory_order_acquire) & FRESH))
+    return nullptr;
+
+  int old = _ready.exchange(_front, std::memory_order_acq_rel);
+  _front = old & INDEX_MASK;
+  return &_batches[_front];
+}
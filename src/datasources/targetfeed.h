@@ -0,0 +1,70 @@
+#ifndef TARGETFEED_H
+#define TARGETFEED_H
+
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include <QString>
+
+#include "targetdatasource.h"
+
+// Изменения целей одного источника с момента предыдущей передачи.
+// An id is kept once, the last change wins.
+struct TargetBatch {
+  std::vector<quint32> ids;
+  std::vector<RLITarget> targets;
+  std::vector<char> removed;
+
+  inline bool empty() const { return ids.empty(); }
+  inline int size() const   { return static_cast<int>(ids.size()); }
+
+  void clear();
+  void put(quint32 id, const RLITarget& target, bool remove);
+
+private:
+  std::unordered_map<quint32, int> _positions;
+};
+
+
+// Передача изменений целей от одного потока-источника в поток отрисовки.
+// The producer fills its back batch and publishes it by swapping with the ready slot,
+// the renderer swaps the ready slot with its front batch once per frame.
+// Both swaps are single atomic exchanges, nobody waits on a lock. A published batch
+// not taken yet is never replaced: the producer keeps adding to its back batch
+// and publishes it later, so no change is lost. Batches keep their capacity.
+class TargetFeed {
+public:
+  // Display tags of the feed targets are prefix + id
+  explicit TargetFeed(const QString& tag_prefix = QString());
+
+  inline const QString& tagPrefix() const { return _tag_prefix; }
+
+  // Producer side
+  void put(quint32 id, const RLITarget& target);
+  void remove(quint32 id);
+  // Returns false if the previous batch is still not taken
+  bool publish();
+  // Called by publish() in the producer thread with every batch going to the consumer
+  inline void setPublishHook(const std::function<void(const TargetBatch&)>& hook) { _publish_hook = hook; }
+
+  // Consumer side: the latest batch or nullptr if nothing was published since the last call.
+  // The batch is valid until the next take()
+  const TargetBatch* take();
+  // True if take() has a batch, may be called from any thread
+  inline bool pending() const { return _ready.load(std::memory_order_acquire) & FRESH; }
+
+private:
+  enum { FRESH = 4, INDEX_MASK = 3 };
+
+  QString _tag_prefix;
+  std::function<void(const TargetBatch&)> _publish_hook;
+
+  TargetBatch _batches[3];
+  int _back = 0;
+  int _front = 2;
+  std::atomic<int> _ready { 1 };
+};
+
+#endif // TARGETFEED_H
@@ -22,12 +22,22 @@ void ChartAreaEngine::clearData() {
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void ChartAreaEngine::setData(S52::AreaLayer* layer, S52Assets* assets, S52References* ref, int display_order) {
+void ChartAreaEngine::setData(S52::AreaLayer* layer, const S52::NameTable* names, S52Assets* assets, int display_order, ChartUploadQueue* upload) {
   _display_order = display_order;
 
+  size_t vertex_count = layer->triangles.size() / 2;
+
   std::vector<GLfloat> color_inds;
   std::vector<GLfloat> tex_inds;
   std::vector<GLfloat> tex_dims;
+  color_inds.reserve(vertex_count);
+  tex_inds.reserve(2*vertex_count);
+  tex_dims.reserve(2*vertex_count);
+
+  // Pattern of every name id is looked up once
+  std::vector<char> resolved(static_cast<size_t>(names->size()), 0);
+  std::vector<QPoint> tex_ind_cache(resolved.size());
+  std::vector<QSize> tex_dim_cache(resolved.size());
 
   for (size_t i = 0; i < layer->start_inds.size(); i++) {
     size_t fst_idx = layer->start_inds[i];
@@ -41,8 +51,15 @@ void ChartAreaEngine::setData(S52::AreaLayer* layer, S52Assets* assets, S52Refer
     if (lst_idx <= fst_idx)
       continue;
 
-    QPoint tex_ind = assets->getAreaPatternLocation(ref->getColorScheme(), layer->pattern_refs[i]);
-    QSize tex_dim = assets->getAreaPatternSize(ref->getColorScheme(), layer->pattern_refs[i]);
+    size_t id = static_cast<size_t>(layer->pattern_ids[i]);
+    if (!resolved[id]) {
+      tex_ind_cache[id] = assets->getAreaPatternLocation(names->name(layer->pattern_ids[i]));
+      tex_dim_cache[id] = assets->getAreaPatternSize(names->name(layer->pattern_ids[i]));
+      resolved[id] = 1;
+    }
+
+    const QPoint& tex_ind = tex_ind_cache[id];
+    const QSize& tex_dim = tex_dim_cache[id];
 
     for (size_t j = fst_idx; j < lst_idx; j += 2) {
       color_inds.push_back(layer->color_inds[i]);
@@ -54,21 +71,12 @@ void ChartAreaEngine::setData(S52::AreaLayer* layer, S52Assets* assets, S52Refer
     }
   }
 
-  _point_count = layer->triangles.size() / 2;
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_COORDS]);
-  glBufferData(GL_ARRAY_BUFFER, layer->triangles.size() * sizeof(GLfloat), layer->triangles.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_COLOR_INDEX]);
-  glBufferData(GL_ARRAY_BUFFER, color_inds.size() * sizeof(GLfloat), &color_inds[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_PATTERN_INDEX]);
-  glBufferData(GL_ARRAY_BUFFER, tex_inds.size() * sizeof(GLfloat), &tex_inds[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_PATTERN_DIM]);
-  glBufferData(GL_ARRAY_BUFFER, tex_dims.size() * sizeof(GLfloat), &tex_dims[0], GL_STATIC_DRAW);
+  _point_count = vertex_count;
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  upload->add(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_COORDS], layer->triangles);
+  upload->add(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_COLOR_INDEX], color_inds);
+  upload->add(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_PATTERN_INDEX], tex_inds);
+  upload->add(GL_ARRAY_BUFFER, _vbo_ids[AREA_ATTR_PATTERN_DIM], tex_dims);
 }
 
 void ChartAreaEngine::draw(ChartShaders* shaders) {
@@ -1,77 +1,101 @@
 #include "chartengine.h"
 
+#include <QTimer>
 #include <QDateTime>
 #include <QDebug>
 
-ChartEngine::ChartEngine(int tex_radius, S52References* ref, QOpenGLContext* context, QObject* parent)
-  : QObject(parent), QOpenGLFunctions(context)  {
+#include <QtConcurrent/QtConcurrentMap>
 
-  initializeOpenGLFunctions();
+#include "../../common/startuptrace.h"
+
+ChartEngine::ChartEngine(int tex_radius, S52References* ref, QOpenGLContext* context, QObject* parent)
+  : QObject(parent)  {
 
   _ready = false;
-  _force_update = false;
+  _force_update = true;
+
+  _ref = ref;
+  _radius = tex_radius;
 
-  _context = context;
+  for (int i = 0; i < 2; i++)
+    _sizes[i] = QSize(2*tex_radius+1, 2*tex_radius+1);
+  _requested.radius = tex_radius;
 
-  _fbo = nullptr;
-  assets = new S52Assets(context, ref);
-  shaders = new ChartShaders(context);
+  // Surface is created in the GUI thread, the context moves to the worker with the engine
+  _surface = new QOffscreenSurface();
+  _surface->setFormat(context->format());
+  _surface->create();
 
-  resize(tex_radius);
+  _context = new QOpenGLContext(this);
+  _context->setFormat(context->format());
+  _context->setShareContext(context);
+  _context->create();
 }
 
 ChartEngine::~ChartEngine() {
-  for (auto engine: area_engines)
-    delete engine;
-  for (auto engine: line_engines)
-    delete engine;
-  for (auto engine: text_engines)
-    delete engine;
-  for (auto engine: mark_engines)
-    delete engine;
+  delete _surface;
+}
 
-  delete _fbo;
-  delete shaders;
-  delete assets;
+// GL objects of the worker are created on the first render
+void ChartEngine::init() {
+  StartupTrace::Span span("Chart assets");
+
+  initializeOpenGLFunctions();
+
+  assets = new S52Assets(_context, _ref);
+  shaders = new ChartShaders(_context);
+  _upload = new ChartUploadQueue(_context);
 }
 
+void ChartEngine::prepare() {
+  if (assets != nullptr || _context == nullptr)
+    return;
+
+  _context->makeCurrent(_surface);
+  init();
+}
 
-void ChartEngine::resize(int radius) {
-  if (_fbo != nullptr && _fbo->width() == static_cast<int>(2*radius+1))
+void ChartEngine::stop() {
+  if (_context == nullptr)
     return;
 
-  _radius = radius;
+  _context->makeCurrent(_surface);
 
-  delete _fbo;
+  clearLoadingData();
+  clearChartData();
 
-  QOpenGLFramebufferObjectFormat format;
-  format.setAttachment(QOpenGLFramebufferObject::Depth);
+  for (int i = 0; i < 2; i++) {
+    delete _fbos[i];
+    _fbos[i] = nullptr;
+  }
 
-  _fbo = new QOpenGLFramebufferObject(QSize(2*_radius+1, 2*_radius+1), format);
+  delete _upload;
+  delete shaders;
+  delete assets;
+  _upload = nullptr;
+  shaders = nullptr;
+  assets = nullptr;
 
-  _fbo->bind();
+  _context->doneCurrent();
+  delete _context;
+  _context = nullptr;
+}
 
-  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT);
 
-  _fbo->release();
+void ChartEngine::resize(int radius) {
+  if (_requested.radius == radius)
+    return;
 
+  _requested.radius = radius;
   _force_update = true;
 }
 
 
 void ChartEngine::setChart(S52::Chart* chrt, S52References* ref) {
-  _ready = false;
-
-  clearChartData();
-
-  setAreaLayers(chrt, ref);
-  setLineLayers(chrt, ref);
-  setTextLayers(chrt, ref);
-  setMarkLayers(chrt, ref);
-  setSndgLayer(chrt, ref);
+  Q_UNUSED(ref);
 
-  _ready = true;
+  QMutexLocker locker(&_request_mutex);
+  _pending_chart = chrt;
   _force_update = true;
 }
 
@@ -90,26 +114,31 @@ void ChartEngine::clearChartData() {
   line_engines.clear();
   text_engines.clear();
   mark_engines.clear();
-
-  _force_update = true;
 }
 
 
+// Layer engines are created here, their vertex arrays are built by the pool threads
 void ChartEngine::setAreaLayers(S52::Chart* chrt, S52References* ref) {
+  Q_UNUSED(ref);
+
   for (QString layer_name : chrt->areaLayerNames()) {
     S52::AreaLayer* layer = chrt->areaLayer(layer_name);
+    const S52::NameTable* names = &chrt->names();
     ChartAreaEngine* engine = new ChartAreaEngine(_context);
-    engine->setData(layer, assets, ref, layer->disp_prio[0]);
-    area_engines.push_back(engine);
+    _load_jobs.push_back([=]() { engine->setData(layer, names, assets, layer->disp_prio[0], _upload); });
+    new_area_engines.push_back(engine);
   }
 }
 
 void ChartEngine::setLineLayers(S52::Chart* chrt, S52References* ref) {
+  Q_UNUSED(ref);
+
   for (QString layer_name : chrt->lineLayerNames()) {
     S52::LineLayer* layer = chrt->lineLayer(layer_name);
+    const S52::NameTable* names = &chrt->names();
     ChartLineEngine* engine = new ChartLineEngine(_context);
-    engine->setData(layer, assets, ref, 10 + layer->disp_prio[0]);
-    line_engines.push_back(engine);
+    _load_jobs.push_back([=]() { engine->setData(layer, names, assets, 10 + layer->disp_prio[0], _upload); });
+    new_line_engines.push_back(engine);
   }
 }
 
@@ -119,55 +148,206 @@ void ChartEngine::setTextLayers(S52::Chart* chrt, S52References* ref) {
   for (QString layer_name : chrt->textLayerNames()) {
     S52::TextLayer* layer = chrt->textLayer(layer_name);
     ChartTextEngine* engine = new ChartTextEngine(_context);
-    engine->setData(layer, 30);
-    text_engines.push_back(engine);
+    _load_jobs.push_back([=]() { engine->setData(layer, 30, _upload); });
+    new_text_engines.push_back(engine);
   }
 }
 
 void ChartEngine::setMarkLayers(S52::Chart* chrt, S52References* ref) {
   for (QString layer_name : chrt->markLayerNames()) {
     S52::MarkLayer* layer = chrt->markLayer(layer_name);
+    const S52::NameTable* names = &chrt->names();
     ChartMarkEngine* engine = new ChartMarkEngine(_context);
-    engine->setData(layer, ref, 20 + layer->disp_prio[0]);
-    mark_engines.push_back(engine);
+    _load_jobs.push_back([=]() { engine->setData(layer, names, ref, 20 + layer->disp_prio[0], _upload); });
+    new_mark_engines.push_back(engine);
   }
 }
 
 void ChartEngine::setSndgLayer(S52::Chart* chrt, S52References* ref) {
+  S52::SndgLayer* layer = chrt->sndgLayer();
   ChartMarkEngine* engine = new ChartMarkEngine(_context);
-  engine->setData(chrt->sndgLayer(), assets, ref, 100);
-  mark_engines.push_back(engine);
+  _load_jobs.push_back([=]() { engine->setData(layer, assets, ref, 100, _upload); });
+  new_mark_engines.push_back(engine);
+}
+
+
+// Starts loading of a chart, a chart still being loaded is dropped
+void ChartEngine::loadChart(S52::Chart* chrt) {
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Chart layers setup start";
+
+  clearLoadingData();
+  _load_time.start();
+
+  setAreaLayers(chrt, _ref);
+  setLineLayers(chrt, _ref);
+  setTextLayers(chrt, _ref);
+  setMarkLayers(chrt, _ref);
+  setSndgLayer(chrt, _ref);
+
+  _load_future = QtConcurrent::map(_load_jobs, [](std::function<void()>& job) { job(); });
+  _loading = true;
+
+  QMetaObject::invokeMethod(this, "loadStep", Qt::QueuedConnection);
+}
+
+void ChartEngine::clearLoadingData() {
+  _load_future.waitForFinished();
+  _load_jobs.clear();
+  _loading = false;
+
+  if (_upload != nullptr)
+    _upload->clear();
+
+  for (auto engine: new_area_engines)
+    delete engine;
+  for (auto engine: new_line_engines)
+    delete engine;
+  for (auto engine: new_text_engines)
+    delete engine;
+  for (auto engine: new_mark_engines)
+    delete engine;
+
+  new_area_engines.clear();
+  new_line_engines.clear();
+  new_text_engines.clear();
+  new_mark_engines.clear();
+}
+
+// One slice of the upload, render requests coming meanwhile are served between slices
+void ChartEngine::loadStep() {
+  if (!_loading)
+    return;
+
+  if (!_load_future.isFinished()) {
+    QTimer::singleShot(5, this, SLOT(loadStep()));
+    return;
+  }
+
+  _context->makeCurrent(_surface);
+
+  if (!_upload->upload(UPLOAD_SLICE)) {
+    glFlush();
+    QMetaObject::invokeMethod(this, "loadStep", Qt::QueuedConnection);
+    return;
+  }
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Chart layers setup finish,"
+           << _upload->totalSize() / (1024*1024) << "MB in" << _load_time.elapsed() << "ms";
+
+  // The new layers replace the old ones at once
+  clearChartData();
+
+  area_engines.swap(new_area_engines);
+  line_engines.swap(new_line_engines);
+  text_engines.swap(new_text_engines);
+  mark_engines.swap(new_mark_engines);
+
+  _load_jobs.clear();
+  _upload->clear();
+  _loading = false;
+  _ready = true;
+
+  // Redraw the last requested view with the new chart
+  _request_dirty = true;
+  if (!_render_queued.exchange(true))
+    QMetaObject::invokeMethod(this, "render", Qt::QueuedConnection);
 }
 
 
 void ChartEngine::update(const RLIState& state, const QString& color_scheme) {
+  // Take the latest finished image, the one shown before becomes free for the worker
+  if (_published.load(std::memory_order_acquire) & FRESH)
+    _front = _published.exchange(_front, std::memory_order_acq_rel) & INDEX_MASK;
+
   auto center = state.ship_position;
   double scale = state.chart_scale;
   double angle = state.north_shift;
   const QPoint& center_shift = state.center_shift;
 
   bool need_update = ( _force_update
-                    || fabs(_center.lat - center.lat) > 0.000005
-                    || fabs(_center.lon - center.lon) > 0.000005
-                    || fabs(_scale - scale) > 0.005
-                    || fabs(_angle - angle) > 0.005
-                    || fabs(_center_shift.x() - center_shift.x()) > 0.005
-                    || fabs(_center_shift.y() - center_shift.y()) > 0.005
+                    || _requested.color_scheme != color_scheme
+                    || fabs(_requested.center.lat - center.lat) > 0.000005
+                    || fabs(_requested.center.lon - center.lon) > 0.000005
+                    || fabs(_requested.scale - scale) > 0.005
+                    || fabs(_requested.angle - angle) > 0.005
+                    || fabs(_requested.center_shift.x() - center_shift.x()) > 0.005
+                    || fabs(_requested.center_shift.y() - center_shift.y()) > 0.005
                      );
 
   if (need_update) {
-    _center = center;
-    _scale = scale;
-    _angle = angle;
-    _center_shift = center_shift;
+    _requested.center = center;
+    _requested.scale = scale;
+    _requested.angle = angle;
+    _requested.center_shift = center_shift;
+    _requested.color_scheme = color_scheme;
+    _force_update = false;
+
+    QMutexLocker locker(&_request_mutex);
+    _pending = _requested;
+    _request_dirty = true;
+  }
+
+  // The worker skips a request while both images are busy, so it is repeated every frame until drawn
+  if (_request_dirty && !_render_queued.exchange(true))
+    QMetaObject::invokeMethod(this, "render", Qt::QueuedConnection);
+}
 
-    draw(color_scheme);
+
+void ChartEngine::render() {
+  _render_queued = false;
+
+  int free = _published.load(std::memory_order_acquire);
+  if (free & FRESH)
+    return;
+
+  View view;
+  S52::Chart* chart;
+  {
+    QMutexLocker locker(&_request_mutex);
+    view = _pending;
+    chart = _pending_chart;
+    _pending_chart = nullptr;
+    _request_dirty = false;
   }
+
+  _context->makeCurrent(_surface);
+
+  if (assets == nullptr)
+    init();
+
+  if (chart != nullptr)
+    loadChart(chart);
+
+  _center = view.center;
+  _scale = view.scale;
+  _angle = view.angle;
+  _center_shift = view.center_shift;
+  _radius = view.radius;
+
+  // The free image gets the requested size when it is drawn next time
+  QOpenGLFramebufferObject*& fbo = _fbos[free];
+  if (fbo == nullptr || fbo->width() != 2*_radius+1) {
+    delete fbo;
+
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::Depth);
+    fbo = new QOpenGLFramebufferObject(QSize(2*_radius+1, 2*_radius+1), format);
+  }
+
+  draw(fbo, view.color_scheme);
+
+  // The display context samples the texture only after it is complete
+  glFinish();
+
+  _tex_ids[free] = fbo->texture();
+  _sizes[free] = fbo->size();
+  _published.store(free | FRESH, std::memory_order_release);
+  emit imagePublished();
 }
 
 
-void ChartEngine::draw(const QString& color_scheme) {
-  _fbo->bind();
+void ChartEngine::draw(QOpenGLFramebufferObject* fbo, const QString& color_scheme) {
+  fbo->bind();
 
   glEnable(GL_BLEND);
   glEnable(GL_DEPTH_TEST);
@@ -176,16 +356,16 @@ void ChartEngine::draw(const QString& color_scheme) {
   glClearColor(0.0f, 0.0f, 0.0f, 1.f);
   glClear(GL_COLOR_BUFFER_BIT);
 
-  glViewport(0, 0, _fbo->width(), _fbo->height());
+  glViewport(0, 0, fbo->width(), fbo->height());
 
   if (_ready) {
     QMatrix4x4 projection;
     projection.setToIdentity();
-    projection.ortho(0.f, _fbo->width(), 0.f, _fbo->height(), -1000.f, 1000.f);
+    projection.ortho(0.f, fbo->width(), 0.f, fbo->height(), -1000.f, 1000.f);
 
     QMatrix4x4 transform;
     transform.setToIdentity();
-    transform.translate(_center_shift.x() + _fbo->width()/2.f, _center_shift.y() + _fbo->height()/2.f, 0.f);
+    transform.translate(_center_shift.x() + fbo->width()/2.f, _center_shift.y() + fbo->height()/2.f, 0.f);
 
     drawAreaLayers(projection*transform, color_scheme);
     drawLineLayers(projection*transform, color_scheme);
@@ -193,8 +373,7 @@ void ChartEngine::draw(const QString& color_scheme) {
     drawMarkLayers(projection*transform, color_scheme);
   }
 
-  _fbo->release();
-  _force_update = false;
+  fbo->release();
 }
 
 
@@ -2,7 +2,15 @@
 #define CHARTENGINE_H
 
 #include <QObject>
+#include <QMutex>
 #include <QVector2D>
+#include <QOffscreenSurface>
+
+#include <atomic>
+#include <functional>
+
+#include <QFuture>
+#include <QElapsedTimer>
 
 #include <QOpenGLFunctions>
 #include <QOpenGLFramebufferObject>
@@ -20,43 +28,105 @@
 #include "charttextengine.h"
 #include "chartmarkengine.h"
 #include "chartshaders.h"
-
+#include "chartupload.h"
+
+// Карта рисуется в своём потоке в собственном контексте, общем с контекстом экрана.
+// The worker draws into the free one of two FBOs and publishes it with an atomic exchange,
+// the display thread takes the latest published image in update() and never waits for the chart.
+// resize, setChart, update, size and textureId are called from the display thread only.
+// A new chart is prepared on the pool threads and uploaded by slices between chart frames,
+// the old one is drawn until the new one is complete.
 class ChartEngine : public QObject, protected QOpenGLFunctions {
   Q_OBJECT
 
 public:
+  // Creates the worker context shared with context, move the engine to its thread after that
   ChartEngine(int tex_radius, S52References* ref, QOpenGLContext* context, QObject* parent = nullptr);
   virtual ~ChartEngine();
 
   void resize(int radius);
-  inline QSize size() { return _fbo->size(); }
+  inline QSize size() { return _sizes[_front]; }
 
   void setChart(S52::Chart* chrt, S52References* ref);
   void update(const RLIState& state, const QString& color_scheme);
 
-  inline GLuint textureId() { return _fbo->texture(); }
+  inline GLuint textureId() { return _tex_ids[_front]; }
+
+signals:
+  // A new image is published, emitted from the worker thread
+  void imagePublished();
+
+public slots:
+  // Releases GL resources in the worker thread, call it blocking before the thread quits
+  void stop();
+
+private slots:
+  // Creates the assets ahead of the first frame
+  void prepare();
+  void render();
+  void loadStep();
 
 private:
+  struct View {
+    GeoPos center         { 0, 0 };
+    double scale          { 10 };
+    double angle          { 0 };
+    QPoint center_shift   { 0, 0 };
+    QString color_scheme;
+    int radius            { 0 };
+  };
+
+  void init();
   void clearChartData();
+  void loadChart(S52::Chart* chrt);
+  void clearLoadingData();
 
   bool _ready;
   bool _force_update;
 
   QOpenGLContext* _context;
+  QOffscreenSurface* _surface;
+  S52References* _ref;
 
-  ChartShaders* shaders;
+  ChartShaders* shaders = nullptr;
 
-  int    _radius;
+  // Display thread: the last requested view
+  View _requested;
+
+  // Display thread -> worker
+  QMutex _request_mutex;
+  View _pending;
+  S52::Chart* _pending_chart = nullptr;
+  std::atomic<bool> _request_dirty { false };
+  std::atomic<bool> _render_queued { false };
 
+  // Worker: the view being drawn
+  int    _radius;
   QPoint _center_shift  { 0, 0 };
   GeoPos _center        { 0, 0 };
   double _scale         { 10 };
   double _angle         { 0 };
 
-  S52Assets* assets;  
-  QOpenGLFramebufferObject* _fbo = nullptr;
+  S52Assets* assets = nullptr;
 
-  void draw(const QString& color_scheme);
+  // Worker: the chart being loaded
+  enum { UPLOAD_SLICE = 4 << 20 }; // bytes sent between two chart frames
+  ChartUploadQueue* _upload = nullptr;
+  QVector<std::function<void()>> _load_jobs;
+  QFuture<void> _load_future;
+  bool _loading = false;
+  QElapsedTimer _load_time;
+
+  // Image exchange: _published holds the published image with FRESH or the free one without it,
+  // _front is the image shown by the display thread
+  enum { FRESH = 2, INDEX_MASK = 1 };
+  QOpenGLFramebufferObject* _fbos[2] { nullptr, nullptr };
+  GLuint _tex_ids[2] { 0, 0 };
+  QSize _sizes[2];
+  int _front = 0;
+  std::atomic<int> _published { 1 };
+
+  void draw(QOpenGLFramebufferObject* fbo, const QString& color_scheme);
 
   void drawAreaLayers(const QMatrix4x4& mvp_matrix, const QString& color_scheme);
   void drawLineLayers(const QMatrix4x4& mvp_matrix, const QString& color_scheme);
@@ -73,6 +143,11 @@ private:
   QVector<ChartLineEngine*>  line_engines;
   QVector<ChartTextEngine*>  text_engines;
   QVector<ChartMarkEngine*>  mark_engines;
+
+  QVector<ChartAreaEngine*>  new_area_engines;
+  QVector<ChartLineEngine*>  new_line_engines;
+  QVector<ChartTextEngine*>  new_text_engines;
+  QVector<ChartMarkEngine*>  new_mark_engines;
 };
 
 #endif // CHARTENGINE_H
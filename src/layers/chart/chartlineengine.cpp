@@ -29,9 +29,12 @@ void ChartLineEngine::clearData() {
 }
 
 
-void ChartLineEngine::setData(S52::LineLayer* layer, S52Assets* assets, S52References* ref, int display_order) {
+void ChartLineEngine::setData(S52::LineLayer* layer, const S52::NameTable* names, S52Assets* assets, int display_order, ChartUploadQueue* upload) {
   _display_order = display_order;
 
+  // At most 4 vertices per line point
+  size_t vertex_count = 2 * layer->points.size();
+
   std::vector<GLfloat> coords1;
   std::vector<GLfloat> coords2;
   std::vector<GLfloat> point_ords;
@@ -39,6 +42,18 @@ void ChartLineEngine::setData(S52::LineLayer* layer, S52Assets* assets, S52Refer
   std::vector<GLfloat> color_inds;
   std::vector<GLfloat> tex_inds;
   std::vector<GLfloat> tex_dims;
+  coords1.reserve(2*vertex_count);
+  coords2.reserve(2*vertex_count);
+  point_ords.reserve(vertex_count);
+  distances.reserve(vertex_count);
+  color_inds.reserve(vertex_count);
+  tex_inds.reserve(2*vertex_count);
+  tex_dims.reserve(2*vertex_count);
+
+  // Pattern of every name id is looked up once
+  std::vector<char> resolved(static_cast<size_t>(names->size()), 0);
+  std::vector<QPoint> tex_ind_cache(resolved.size());
+  std::vector<QSize> tex_dim_cache(resolved.size());
 
   for (size_t i = 0; i < layer->start_inds.size(); i++) {
     size_t fst_idx = layer->start_inds[i];
@@ -52,8 +67,15 @@ void ChartLineEngine::setData(S52::LineLayer* layer, S52Assets* assets, S52Refer
     if (lst_idx <= fst_idx)
       continue;
 
-    QPoint tex_ind = assets->getLinePatternLocation(ref->getColorScheme(), layer->pattern_refs[i]);
-    QSize  tex_dim = assets->getLinePatternSize(ref->getColorScheme(), layer->pattern_refs[i]);
+    size_t id = static_cast<size_t>(layer->pattern_ids[i]);
+    if (!resolved[id]) {
+      tex_ind_cache[id] = assets->getLinePatternLocation(names->name(layer->pattern_ids[i]));
+      tex_dim_cache[id] = assets->getLinePatternSize(names->name(layer->pattern_ids[i]));
+      resolved[id] = 1;
+    }
+
+    const QPoint& tex_ind = tex_ind_cache[id];
+    const QSize&  tex_dim = tex_dim_cache[id];
 
     for (size_t j = fst_idx; j < lst_idx - 2; j += 2) {
       for (int k = 0; k < 4; k++) {
@@ -75,28 +97,13 @@ void ChartLineEngine::setData(S52::LineLayer* layer, S52Assets* assets, S52Refer
 
   point_count = point_ords.size();
 
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_COORDS1]);
-  glBufferData(GL_ARRAY_BUFFER, coords1.size() * sizeof(GLfloat), &coords1[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_COORDS2]);
-  glBufferData(GL_ARRAY_BUFFER, coords2.size() * sizeof(GLfloat), &coords2[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_DISTANCE]);
-  glBufferData(GL_ARRAY_BUFFER, distances.size() * sizeof(GLfloat), &distances[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_ORDER]);
-  glBufferData(GL_ARRAY_BUFFER, point_ords.size() * sizeof(GLfloat), &point_ords[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_PATTERN_INDEX]);
-  glBufferData(GL_ARRAY_BUFFER, tex_inds.size() * sizeof(GLfloat), &tex_inds[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_PATTERN_DIM]);
-  glBufferData(GL_ARRAY_BUFFER, tex_dims.size() * sizeof(GLfloat), &tex_dims[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_COLOR_INDEX]);
-  glBufferData(GL_ARRAY_BUFFER, color_inds.size() * sizeof(GLfloat), &color_inds[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_COORDS1], coords1);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_COORDS2], coords2);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_DISTANCE], distances);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_ORDER], point_ords);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_PATTERN_INDEX], tex_inds);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_PATTERN_DIM], tex_dims);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[LINE_ATTR_COLOR_INDEX], color_inds);
 
   std::vector<GLuint> draw_indices;
 
@@ -109,9 +116,7 @@ void ChartLineEngine::setData(S52::LineLayer* layer, S52Assets* assets, S52Refer
     draw_indices.push_back(i+3);
   }
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, draw_indices.size()*sizeof(GLuint), draw_indices.data(), GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  upload->add(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id, draw_indices);
 }
 
 void ChartLineEngine::draw(ChartShaders* shaders) {
@@ -6,6 +6,7 @@
 #include <QOpenGLVertexArrayObject>
 
 #include "chartshaders.h"
+#include "chartupload.h"
 
 #include "../../s52/s52chart.h"
 #include "../../s52/s52assets.h"
@@ -18,7 +19,7 @@ public:
   virtual ~ChartLineEngine();
 
   void clearData();
-  void setData(S52::LineLayer* layer, S52Assets* assets, S52References* ref, int display_order);
+  void setData(S52::LineLayer* layer, const S52::NameTable* names, S52Assets* assets, int display_order, ChartUploadQueue* upload);
 
   void draw(ChartShaders* shaders);
   inline int displayOrder() { return _display_order; }
@@ -29,13 +29,18 @@ void ChartMarkEngine::clearData() {
 }
 
 
-void ChartMarkEngine::setData(S52::MarkLayer* layer, S52References* ref, int display_order) {
+void ChartMarkEngine::setData(S52::MarkLayer* layer, const S52::NameTable* names, S52References* ref, int display_order, ChartUploadQueue* upload) {
   _display_order = display_order;
 
+  size_t vertex_count = 4 * (layer->points.size() / 2);
+
   std::vector<GLfloat> world_coords;
 
   std::vector<GLfloat> vertex_offsets;
   std::vector<GLfloat> tex_coords;
+  world_coords.reserve(2*vertex_count);
+  vertex_offsets.reserve(2*vertex_count);
+  tex_coords.reserve(2*vertex_count);
 
   QPointF orig, pivt;
   QSizeF size;
@@ -44,9 +49,10 @@ void ChartMarkEngine::setData(S52::MarkLayer* layer, S52References* ref, int dis
   QPointF tex_coord;
 
   for (size_t i = 0; i < (layer->points.size() / 2); i++) {
-    orig = ref->getSymbolIndex(layer->symbol_refs[i]);
-    size = ref->getSymbolSize(layer->symbol_refs[i]);
-    pivt = ref->getSymbolPivot(layer->symbol_refs[i]);
+    const QString& symbol = names->name(layer->symbol_ids[i]);
+    orig = ref->getSymbolIndex(symbol);
+    size = ref->getSymbolSize(symbol);
+    pivt = ref->getSymbolPivot(symbol);
 
     for (int k = 0; k < 4; k++) {
       world_coords.push_back(layer->points[2*i+0]);
@@ -80,23 +86,17 @@ void ChartMarkEngine::setData(S52::MarkLayer* layer, S52References* ref, int dis
 
   point_count = world_coords.size() / 2;
 
-  setupBuffers(world_coords, vertex_offsets, tex_coords);
+  setupBuffers(world_coords, vertex_offsets, tex_coords, upload);
 }
 
 void ChartMarkEngine::setupBuffers( const std::vector<GLfloat>& world_coords
                                   , const std::vector<GLfloat>& vertex_offsets
-                                  , const std::vector<GLfloat>& tex_coords )
+                                  , const std::vector<GLfloat>& tex_coords
+                                  , ChartUploadQueue* upload )
 {
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[MARK_ATTR_WORLD_COORDS]);
-  glBufferData(GL_ARRAY_BUFFER, world_coords.size() * sizeof(GLfloat), &world_coords[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[MARK_ATTR_VERTEX_OFFSET]);
-  glBufferData(GL_ARRAY_BUFFER, vertex_offsets.size() * sizeof(GLfloat), &vertex_offsets[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[MARK_ATTR_TEX_COORDS]);
-  glBufferData(GL_ARRAY_BUFFER, tex_coords.size() * sizeof(GLfloat), &tex_coords[0], GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[MARK_ATTR_WORLD_COORDS], world_coords);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[MARK_ATTR_VERTEX_OFFSET], vertex_offsets);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[MARK_ATTR_TEX_COORDS], tex_coords);
 
   std::vector<GLuint> draw_indices;
 
@@ -109,12 +109,10 @@ void ChartMarkEngine::setupBuffers( const std::vector<GLfloat>& world_coords
     draw_indices.push_back(i+3);
   }
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, draw_indices.size()*sizeof(GLuint), draw_indices.data(), GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  upload->add(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id, draw_indices);
 }
 
-void ChartMarkEngine::setData(S52::SndgLayer* layer, S52Assets* assets, S52References* ref, int display_order) {
+void ChartMarkEngine::setData(S52::SndgLayer* layer, S52Assets* assets, S52References* ref, int display_order, ChartUploadQueue* upload) {
   Q_UNUSED(assets);
 
   _display_order = display_order;
@@ -188,7 +186,7 @@ void ChartMarkEngine::setData(S52::SndgLayer* layer, S52Assets* assets, S52Refer
 
   point_count = world_coords.size() / 2;
 
-  setupBuffers(world_coords, vertex_offsets, tex_coords);
+  setupBuffers(world_coords, vertex_offsets, tex_coords, upload);
 }
 
 void ChartMarkEngine::draw(ChartShaders* shaders) {
@@ -6,6 +6,7 @@
 #include <QOpenGLVertexArrayObject>
 
 #include "chartshaders.h"
+#include "chartupload.h"
 
 #include "../../s52/s52chart.h"
 #include "../../s52/s52assets.h"
@@ -18,8 +19,8 @@ public:
   virtual ~ChartMarkEngine();
 
   void clearData();
-  void setData(S52::MarkLayer* layer, S52References* ref, int display_order);
-  void setData(S52::SndgLayer* layer, S52Assets* assets, S52References* ref, int display_order);
+  void setData(S52::MarkLayer* layer, const S52::NameTable* names, S52References* ref, int display_order, ChartUploadQueue* upload);
+  void setData(S52::SndgLayer* layer, S52Assets* assets, S52References* ref, int display_order, ChartUploadQueue* upload);
 
   void draw(ChartShaders* shaders);
   inline int displayOrder() { return _display_order; }
@@ -27,7 +28,8 @@ public:
 private:
   void setupBuffers( const std::vector<GLfloat>& world_coords
                    , const std::vector<GLfloat>& vertex_offsets
-                   , const std::vector<GLfloat>& tex_coords );
+                   , const std::vector<GLfloat>& tex_coords
+                   , ChartUploadQueue* upload );
 
   GLuint vbo_ids[MARK_ATTR_COUNT];
   GLuint _ind_vbo_id;
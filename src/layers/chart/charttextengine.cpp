@@ -29,7 +29,7 @@ void ChartTextEngine::clearData() {
 }
 
 
-void ChartTextEngine::setData(S52::TextLayer* layer, int display_order) {
+void ChartTextEngine::setData(S52::TextLayer* layer, int display_order, ChartUploadQueue* upload) {
   _display_order = display_order;
 
   std::vector<GLfloat> coords;
@@ -55,19 +55,10 @@ void ChartTextEngine::setData(S52::TextLayer* layer, int display_order) {
 
   point_count = point_orders.size();
 
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_COORDS]);
-  glBufferData(GL_ARRAY_BUFFER, coords.size() * sizeof(GLfloat), coords.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_POINT_ORDER]);
-  glBufferData(GL_ARRAY_BUFFER, point_orders.size() * sizeof(GLfloat), point_orders.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_CHAR_SHIFT]);
-  glBufferData(GL_ARRAY_BUFFER, char_shifts.size() * sizeof(GLfloat), char_shifts.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_CHAR_VALUE]);
-  glBufferData(GL_ARRAY_BUFFER, char_values.size() * sizeof(GLfloat), char_values.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_COORDS], coords);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_POINT_ORDER], point_orders);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_CHAR_SHIFT], char_shifts);
+  upload->add(GL_ARRAY_BUFFER, vbo_ids[TEXT_ATTR_CHAR_VALUE], char_values);
 
   std::vector<GLuint> draw_indices;
 
@@ -80,9 +71,7 @@ void ChartTextEngine::setData(S52::TextLayer* layer, int display_order) {
     draw_indices.push_back(i+3);
   }
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, draw_indices.size()*sizeof(GLuint), draw_indices.data(), GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  upload->add(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id, draw_indices);
 }
 
 void ChartTextEngine::draw(ChartShaders* shaders) {
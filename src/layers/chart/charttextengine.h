@@ -6,6 +6,7 @@
 #include <QOpenGLVertexArrayObject>
 
 #include "chartshaders.h"
+#include "chartupload.h"
 
 #include "../../s52/s52chart.h"
 #include "../../s52/s52assets.h"
@@ -18,7 +19,7 @@ public:
   virtual ~ChartTextEngine();
 
   void clearData();
-  void setData(S52::TextLayer* layer, int display_order);
+  void setData(S52::TextLayer* layer, int display_order, ChartUploadQueue* upload);
 
   void draw(ChartShaders* shaders);
   inline int displayOrder() { return _display_order; }
@@ -0,0 +1,61 @@
+#include "chartupload.h"
+
+#include <cstring>
+#include <algorithm>
+
+ChartUploadQueue::ChartUploadQueue(QOpenGLContext* context) : QOpenGLFunctions(context) {
+  initializeOpenGLFunctions();
+
+  _next = 0;
+  _total_size = 0;
+}
+
+void ChartUploadQueue::add(GLenum target, GLuint vbo_id, const void* data, size_t size) {
+  Buffer buffer { target, vbo_id, 0, std::vector<char>(size) };
+  if (size > 0)
+    memcpy(buffer.data.data(), data, size);
+
+  QMutexLocker locker(&_mutex);
+  _total_size += size;
+  _buffers.push_back(std::move(buffer));
+}
+
+bool ChartUploadQueue::upload(size_t budget) {
+  while (_next < _buffers.size()) {
+    Buffer& buffer = _buffers[_next];
+    size_t size = buffer.data.size();
+
+    glBindBuffer(buffer.target, buffer.vbo_id);
+
+    // Storage is allocated with the first slice
+    if (buffer.offset == 0)
+      glBufferData(buffer.target, size, nullptr, GL_STATIC_DRAW);
+
+    size_t count = std::min(budget, size - buffer.offset);
+    if (count > 0)
+      glBufferSubData(buffer.target, buffer.offset, count, buffer.data.data() + buffer.offset);
+
+    glBindBuffer(buffer.target, 0);
+
+    buffer.offset += count;
+    budget -= count;
+
+    if (buffer.offset < size)
+      return false;
+
+    std::vector<char>().swap(buffer.data);
+    _next++;
+
+    if (budget == 0)
+      break;
+  }
+
+  return _next == _buffers.size();
+}
+
+void ChartUploadQueue::clear() {
+  QMutexLocker locker(&_mutex);
+  _buffers.clear();
+  _next = 0;
+  _total_size = 0;
+}
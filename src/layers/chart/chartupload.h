@@ -0,0 +1,41 @@
+#ifndef CHARTUPLOAD_H
+#define CHARTUPLOAD_H
+
+#include <vector>
+
+#include <QMutex>
+#include <QOpenGLFunctions>
+
+// Очередь загрузки буферов карты.
+// Layer engines put their vertex arrays here from pool threads instead of calling glBufferData,
+// the thread of the GL context sends them later by slices of a given size.
+class ChartUploadQueue : protected QOpenGLFunctions {
+public:
+  explicit ChartUploadQueue(QOpenGLContext* context);
+
+  // Any thread, the data is copied
+  void add(GLenum target, GLuint vbo_id, const void* data, size_t size);
+  template <typename T>
+  inline void add(GLenum target, GLuint vbo_id, const std::vector<T>& data) { add(target, vbo_id, data.data(), data.size()*sizeof(T)); }
+
+  // GL thread: sends at most budget bytes, returns true when the whole queue is sent
+  bool upload(size_t budget);
+  void clear();
+
+  inline size_t totalSize() const { return _total_size; }
+
+private:
+  struct Buffer {
+    GLenum target;
+    GLuint vbo_id;
+    size_t offset;
+    std::vector<char> data;
+  };
+
+  QMutex _mutex;
+  std::vector<Buffer> _buffers;
+  size_t _next;
+  size_t _total_size;
+};
+
+#endif // CHARTUPLOAD_H
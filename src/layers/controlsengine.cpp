@@ -11,51 +11,42 @@ ControlsEngine::ControlsEngine(QOpenGLContext* context, QObject* parent) : QObje
 
   _prog = new QOpenGLShaderProgram();
 
-  glGenBuffers(CTRL_ATTR_COUNT, _vbo_ids_cursor);
-  glGenBuffers(CTRL_ATTR_COUNT, _vbo_ids_circle);
-  glGenBuffers(CTRL_ATTR_COUNT, _vbo_ids_ray);
+  glGenBuffers(1, &_vbo_id_circles);
+  glGenBuffers(1, &_vbo_id_rays);
 
   initShaders();
-
-  initCursorBuffers();
-  initCircleBuffers();
+  initBuffers();
 }
 
 ControlsEngine::~ControlsEngine() {
-  glDeleteBuffers(CTRL_ATTR_COUNT, _vbo_ids_cursor);
-  glDeleteBuffers(CTRL_ATTR_COUNT, _vbo_ids_circle);
-  glDeleteBuffers(CTRL_ATTR_COUNT, _vbo_ids_ray);
+  glDeleteBuffers(1, &_vbo_id_circles);
+  glDeleteBuffers(1, &_vbo_id_rays);
 
   delete _prog;
 }
 
 void ControlsEngine::draw(const QMatrix4x4& mvp_mat, const RLIState& state, const RLICircleLayout& layout) {
-  _prog->bind();
-
-  QMatrix4x4 transform;
-  transform.setToIdentity();
-
-  if (state.state == RLIWidgetState::ROUTE_EDITION) {
-    QPointF tr = RLIMath::coords_to_pos( state.ship_position, state.visir_center_pos, QPoint(0,0), state.chart_scale);
-    transform.translate( static_cast<GLfloat>(tr.x()), static_cast<GLfloat>(tr.y()), 0.f);
-  }
+  _circles.count = 0;
+  _rays.count = 0;
 
-  _prog->setUniformValue(_unif_locs[CTRL_UNIF_MVP], mvp_mat*transform);
+  QPointF tr;
+  if (state.state == RLIWidgetState::ROUTE_EDITION)
+    tr = RLIMath::coords_to_pos( state.ship_position, state.visir_center_pos, QPoint(0,0), state.chart_scale);
 
 
   // Визир дальности
-  drawCircleSegment(RLI_CNTR_COLOR_VD,  static_cast<float>(state.vd));
+  addCircleSegment(RLI_CNTR_COLOR_VD,  static_cast<float>(state.vd), 0.f, 360.f, tr);
 
   // Distance rings
   if (state.show_circles) {
     for (float rad = 80; rad < 560; rad += 80)
-      drawCircleSegment(RLI_CNTR_COLOR_CIRCLES,  rad);
+      addCircleSegment(RLI_CNTR_COLOR_CIRCLES,  rad, 0.f, 360.f, tr);
   }
   // ----------------------
 
   // Direction rays
-  drawRaySegment(RLI_CNTR_COLOR_VN_CU, static_cast<float>(state.vn_cu));
-  drawRaySegment(RLI_CNTR_COLOR_VN_P , static_cast<float>(state.vn_p));
+  addRaySegment(RLI_CNTR_COLOR_VN_CU, static_cast<float>(state.vn_cu), 0.f, 2048.f, 0.f, tr);
+  addRaySegment(RLI_CNTR_COLOR_VN_P , static_cast<float>(state.vn_p), 0.f, 2048.f, 0.f, tr);
 
 
 
@@ -63,53 +54,55 @@ void ControlsEngine::draw(const QMatrix4x4& mvp_mat, const RLIState& state, cons
 
   // Parallel lines
   if (state.show_parallel) {
-    drawRaySegment(RLI_CNTR_COLOR_PAR_LINES, static_cast<float>(state.vn_p), -2048.f, 2048.f,  static_cast<float>(state.vd));
-    drawRaySegment(RLI_CNTR_COLOR_PAR_LINES, static_cast<float>(state.vn_p), -2048.f, 2048.f, -static_cast<float>(state.vd));
+    addRaySegment(RLI_CNTR_COLOR_PAR_LINES, static_cast<float>(state.vn_p), -2048.f, 2048.f,  static_cast<float>(state.vd), tr);
+    addRaySegment(RLI_CNTR_COLOR_PAR_LINES, static_cast<float>(state.vn_p), -2048.f, 2048.f, -static_cast<float>(state.vd), tr);
   }
   // ----------------------
 
   // Capture zone
-  drawRaySegment   (RLI_CNTR_COLOR_CAPT_AREA,  280.f,   48.f,  112.f);
-  drawRaySegment   (RLI_CNTR_COLOR_CAPT_AREA,  340.f,   48.f,  112.f);
-  drawCircleSegment(RLI_CNTR_COLOR_CAPT_AREA,   48.f,  280.f,  340.f);
-  drawCircleSegment(RLI_CNTR_COLOR_CAPT_AREA,  112.f,  280.f,  340.f);
+  addRaySegment   (RLI_CNTR_COLOR_CAPT_AREA, state.capt_min_angle, state.capt_min_rad, state.capt_max_rad, 0.f, tr);
+  addRaySegment   (RLI_CNTR_COLOR_CAPT_AREA, state.capt_max_angle, state.capt_min_rad, state.capt_max_rad, 0.f, tr);
+  addCircleSegment(RLI_CNTR_COLOR_CAPT_AREA, state.capt_min_rad, state.capt_min_angle, state.capt_max_angle, tr);
+  addCircleSegment(RLI_CNTR_COLOR_CAPT_AREA, state.capt_max_rad, state.capt_min_angle, state.capt_max_angle, tr);
   // ----------------------
 
   // Magnifier zone
   float magn_min_angle = (state.magn_min_peleng / 4096.f) * 360.f + state.north_shift;
-  float magn_max_angle = ((state.magn_min_peleng + state.magn_width) / 4096.f) * 360.f + state.north_shift;
+  float magn_max_angle = ((state.magn_min_peleng + state.magnPelengs()) / 4096.f) * 360.f + state.north_shift;
 
-  drawRaySegment   (RLI_CNTR_COLOR_MAGNIFIER, magn_min_angle,  state.magn_min_rad,  state.magn_min_rad + state.magn_height);
-  drawRaySegment   (RLI_CNTR_COLOR_MAGNIFIER, magn_max_angle,  state.magn_min_rad,  state.magn_min_rad + state.magn_height);
-  drawCircleSegment(RLI_CNTR_COLOR_MAGNIFIER, state.magn_min_rad  ,  magn_min_angle,  magn_max_angle);
-  drawCircleSegment(RLI_CNTR_COLOR_MAGNIFIER, state.magn_min_rad + state.magn_height ,  magn_min_angle,  magn_max_angle);
+  addRaySegment   (RLI_CNTR_COLOR_MAGNIFIER, magn_min_angle,  state.magn_min_rad,  state.magn_min_rad + state.magnRadii(), 0.f, tr);
+  addRaySegment   (RLI_CNTR_COLOR_MAGNIFIER, magn_max_angle,  state.magn_min_rad,  state.magn_min_rad + state.magnRadii(), 0.f, tr);
+  addCircleSegment(RLI_CNTR_COLOR_MAGNIFIER, state.magn_min_rad  ,  magn_min_angle,  magn_max_angle, tr);
+  addCircleSegment(RLI_CNTR_COLOR_MAGNIFIER, state.magn_min_rad + state.magnRadii() ,  magn_min_angle,  magn_max_angle, tr);
   // ----------------------
 
   // Cursor
-  QPointF cusor_shift = state.cursor_pos - state.center_shift;
-  transform.setToIdentity();
-  transform.translate(static_cast<GLfloat>(cusor_shift.x()), static_cast<GLfloat>(cusor_shift.y()), 0.f);
-  _prog->setUniformValue(_unif_locs[CTRL_UNIF_MVP], mvp_mat*transform);
-  drawCursor(RLI_CNTR_COLOR_CURSOR);
+  addCursor(RLI_CNTR_COLOR_CURSOR, state.cursor_pos - state.center_shift);
   // ----------------------
 
 
   // Course marker
-  glLineWidth(2.0f);
   double rad = layout.radius - 6;
   double phi = RLIMath::rads(state.course_mark_angle);
   QPointF tr_cm(rad * std::sin(phi), -rad * std::cos(phi));
 
-  transform.setToIdentity();
-  transform.translate( static_cast<GLfloat>(tr_cm.x()), static_cast<GLfloat>(tr_cm.y()), 0.f);
-  _prog->setUniformValue(_unif_locs[CTRL_UNIF_MVP], mvp_mat*transform);
-
-  drawRaySegment(RLI_CNTR_COLOR_COURSE_MARKER, state.course_mark_angle-45, 0, 16, 0);
-  drawRaySegment(RLI_CNTR_COLOR_COURSE_MARKER,    state.course_mark_angle, 0, 16, 0);
-  drawRaySegment(RLI_CNTR_COLOR_COURSE_MARKER, state.course_mark_angle+45, 0, 16, 0);
+  addWideRaySegment(RLI_CNTR_COLOR_COURSE_MARKER, state.course_mark_angle-45, 0, 16, tr_cm);
+  addWideRaySegment(RLI_CNTR_COLOR_COURSE_MARKER,    state.course_mark_angle, 0, 16, tr_cm);
+  addWideRaySegment(RLI_CNTR_COLOR_COURSE_MARKER, state.course_mark_angle+45, 0, 16, tr_cm);
   // ----------------------
 
 
+  _prog->bind();
+  _prog->setUniformValue(_unif_locs[CTRL_UNIF_MVP], mvp_mat);
+
+#if !(defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0))
+  glPointSize(1.f);
+#endif
+  glLineWidth(1.f);
+
+  drawRows(_rays, _vbo_id_rays, GL_LINES, 2, false);
+  drawRows(_circles, _vbo_id_circles, GL_POINTS, CIRCLE_RESOLUTION, true);
+
   _prog->release();
 }
 
@@ -122,107 +115,111 @@ void ControlsEngine::initShaders() {
   _prog->link();
   _prog->bind();
 
-  _attr_locs[CTRL_ATTR_ANGLE]       = _prog->attributeLocation("angle");
-  _attr_locs[CTRL_ATTR_RADIUS]      = _prog->attributeLocation("radius");
+  _attr_locs[CTRL_ATTR_ROW]         = _prog->attributeLocation("row");
+  _attr_locs[CTRL_ATTR_T]           = _prog->attributeLocation("t");
 
   _unif_locs[CTRL_UNIF_MVP]         = _prog->uniformLocation("mvp_matrix");
-  _unif_locs[CTRL_UNIF_COLOR]       = _prog->uniformLocation("color");
-  _unif_locs[CTRL_UNIF_SHIFT]       = _prog->uniformLocation("shift");
+  _unif_locs[CTRL_UNIF_GEOMETRY]    = _prog->uniformLocation("geometry");
+  _unif_locs[CTRL_UNIF_OFFSETS]     = _prog->uniformLocation("offsets");
+  _unif_locs[CTRL_UNIF_COLORS]      = _prog->uniformLocation("colors");
+  _unif_locs[CTRL_UNIF_CIRCLES]     = _prog->uniformLocation("circles");
 
   _prog->release();
 }
 
-void ControlsEngine::initCursorBuffers() {
-  GLfloat angs[] { 0.f, 180.f, 90.f, 270.f };
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_cursor[CTRL_ATTR_ANGLE]);
-  glBufferData(GL_ARRAY_BUFFER, 4*sizeof(GLfloat), angs, GL_STATIC_DRAW);
+void ControlsEngine::initBuffers() {
+  std::vector<GLfloat> verts;
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
+  verts.reserve(2 * 2 * MAX_RAYS);
+  for (int row = 0; row < MAX_RAYS; row++) {
+    verts.insert(verts.end(), { static_cast<GLfloat>(row), 0.f });
+    verts.insert(verts.end(), { static_cast<GLfloat>(row), 1.f });
+  }
 
-void ControlsEngine::initCircleBuffers() {
-  std::vector<GLfloat> angs;
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo_id_rays);
+  glBufferData(GL_ARRAY_BUFFER, verts.size()*sizeof(GLfloat), verts.data(), GL_STATIC_DRAW);
 
-  for (size_t i = 0; i < RLI_CNTR_CIRCLE_RESOLUTION; i++)
-    angs.push_back( (static_cast<float>(i) / RLI_CNTR_CIRCLE_RESOLUTION) * 360.f );
-  angs.push_back(0);
+  verts.clear();
+  verts.reserve(2 * CIRCLE_RESOLUTION * MAX_CIRCLES);
+  for (int row = 0; row < MAX_CIRCLES; row++) {
+    for (int i = 0; i < CIRCLE_RESOLUTION; i++) {
+      verts.push_back(static_cast<GLfloat>(row));
+      verts.push_back(static_cast<GLfloat>(i) / CIRCLE_RESOLUTION);
+    }
+  }
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_circle[CTRL_ATTR_ANGLE]);
-  glBufferData(GL_ARRAY_BUFFER, angs.size()*sizeof(GLfloat), angs.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo_id_circles);
+  glBufferData(GL_ARRAY_BUFFER, verts.size()*sizeof(GLfloat), verts.data(), GL_STATIC_DRAW);
 
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 
 
-void ControlsEngine::drawCursor(const QColor& col) {
-  glUniform1f(_unif_locs[CTRL_UNIF_SHIFT], 0.0);
-  glUniform4f(_unif_locs[CTRL_UNIF_COLOR], col.redF(), col.greenF(), col.blueF(), col.alphaF());
+void ControlsEngine::addRow(Rows& rows, int max_count, const QColor& col, const QPointF& offset, GLfloat g0, GLfloat g1, GLfloat g2, GLfloat g3) {
+  if (rows.count >= max_count)
+    return;
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_cursor[CTRL_ATTR_ANGLE]);
-  glVertexAttribPointer(_attr_locs[CTRL_ATTR_ANGLE], 1, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(0));
-  glEnableVertexAttribArray(_attr_locs[CTRL_ATTR_ANGLE]);
+  GLfloat* geometry = rows.geometry + 4*rows.count;
+  geometry[0] = g0;
+  geometry[1] = g1;
+  geometry[2] = g2;
+  geometry[3] = g3;
 
-  glVertexAttrib1f(_attr_locs[CTRL_ATTR_RADIUS], 5.f);
-  glDisableVertexAttribArray(_attr_locs[CTRL_ATTR_RADIUS]);
+  GLfloat* offsets = rows.offsets + 4*rows.count;
+  offsets[0] = static_cast<GLfloat>(offset.x());
+  offsets[1] = static_cast<GLfloat>(offset.y());
+  offsets[2] = 0.f;
+  offsets[3] = 0.f;
 
-  glLineWidth(2.f);
-  glDrawArrays(GL_LINES, 0, 4);
+  GLfloat* colors = rows.colors + 4*rows.count;
+  colors[0] = static_cast<GLfloat>(col.redF());
+  colors[1] = static_cast<GLfloat>(col.greenF());
+  colors[2] = static_cast<GLfloat>(col.blueF());
+  colors[3] = static_cast<GLfloat>(col.alphaF());
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  rows.count++;
 }
 
-void ControlsEngine::drawCircleSegment(const QColor& col, GLfloat radius, GLfloat min_angle, GLfloat max_angle) {
-  glUniform1f(_unif_locs[CTRL_UNIF_SHIFT], 0.0);
-  glUniform4f(_unif_locs[CTRL_UNIF_COLOR], col.redF(), col.greenF(), col.blueF(), col.alphaF());
-
-#if !(defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0))
-  glPointSize(1.f);
-#endif
-
-  glVertexAttrib1f(_attr_locs[CTRL_ATTR_RADIUS], radius);
-  glDisableVertexAttribArray(_attr_locs[CTRL_ATTR_RADIUS]);
-
-  int frst_element = (int((min_angle / 360) * RLI_CNTR_CIRCLE_RESOLUTION) + RLI_CNTR_CIRCLE_RESOLUTION) % RLI_CNTR_CIRCLE_RESOLUTION;
-  int last_element = (int((max_angle / 360) * RLI_CNTR_CIRCLE_RESOLUTION) + RLI_CNTR_CIRCLE_RESOLUTION) % RLI_CNTR_CIRCLE_RESOLUTION;
-
-  if (last_element == 0)
-    last_element = RLI_CNTR_CIRCLE_RESOLUTION;
+void ControlsEngine::addCursor(const QColor& col, const QPointF& offset) {
+  addWideRaySegment(col,  0.f, -5.f, 5.f, offset);
+  addWideRaySegment(col, 90.f, -5.f, 5.f, offset);
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_circle[CTRL_ATTR_ANGLE]);
-  glVertexAttribPointer(_attr_locs[CTRL_ATTR_ANGLE], 1, GL_FLOAT, GL_FALSE, 0, (void*)(0 * sizeof(GLfloat)));
-  glEnableVertexAttribArray(_attr_locs[CTRL_ATTR_ANGLE]);
+void ControlsEngine::addCircleSegment(const QColor& col, GLfloat radius, GLfloat min_angle, GLfloat max_angle, const QPointF& offset) {
+  // Angular span in (0, 360], an empty span is the full circle
+  GLfloat span = std::fmod(max_angle - min_angle, 360.f);
+  if (span <= 0.f)
+    span += 360.f;
 
-  if (last_element > frst_element) {
-    glDrawArrays(GL_POINTS, frst_element, last_element - frst_element);
-  } else {
-    glDrawArrays(GL_POINTS, frst_element, RLI_CNTR_CIRCLE_RESOLUTION - frst_element);
-    glDrawArrays(GL_POINTS, 0, last_element);
-  }
+  addRow(_circles, MAX_CIRCLES, col, offset, radius, min_angle, span, 0.f);
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+void ControlsEngine::addRaySegment(const QColor& col, GLfloat angle, GLfloat min_radius, GLfloat max_radius, GLfloat shift, const QPointF& offset) {
+  addRow(_rays, MAX_RAYS, col, offset, angle, min_radius, max_radius, shift);
 }
 
-void ControlsEngine::drawRaySegment(const QColor& col, GLfloat angle, GLfloat min_radius, GLfloat max_radius, GLfloat shift) {
-  glUniform1f(_unif_locs[CTRL_UNIF_SHIFT], shift);
-  glUniform4f(_unif_locs[CTRL_UNIF_COLOR], col.redF(), col.greenF(), col.blueF(), col.alphaF());
+void ControlsEngine::addWideRaySegment(const QColor& col, GLfloat angle, GLfloat min_radius, GLfloat max_radius, const QPointF& offset) {
+  addRaySegment(col, angle, min_radius, max_radius, -0.5f, offset);
+  addRaySegment(col, angle, min_radius, max_radius,  0.5f, offset);
+}
 
-  GLfloat angs[] { angle, angle };
-  GLfloat rads[] { min_radius, max_radius };
+void ControlsEngine::drawRows(const Rows& rows, GLuint vbo_id, GLenum mode, int row_vertices, bool circles) {
+  if (rows.count == 0)
+    return;
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_ray[CTRL_ATTR_ANGLE]);
-  glBufferData(GL_ARRAY_BUFFER, 2*sizeof(GLfloat), angs, GL_DYNAMIC_DRAW);
-  glVertexAttribPointer(_attr_locs[CTRL_ATTR_ANGLE], 1, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(0));
-  glEnableVertexAttribArray(_attr_locs[CTRL_ATTR_ANGLE]);
+  glUniform4fv(_unif_locs[CTRL_UNIF_GEOMETRY], rows.count, rows.geometry);
+  glUniform4fv(_unif_locs[CTRL_UNIF_OFFSETS], rows.count, rows.offsets);
+  glUniform4fv(_unif_locs[CTRL_UNIF_COLORS], rows.count, rows.colors);
+  glUniform1f(_unif_locs[CTRL_UNIF_CIRCLES], circles ? 1.f : 0.f);
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_ray[CTRL_ATTR_RADIUS]);
-  glBufferData(GL_ARRAY_BUFFER, 2*sizeof(GLfloat), rads, GL_DYNAMIC_DRAW);
-  glVertexAttribPointer(_attr_locs[CTRL_ATTR_RADIUS], 1, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(0));
-  glEnableVertexAttribArray(_attr_locs[CTRL_ATTR_RADIUS]);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+  glVertexAttribPointer(_attr_locs[CTRL_ATTR_ROW], 1, GL_FLOAT, GL_FALSE, 2*sizeof(GLfloat), reinterpret_cast<const GLvoid*>(0));
+  glEnableVertexAttribArray(_attr_locs[CTRL_ATTR_ROW]);
+  glVertexAttribPointer(_attr_locs[CTRL_ATTR_T], 1, GL_FLOAT, GL_FALSE, 2*sizeof(GLfloat), reinterpret_cast<const GLvoid*>(sizeof(GLfloat)));
+  glEnableVertexAttribArray(_attr_locs[CTRL_ATTR_T]);
 
-  glLineWidth(1.f);
-  glDrawArrays(GL_LINES, 0, 2);
+  glDrawArrays(mode, 0, rows.count * row_vertices);
 
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
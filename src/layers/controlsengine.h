@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QPoint>
+#include <QPointF>
 #include <QColor>
 
 #include <QOpenGLTexture>
@@ -35,35 +36,55 @@ private:
   const QColor RLI_CNTR_COLOR_VD            { 255, 255, 255, 255 };
   const QColor RLI_CNTR_COLOR_COURSE_MARKER { 255,   0,   0, 255 };
 
-  const size_t RLI_CNTR_CIRCLE_RESOLUTION = 4096;
-
+  // Circles and rays are rows of uniform arrays, the static buffers hold
+  // (row, t) vertices only: 2 per ray, CIRCLE_RESOLUTION points per circle.
+  // So all rays go in one GL_LINES call and all circles in one GL_POINTS call.
+  // MAX_RAYS is also the array size in ctrl.vert.glsl
+  enum { CIRCLE_RESOLUTION = 4096
+       , MAX_CIRCLES = 12
+       , MAX_RAYS = 24 } ;
+
+  struct Rows {
+    int count = 0;
+    GLfloat geometry[4*MAX_RAYS];
+    GLfloat offsets[4*MAX_RAYS];
+    GLfloat colors[4*MAX_RAYS];
+  };
 
   void initShaders();
+  void initBuffers();
+
+  void addCursor(const QColor& col, const QPointF& offset);
 
-  void initCursorBuffers();
-  void initCircleBuffers();
+  void addCircleSegment(const QColor& col, GLfloat radius, GLfloat min_angle = 0.f, GLfloat max_angle = 360.f, const QPointF& offset = QPointF());
+  void addRaySegment(const QColor& col, GLfloat angle, GLfloat min_radius = 0.f, GLfloat max_radius = 2048.f, GLfloat shift = 0.f, const QPointF& offset = QPointF());
+  // Two rays one pixel apart
+  void addWideRaySegment(const QColor& col, GLfloat angle, GLfloat min_radius, GLfloat max_radius, const QPointF& offset);
 
-  void drawCursor(const QColor& col);
+  void addRow(Rows& rows, int max_count, const QColor& col, const QPointF& offset, GLfloat g0, GLfloat g1, GLfloat g2, GLfloat g3);
+  void drawRows(const Rows& rows, GLuint vbo_id, GLenum mode, int row_vertices, bool circles);
 
-  void drawCircleSegment(const QColor& col, GLfloat radius, GLfloat min_angle = 0.f, GLfloat max_angle = 360.f);
-  void drawRaySegment(const QColor& col, GLfloat angle, GLfloat min_radius = 0.f, GLfloat max_radius = 2048.f, GLfloat shift = 0.f);
+  Rows _circles;
+  Rows _rays;
 
   // -------------------------------------------
   QOpenGLShaderProgram* _prog;
-  enum { CTRL_ATTR_ANGLE = 0
-       , CTRL_ATTR_RADIUS = 1
+  enum { CTRL_ATTR_ROW = 0
+       , CTRL_ATTR_T = 1
        , CTRL_ATTR_COUNT = 2 } ;
   enum { CTRL_UNIF_MVP = 0
-       , CTRL_UNIF_SHIFT = 1
-       , CTRL_UNIF_COLOR = 2
-       , CTRL_UNIF_COUNT = 3 } ;
+       , CTRL_UNIF_GEOMETRY = 1
+       , CTRL_UNIF_OFFSETS = 2
+       , CTRL_UNIF_COLORS = 3
+       , CTRL_UNIF_CIRCLES = 4
+       , CTRL_UNIF_COUNT = 5 } ;
 
   int _attr_locs[CTRL_ATTR_COUNT];
   int _unif_locs[CTRL_UNIF_COUNT];
 
-  GLuint _vbo_ids_cursor[CTRL_ATTR_COUNT];
-  GLuint _vbo_ids_circle[CTRL_ATTR_COUNT];
-  GLuint _vbo_ids_ray[CTRL_ATTR_COUNT];
+  // Interleaved (row, t)
+  GLuint _vbo_id_circles;
+  GLuint _vbo_id_rays;
 };
 
 #endif // CONTROLSENGINE_H
@@ -341,6 +341,17 @@ void InfoEngine::initShaders() {
 }
 
 
+bool InfoEngine::needsUpdate() const {
+  if (_full_update)
+    return true;
+
+  for (InfoBlock* block: _blocks)
+    if (block->needUpdate())
+      return true;
+
+  return false;
+}
+
 void InfoEngine::update(InfoFonts* fonts) {
   glEnable(GL_BLEND);
 
@@ -767,8 +778,8 @@ void InfoEngine::initBlockDanger() {
 
 void InfoEngine::initBlockTails() {
   _blocks[RLI_PANEL_TAILS]->setText(RLI_PANEL_TAILS_TBL_0_0_TEXT_ID, RLI_STR_TAILS);
-  _blocks[RLI_PANEL_TAILS]->setText(RLI_PANEL_TAILS_TBL_0_1_TEXT_ID, RLI_STR_OFF);
   _blocks[RLI_PANEL_TAILS]->setText(RLI_PANEL_TAILS_TBL_0_2_TEXT_ID, RLI_STR_MIN);
+  onTailsChanged(_tails_minutes);
 }
 
 void InfoEngine::initBlockDetails() {
@@ -829,9 +840,40 @@ void InfoEngine::onTargetCountChanged(int count) {
   _blocks[RLI_PANEL_TARGETS]->setText(RLI_PANEL_TARGETS_COUNT_TEXT_ID, QString::number(count).toLocal8Bit());
 }
 
+void InfoEngine::onTailsChanged(int minutes) {
+  _tails_minutes = minutes;
+
+  if (minutes > 0)
+    _blocks[RLI_PANEL_TAILS]->setText(RLI_PANEL_TAILS_TBL_0_1_TEXT_ID, QString::number(minutes).toLocal8Bit());
+  else
+    _blocks[RLI_PANEL_TAILS]->setText(RLI_PANEL_TAILS_TBL_0_1_TEXT_ID, RLI_STR_OFF);
+}
+
 void InfoEngine::onSelectedTargetUpdated(const QString& tag, const RLITarget& trgt) {
   _blocks[RLI_PANEL_TARGETS]->setText(RLI_PANEL_TARGETS_CURRENT_TEXT_ID, tag.toLocal8Bit());
 
   _blocks[RLI_PANEL_TARGETS]->setText(RLI_PANEL_TARGETS_TBL_2_1_TEXT_ID, QString::number(trgt.course_grnd).left(6).toLatin1());
   _blocks[RLI_PANEL_TARGETS]->setText(RLI_PANEL_TARGETS_TBL_3_1_TEXT_ID, QString::number(trgt.speed_grnd).left(6).toLatin1());
+  _blocks[RLI_PANEL_TARGETS]->setText(RLI_PANEL_TARGETS_TBL_4_1_TEXT_ID, QString::number(trgt.cpa, 'f', 2).toLatin1());
+  _blocks[RLI_PANEL_TARGETS]->setText(RLI_PANEL_TARGETS_TBL_5_1_TEXT_ID, QString::number(trgt.tcpa, 'f', 2).toLatin1());
+}
+
+void InfoEngine::onDangerUpdated(bool danger, double cpa, double tcpa) {
+  _danger_cpa = danger;
+  updateDangerLabel();
+
+  _blocks[RLI_PANEL_DANGER_DETAILS]->setText(RLI_PANEL_DANGER_DETAILS_TBL_0_1_TEXT_ID, QString::number(cpa, 'f', 2).toLatin1());
+  _blocks[RLI_PANEL_DANGER_DETAILS]->setText(RLI_PANEL_DANGER_DETAILS_TBL_1_1_TEXT_ID, QString::number(tcpa, 'f', 1).toLatin1());
+}
+
+void InfoEngine::onGuardZoneAlarm(bool alarm) {
+  if (_guard_alarm == alarm)
+    return;
+
+  _guard_alarm = alarm;
+  updateDangerLabel();
+}
+
+void InfoEngine::updateDangerLabel() {
+  _blocks[RLI_PANEL_DANGER]->setText(RLI_PANEL_DANGER_LABEL_TEXT_ID, (_danger_cpa || _guard_alarm) ? RLI_STR_DANGER_TRG : RLI_STR_BLANK);
 }
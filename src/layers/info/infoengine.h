@@ -65,6 +65,8 @@ public:
   };
 
   inline const QVector<InfoBlock*>& blocks() { return _blocks; }
+  // Some block has to be redrawn by update()
+  bool needsUpdate() const;
 
 
 public slots:
@@ -85,6 +87,9 @@ public slots:
   void onPositionChanged(const GeoPos& position);
   void onTargetCountChanged(int count);
   void onSelectedTargetUpdated(const QString& tag, const RLITarget& trgt);
+  void onDangerUpdated(bool danger, double cpa, double tcpa);
+  void onGuardZoneAlarm(bool alarm);
+  void onTailsChanged(int minutes);
   void onScaleChanged(const RLIScale* scale);
   void onOrientationChanged(RLIOrientation orient);
   void onVnChanged(const RLIState& rliState);
@@ -93,6 +98,7 @@ public slots:
 
 private:
   void updateBlock(InfoBlock* b, InfoFonts* fonts);
+  void updateDangerLabel();
 
   inline void drawText(const InfoText& text, InfoFonts* fonts);
   inline void drawRect(const QRect& rect, const QColor& col);
@@ -131,6 +137,11 @@ private:
   RLILang _lang = RLI_LANG_RUSSIAN;
   bool _full_update = true;
 
+  // Опасная цель по ДКС/ВКС или цель в зоне захвата
+  bool _danger_cpa = false;
+  bool _guard_alarm = false;
+  int _tails_minutes = 1;
+
   QVector<InfoBlock*> _blocks = QVector<InfoBlock*>(RLI_PANELS_COUNT);
 
   void initShaders();
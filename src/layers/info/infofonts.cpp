@@ -4,17 +4,27 @@
 #include <QDebug>
 #include <QDir>
 
-InfoFonts::InfoFonts(QOpenGLContext* context, const QString& dirPath) : QOpenGLFunctions(context) {
-  initializeOpenGLFunctions();
+QHash<QString, QImage> InfoFonts::loadImages(const QString& dirPath) {
+  QHash<QString, QImage> images;
 
   QDir dir(dirPath);
   dir.setNameFilters(QStringList() << "*.png");
 
   for (QString fileName : dir.entryList()) {
-    QString tag = fileName.replace(".png", "");
+    QImage img(dir.absoluteFilePath(fileName));
+    images.insert(fileName.replace(".png", ""), img);
+  }
+
+  return images;
+}
+
+InfoFonts::InfoFonts(QOpenGLContext* context, const QHash<QString, QImage>& images) : QOpenGLFunctions(context) {
+  initializeOpenGLFunctions();
+
+  for (QString tag : images.keys()) {
+    const QImage& img = images[tag];
 
     QOpenGLTexture* tex = new QOpenGLTexture(QOpenGLTexture::Target2D);
-    QImage img(dir.absoluteFilePath(fileName));
     QSize fontSize = img.size() / 16;
 
     tex->setMipLevels(1);
@@ -3,6 +3,7 @@
 
 #include <QSize>
 #include <QHash>
+#include <QImage>
 
 #include <QOpenGLContext>
 #include <QOpenGLFunctions>
@@ -11,9 +12,12 @@
 class InfoFonts : protected QOpenGLFunctions
 {
 public:
-  InfoFonts(QOpenGLContext* context, const QString& dirPath);
+  // Font images are decoded by loadImages, which needs no context
+  InfoFonts(QOpenGLContext* context, const QHash<QString, QImage>& images);
   virtual ~InfoFonts();
 
+  static QHash<QString, QImage> loadImages(const QString& dirPath);
+
   inline QOpenGLTexture* getTexture(const QString& tag)   { return _textures.value(tag, nullptr); }
   inline QSize           getFontSize(const QString& tag)  { return _fontSizes.value(tag, QSize(0, 0)); }
 
@@ -27,6 +27,7 @@ public:
 
   inline QRect geometry() { return _geometry; }
   inline GLuint texture() { return _fbo->texture(); }
+  inline bool needsUpdate() const { return _need_update; }
 
   inline void setFonts(InfoFonts* fonts) { _fonts = fonts; }
   void resize(const RLIMenuLayout& layout);
@@ -1,7 +1,7 @@
 #include "magnifierengine.h"
 #include "../common/properties.h"
 
-#include <vector>
+#include <cmath>
 
 MagnifierEngine::MagnifierEngine(const RLIMagnifierLayout& layout, QOpenGLContext* context, QObject* parent)
   : QObject(parent), QOpenGLFunctions(context) {
@@ -9,9 +9,11 @@ MagnifierEngine::MagnifierEngine(const RLIMagnifierLayout& layout, QOpenGLContex
 
   _prog = new QOpenGLShaderProgram();
   _fbo = nullptr;
+  _pal_tex_id = 0;
+  _bilinear = false;
 
-  glGenBuffers(MAGN_ATTR_COUNT, _vbo_ids_border);
-  glGenBuffers(MAGN_ATTR_COUNT, _vbo_ids_radar);
+  glGenBuffers(MAGN_ATTR_COUNT, _vbo_ids);
+  glGenTextures(1, &_amp_tex_id);
 
   initShaders();
 
@@ -22,8 +24,8 @@ MagnifierEngine::~MagnifierEngine() {
   delete _prog;
   delete _fbo;
 
-  glDeleteBuffers(MAGN_ATTR_COUNT, _vbo_ids_border);
-  glDeleteBuffers(MAGN_ATTR_COUNT, _vbo_ids_radar);
+  glDeleteBuffers(MAGN_ATTR_COUNT, _vbo_ids);
+  glDeleteTextures(1, &_amp_tex_id);
 }
 
 void MagnifierEngine::resize(const RLIMagnifierLayout& layout) {
@@ -33,18 +35,20 @@ void MagnifierEngine::resize(const RLIMagnifierLayout& layout) {
   _fbo = new QOpenGLFramebufferObject(layout.geometry.size());
   _geometry = layout.geometry;
 
-  initBorderBuffers();
-  initRadarBuffers();
+  initBuffers();
+  initTexture();
 }
 
-void MagnifierEngine::update(const RLIState& s) {
+void MagnifierEngine::update(const RLIState& s, const float* amps, int pel_count, int pel_len) {
+  int zoom = qBound(static_cast<int>(MIN_ZOOM), s.magn_zoom, static_cast<int>(MAX_ZOOM));
+  float pixels_per_sample = std::ldexp(1.f, zoom);
+
+  uploadWindow(s, amps, pel_count, pel_len);
+
   glViewport(0, 0, _fbo->width(), _fbo->height());
 
   _fbo->bind();
 
-  glClearColor(0.0f, 0.0f, 0.0f, 1.f);
-  glClear(GL_COLOR_BUFFER_BIT);
-
   QMatrix4x4 projection;
   projection.setToIdentity();
   projection.ortho(0.f, _fbo->width(), _fbo->height(), 0.f, -1.f, 1.f);
@@ -53,56 +57,82 @@ void MagnifierEngine::update(const RLIState& s) {
 
   _prog->setUniformValue(_unif_locs[MAGN_UNIF_MVP], projection);
 
-  glUniform1i(_unif_locs[MAGN_UNIF_TEXTURE], 0);
+  glUniform4f(_unif_locs[MAGN_UNIF_COLOR], 0.0f, 1.0f, 0.0f, 1.0f);
+  glUniform1f(_unif_locs[MAGN_UNIF_THREASHOLD], 0.5f / 255.f);
+  glUniform2f(_unif_locs[MAGN_UNIF_SIZE], _fbo->width(), _fbo->height());
+  glUniform2f( _unif_locs[MAGN_UNIF_TEX_SCALE]
+             , 1.f / (pixels_per_sample * _tex_size.width())
+             , 1.f / (pixels_per_sample * _tex_size.height()) );
+
+  // At MIN_ZOOM a pixel center lies between 2x2 samples, the taps hit their centers
+  if (zoom < 0)
+    glUniform2f(_unif_locs[MAGN_UNIF_TAP], 0.5f / _tex_size.width(), 0.5f / _tex_size.height());
+  else
+    glUniform2f(_unif_locs[MAGN_UNIF_TAP], 0.f, 0.f);
+
+  glUniform1i(_unif_locs[MAGN_UNIF_AMPLITUDES], 0);
+  glUniform1i(_unif_locs[MAGN_UNIF_PALETTE], 1);
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, _pal_tex_id);
 
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, _pal_tex_id);
+  glBindTexture(GL_TEXTURE_2D, _amp_tex_id);
+
+  bool bilinear = s.magn_bilinear && zoom > 0;
+  if (bilinear != _bilinear) {
+    GLint filter = bilinear ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    _bilinear = bilinear;
+  }
 
-  drawPelengs(s.peleng_length, s.peleng_count, s.magn_min_peleng, s.magn_min_rad);
-  drawBorder();
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[MAGN_ATTR_POSITION]);
+  glVertexAttribPointer(_attr_locs[MAGN_ATTR_POSITION], 2, GL_FLOAT, GL_FALSE, 0, (void*) (0 * sizeof(GLfloat)));
+  glEnableVertexAttribArray(_attr_locs[MAGN_ATTR_POSITION]);
 
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, 0);
 
   _prog->release();
   _fbo->release();
 }
 
-void MagnifierEngine::drawPelengs(int pel_len, int pel_cnt, int min_pel, int min_rad) {
-  glUniform4f(_unif_locs[MAGN_UNIF_COLOR], 0.0f, 0.0f, 0.0f, 1.0f);
-  glUniform1f(_unif_locs[MAGN_UNIF_THREASHOLD], 1.f);
-
-  for (int i = 0; i < _fbo->width() - 2; i++) {
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_radar[MAGN_ATTR_POSITION]);
-    glVertexAttribPointer(_attr_locs[MAGN_ATTR_POSITION], 2, GL_FLOAT, GL_FALSE, 0, (void*) (2 * (_fbo->height()-2) * i * sizeof(GLfloat)));
-    glEnableVertexAttribArray(_attr_locs[MAGN_ATTR_POSITION]);
-
-    int amp_shift = ((min_pel + i) % pel_cnt) * pel_len + min_rad;
-
-    glBindBuffer(GL_ARRAY_BUFFER, _amp_vbo_id);
-    glVertexAttribPointer(_attr_locs[MAGN_ATTR_AMPLITUDE], 1, GL_FLOAT, GL_FALSE, 0, (void*) (amp_shift * sizeof(GLfloat)));
-    glEnableVertexAttribArray(_attr_locs[MAGN_ATTR_AMPLITUDE]);
+void MagnifierEngine::uploadWindow(const RLIState& s, const float* amps, int pel_count, int pel_len) {
+  int zoom = qBound(static_cast<int>(MIN_ZOOM), s.magn_zoom, static_cast<int>(MAX_ZOOM));
 
-    glDrawArrays(GL_POINTS, 0, (_fbo->height()-2));
-  }
+  float pixels_per_sample = std::ldexp(1.f, zoom);
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
+  // Samples under the inner area, one more for the bilinear edge
+  int pelengs = qMin(_tex_size.height(), static_cast<int>(std::ceil((_fbo->width() - 2) / pixels_per_sample)) + 1);
+  int radii   = qMin(_tex_size.width(),  static_cast<int>(std::ceil((_fbo->height() - 2) / pixels_per_sample)) + 1);
 
-void MagnifierEngine::drawBorder() {
-  glUniform4f(_unif_locs[MAGN_UNIF_COLOR], 0.0f, 1.0f, 0.0f, 1.0f);
-  glUniform1f(_unif_locs[MAGN_UNIF_THREASHOLD], 255.f);
+  _window_data.assign(static_cast<size_t>(pelengs) * radii, 0);
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_border[MAGN_ATTR_POSITION]);
-  glVertexAttribPointer(_attr_locs[MAGN_ATTR_POSITION], 2, GL_FLOAT, GL_FALSE, 0, (void*) (0 * sizeof(GLfloat)));
-  glEnableVertexAttribArray(_attr_locs[MAGN_ATTR_POSITION]);
+  if (amps != nullptr && pel_count > 0) {
+    int min_peleng = ((s.magn_min_peleng % pel_count) + pel_count) % pel_count;
 
-  glVertexAttrib1f(_attr_locs[MAGN_ATTR_AMPLITUDE], 0.f);
-  glDisableVertexAttribArray(_attr_locs[MAGN_ATTR_AMPLITUDE]);
+    for (int p = 0; p < pelengs; p++) {
+      const float* peleng = amps + static_cast<size_t>((min_peleng + p) % pel_count) * pel_len;
+      GLubyte* row = _window_data.data() + static_cast<size_t>(p) * radii;
 
-  glLineWidth(1.f);
-  glDrawArrays(GL_LINE_LOOP, 0, 4);
+      for (int r = 0, rad = s.magn_min_rad; r < radii && rad < pel_len; r++, rad++)
+        if (rad >= 0)
+          row[r] = static_cast<GLubyte>(qBound(0.f, peleng[rad], 255.f));
+    }
+  }
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D, _amp_tex_id);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, radii, pelengs, GL_LUMINANCE, GL_UNSIGNED_BYTE, _window_data.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void MagnifierEngine::initShaders() {
@@ -112,40 +142,47 @@ void MagnifierEngine::initShaders() {
   _prog->bind();
 
   _attr_locs[MAGN_ATTR_POSITION]    = _prog->attributeLocation("a_position");
-  _attr_locs[MAGN_ATTR_AMPLITUDE]   = _prog->attributeLocation("a_amplitude");
 
   _unif_locs[MAGN_UNIF_MVP]         = _prog->uniformLocation("mvp_matrix");
   _unif_locs[MAGN_UNIF_COLOR]       = _prog->uniformLocation("color");
-  _unif_locs[MAGN_UNIF_TEXTURE]     = _prog->uniformLocation("texture");
+  _unif_locs[MAGN_UNIF_AMPLITUDES]  = _prog->uniformLocation("amplitudes");
+  _unif_locs[MAGN_UNIF_PALETTE]     = _prog->uniformLocation("palette");
   _unif_locs[MAGN_UNIF_THREASHOLD]  = _prog->uniformLocation("threashold");
+  _unif_locs[MAGN_UNIF_SIZE]        = _prog->uniformLocation("size");
+  _unif_locs[MAGN_UNIF_TEX_SCALE]   = _prog->uniformLocation("tex_scale");
+  _unif_locs[MAGN_UNIF_TAP]         = _prog->uniformLocation("tap");
 
   _prog->release();
 }
 
-void MagnifierEngine::initBorderBuffers() {
-  GLfloat positions[] { 0.5f                 , 0.5f
-                      , 0.5f                 , _fbo->height()-0.5f
-                      , _fbo->width()-0.5f   , _fbo->height()-0.5f
-                      , _fbo->width()-0.5f   , 0.5f                 };
+void MagnifierEngine::initBuffers() {
+  // The whole FBO, the shader draws the border pixels
+  GLfloat positions[] { 0.f                  , 0.f
+                      , 0.f                  , float(_fbo->height())
+                      , float(_fbo->width()) , 0.f
+                      , float(_fbo->width()) , float(_fbo->height()) };
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_border[MAGN_ATTR_POSITION]);
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[MAGN_ATTR_POSITION]);
   glBufferData(GL_ARRAY_BUFFER, 8*sizeof(GLfloat), positions, GL_STATIC_DRAW);
 
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void MagnifierEngine::initRadarBuffers() {
-  std::vector<GLfloat> positions;
-
-  for (float i = 1.5; i < _fbo->width() - 1; i++) {
-    for (float j = 1.5; j < _fbo->height() - 1; j++) {
-      positions.push_back(i);
-      positions.push_back(j);
-    }
-  }
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids_radar[MAGN_ATTR_POSITION]);
-  glBufferData(GL_ARRAY_BUFFER, positions.size()*sizeof(GLfloat), positions.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+void MagnifierEngine::initTexture() {
+  // Big enough for MIN_ZOOM, radii along s and pelengs along t
+  _tex_size = QSize( ((_fbo->height() - 2) << -MIN_ZOOM) + 1
+                   , ((_fbo->width() - 2) << -MIN_ZOOM) + 1 );
+  _bilinear = false;
+
+  std::vector<GLubyte> zeros(static_cast<size_t>(_tex_size.width()) * _tex_size.height(), 0);
+
+  glBindTexture(GL_TEXTURE_2D, _amp_tex_id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, _tex_size.width(), _tex_size.height(), 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, zeros.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_2D, 0);
 }
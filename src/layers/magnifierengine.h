@@ -7,6 +7,8 @@
 #include <QSize>
 #include <QMap>
 
+#include <vector>
+
 #include <QOpenGLFunctions>
 #include <QOpenGLFramebufferObject>
 #include <QOpenGLShaderProgram>
@@ -15,6 +17,11 @@
 #include "../common/rlilayout.h"
 
 
+// Лупа. The window of pelengs [magn_min_peleng, ...) and radii [magn_min_rad, ...)
+// is copied from the radar amplitudes into a small polar texture (rows are pelengs)
+// and the whole FBO is drawn as one quad, the border included.
+// Zoom level z is 2^z pixels per sample: above 0 samples are nearest or bilinear,
+// at MIN_ZOOM every pixel takes the max of the 2x2 samples it covers
 class MagnifierEngine : public QObject, protected QOpenGLFunctions {
   Q_OBJECT
 
@@ -22,10 +29,11 @@ public:
   MagnifierEngine (const RLIMagnifierLayout& layout, QOpenGLContext* context, QObject* parent = nullptr);
   virtual ~MagnifierEngine ();
 
+  enum { MIN_ZOOM = -1, MAX_ZOOM = 2 };
+
   inline QRect geometry()   { return _geometry; }
   inline GLuint texture()   { return _fbo->texture(); }
 
-  inline void setAmplitudesVBOId(GLuint amp_vbo_id) { _amp_vbo_id = amp_vbo_id; }
   inline void setPalletteTextureId(GLuint pal_tex_id) { _pal_tex_id = pal_tex_id; }
 
   void resize(const RLIMagnifierLayout& params);
@@ -33,36 +41,43 @@ public:
 private slots:
 
 public slots:
-  void update(const RLIState& state);
+  // amps are pel_count pelengs of pel_len samples
+  void update(const RLIState& state, const float* amps, int pel_count, int pel_len);
 
 private:
   void initShaders();
-  void initBorderBuffers();
-  void initRadarBuffers();
+  void initBuffers();
+  void initTexture();
 
-  void drawBorder();
-  void drawPelengs(int pel_len, int pel_cnt, int min_pel, int min_rad);
+  void uploadWindow(const RLIState& state, const float* amps, int pel_count, int pel_len);
 
-  GLuint _amp_vbo_id;
   GLuint _pal_tex_id;
 
   QRect _geometry;
   QOpenGLFramebufferObject* _fbo;
   QOpenGLShaderProgram* _prog;
 
+  // Polar window texture, GL_LUMINANCE, _tex_size.width() radii by _tex_size.height() pelengs
+  GLuint _amp_tex_id;
+  QSize _tex_size;
+  bool _bilinear;
+  std::vector<GLubyte> _window_data;
+
   // -----------------------------------------------
 
   enum { MAGN_ATTR_POSITION = 0
-       , MAGN_ATTR_AMPLITUDE = 1
-       , MAGN_ATTR_COUNT = 2 } ;
+       , MAGN_ATTR_COUNT = 1 } ;
   enum { MAGN_UNIF_MVP = 0
        , MAGN_UNIF_COLOR = 1
-       , MAGN_UNIF_TEXTURE = 2
-       , MAGN_UNIF_THREASHOLD = 3
-       , MAGN_UNIF_COUNT = 4 } ;
-
-  GLuint _vbo_ids_border[MAGN_ATTR_COUNT];
-  GLuint _vbo_ids_radar[MAGN_ATTR_COUNT];
+       , MAGN_UNIF_AMPLITUDES = 2
+       , MAGN_UNIF_PALETTE = 3
+       , MAGN_UNIF_THREASHOLD = 4
+       , MAGN_UNIF_SIZE = 5
+       , MAGN_UNIF_TEX_SCALE = 6
+       , MAGN_UNIF_TAP = 7
+       , MAGN_UNIF_COUNT = 8 } ;
+
+  GLuint _vbo_ids[MAGN_ATTR_COUNT];
   GLuint _attr_locs[MAGN_ATTR_COUNT];
   int _unif_locs[MAGN_UNIF_COUNT];
 };
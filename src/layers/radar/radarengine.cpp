@@ -1,9 +1,17 @@
 #include "radarengine.h"
 #include "../../common/properties.h"
 
+#include "../../common/startuptrace.h"
+
 #include <QFile>
+#include <QMutex>
 #include <QMatrix4x4>
 #include <QDateTime>
+#include <QApplication>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
 
 #include <qmath.h>
 
@@ -13,11 +21,23 @@ RadarEngine::RadarEngine(int pel_count, int pel_len, int tex_radius, QOpenGLCont
   : QObject(parent), QOpenGLFunctions(context) {
   initializeOpenGLFunctions();
 
-  glGenBuffers(ATTR_COUNT, _vbo_ids);
-  glGenBuffers(1, &_ind_vbo_id);
+  _cpu_mode = qApp->property(PROPERTY_RADAR_CPU).toBool();
+  if (_cpu_mode)
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar scan conversion on CPU";
+
+  // Peleng strips are drawn only without -cpu
+  if (!_cpu_mode) {
+    glGenBuffers((RadarPyramid::MAX_LEVEL + 1) * ATTR_COUNT, &_vbo_ids[0][0]);
+    glGenBuffers(RadarPyramid::MAX_LEVEL + 1, _ind_vbo_ids);
+  }
 
   _palette = new RadarPalette(context, this);
 
+  if (_cpu_mode) {
+    glGenTextures(1, &_cpu_tex_id);
+    updateColorTable();
+  }
+
   initShader();
 
   resizeData(pel_count, pel_len);
@@ -28,14 +48,45 @@ RadarEngine::~RadarEngine() {
   delete _fbo;
   delete _program;
 
-  glDeleteBuffers(ATTR_COUNT, _vbo_ids);
-  glDeleteBuffers(1, &_ind_vbo_id);
+  if (_cpu_mode) {
+    glDeleteTextures(1, &_cpu_tex_id);
+  } else {
+    glDeleteBuffers((RadarPyramid::MAX_LEVEL + 1) * ATTR_COUNT, &_vbo_ids[0][0]);
+    glDeleteBuffers(RadarPyramid::MAX_LEVEL + 1, _ind_vbo_ids);
+  }
 
   delete _palette;
 }
 
 void RadarEngine::onBrightnessChanged(int br) {
   _palette->setBrightness(br);
+
+  if (_cpu_mode)
+    updateColorTable();
+}
+
+void RadarEngine::setTrailMode(bool trail) {
+  _palette->setTrailMode(trail);
+
+  if (_cpu_mode)
+    updateColorTable();
+}
+
+// Same lookup as radar.frag.glsl: amplitudes below threashold are transparent,
+// others take the palette texel at amp / 255
+void RadarEngine::updateColorTable() {
+  uint32_t colors[256];
+
+  colors[0] = RadarScanConverter::TRANSPARENT_COLOR;
+  for (int amp = 1; amp < 256; amp++) {
+    QRgb c = _palette->color(qMin(15, amp * 16 / 255));
+    colors[amp] = static_cast<uint32_t>(qRed(c))
+                | static_cast<uint32_t>(qGreen(c)) << 8
+                | static_cast<uint32_t>(qBlue(c)) << 16
+                | 0xFF000000u;
+  }
+
+  _converter.setColorTable(colors);
 }
 
 
@@ -67,33 +118,76 @@ void RadarEngine::resizeData(int pel_count, int pel_len) {
   _peleng_count = pel_count;
   _peleng_len = pel_len;
 
-  fillCoordTable();
+  _pyramid.resize(pel_count, pel_len);
+  if (_cpu_mode) {
+    if (_fbo != nullptr)
+      _converter.resize(pel_count, pel_len, _fbo->width() / 2);
+  } else {
+    _coords = RadarCoordTable::get(pel_count, pel_len);
+  }
+
   clearData();
 }
 
 
-void RadarEngine::fillCoordTable() {
-  _positions.clear();
-  _draw_indices.clear();
+// Every peleng of the level is a triangle strip between it and the previous one,
+// over the radius band of the level, joined to the next peleng by degenerate triangles.
+// Positions keep the index of the source peleng, so the shader is the same for all levels
+static void fillLevelCoordTable(const RadarPyramid& pyramid, int level, GLuint peleng_len, RadarCoordTable* table) {
+  GLuint count = pyramid.levelPelengCount(level);
+  GLuint len = pyramid.levelLength(level);
+  GLuint min_rad = pyramid.bandMinRadius(level);
+  GLuint max_rad = pyramid.bandMaxRadius(level);
+
+  std::vector<GLfloat>& positions = table->positions[level];
+  std::vector<GLuint>& draw_indices = table->draw_indices[level];
+
+  positions.reserve(count * len);
+  draw_indices.reserve(count * (2*(max_rad - min_rad + 1) + 2));
 
-  GLuint total = _peleng_count*_peleng_len;
+  for (GLuint index = 0; index < count; index++)
+    for (GLuint radius = 0; radius < len; radius++)
+      positions.push_back((index << level)*peleng_len + radius);
 
-  for (int index = 0; index < _peleng_count; index++) {
-    for (int radius = 0; radius < _peleng_len; radius++) {
-      GLuint curr_index = index*_peleng_len + radius;
-      GLuint prev_index = ((index-1)*_peleng_len + radius + total) % total;
+  for (GLuint index = 0; index < count; index++) {
+    GLuint prev = (index + count - 1) % count;
+    GLuint next = (index + 1) % count;
 
-      _positions.push_back(curr_index);
-      _draw_indices.push_back(curr_index);
-      _draw_indices.push_back(prev_index);      
+    for (GLuint radius = min_rad; radius <= max_rad; radius++) {
+      draw_indices.push_back(index*len + radius);
+      draw_indices.push_back(prev*len + radius);
     }
 
-    GLuint last = _draw_indices[_draw_indices.size()-1];
-    _draw_indices.push_back(last);
-    _draw_indices.push_back((last+1)%total);
+    GLuint last = draw_indices[draw_indices.size()-1];
+    draw_indices.push_back(last);
+    draw_indices.push_back(next*len + min_rad);
   }
 }
 
+std::shared_ptr<const RadarCoordTable> RadarCoordTable::get(int pel_count, int pel_len) {
+  static QMutex mutex;
+  static std::shared_ptr<const RadarCoordTable> last;
+
+  QMutexLocker locker(&mutex);
+  if (last != nullptr && last->peleng_count == pel_count && last->peleng_len == pel_len)
+    return last;
+
+  StartupTrace::Span span("Radar coord table");
+
+  RadarPyramid pyramid;
+  pyramid.layout(pel_count, pel_len);
+
+  std::shared_ptr<RadarCoordTable> table = std::make_shared<RadarCoordTable>();
+  table->peleng_count = pel_count;
+  table->peleng_len = pel_len;
+
+  for (int level = 0; level < pyramid.levelCount(); level++)
+    fillLevelCoordTable(pyramid, level, static_cast<GLuint>(pel_len), table.get());
+
+  last = table;
+  return last;
+}
+
 void RadarEngine::resizeTexture(int radius) {
   if (_fbo != nullptr && _fbo->width() == static_cast<int>(2*radius+1))
     return;
@@ -105,39 +199,72 @@ void RadarEngine::resizeTexture(int radius) {
 
   _fbo = new QOpenGLFramebufferObject(2*radius+1, 2*radius+1, format);
 
+  if (_cpu_mode) {
+    _converter.resize(_peleng_count, _peleng_len, radius);
+
+    glBindTexture(GL_TEXTURE_2D, _cpu_tex_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 2*radius+1, 2*radius+1, 0, GL_RGBA, GL_UNSIGNED_BYTE, _converter.image());
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
   clearTexture();
+  _redraw_circle = true;
 }
 
 
 void RadarEngine::clearData() {
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[ATTR_POSITION]);
-  glBufferData(GL_ARRAY_BUFFER, _peleng_count*_peleng_len*sizeof(GLfloat), _positions.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[ATTR_AMPLITUDE]);
-  glBufferData(GL_ARRAY_BUFFER, _peleng_count*_peleng_len*sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, 2*_peleng_count*(_peleng_len+1)*sizeof(GLuint), _draw_indices.data(), GL_STATIC_DRAW);
+  _pyramid.clear();
 
   _draw_circle       = false;
   _has_data          = false;
   _last_drawn_peleng = _peleng_count - 1;
   _last_added_peleng = _peleng_count - 1;
 
+  if (_cpu_mode)
+    return;
+
+  for (int level = 0; level < _pyramid.levelCount(); level++) {
+    GLsizeiptr size = _pyramid.levelPelengCount(level)*_pyramid.levelLength(level)*sizeof(GLfloat);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[level][ATTR_POSITION]);
+    glBufferData(GL_ARRAY_BUFFER, size, _coords->positions[level].data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[level][ATTR_AMPLITUDE]);
+    glBufferData(GL_ARRAY_BUFFER, size, _pyramid.levelData(level), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_ids[level]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _coords->draw_indices[level].size()*sizeof(GLuint), _coords->draw_indices[level].data(), GL_STATIC_DRAW);
+  }
+
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 
 void RadarEngine::updateData(int offset, int count, GLfloat* amps) {
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[ATTR_AMPLITUDE]);
-  glBufferSubData(GL_ARRAY_BUFFER, offset*_peleng_len*sizeof(GLfloat), count*_peleng_len*sizeof(GLfloat), amps);
+  _pyramid.update(offset, count, amps);
+
+  if (_cpu_mode) {
+    _converter.markDirty(offset, count);
+  } else {
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[0][ATTR_AMPLITUDE]);
+    glBufferSubData(GL_ARRAY_BUFFER, offset*_peleng_len*sizeof(GLfloat), count*_peleng_len*sizeof(GLfloat), amps);
+
+    for (int level = 1; level < _pyramid.levelCount(); level++)
+      uploadLevelData(level, offset >> level, (offset + count - 1) >> level);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
 
   // New last added peleng
   int nlap = (offset + count - 1) % _peleng_count;
 
   // If we recieved full circle after last draw
-  _draw_circle = (_last_added_peleng < _last_drawn_peleng && nlap >= _last_drawn_peleng) || count == _peleng_len;
+  _draw_circle = (_last_added_peleng < _last_drawn_peleng && nlap >= _last_drawn_peleng) || count >= _peleng_count;
   _last_added_peleng = nlap;
 
   if (!_has_data) {
@@ -147,6 +274,31 @@ void RadarEngine::updateData(int offset, int count, GLfloat* amps) {
   }
 }
 
+void RadarEngine::uploadLevelData(int level, int first, int last) {
+  int count = _pyramid.levelPelengCount(level);
+  int len = _pyramid.levelLength(level);
+
+  if (last - first >= count) {
+    first = 0;
+    last = count - 1;
+  }
+
+  first %= count;
+  last %= count;
+
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[level][ATTR_AMPLITUDE]);
+
+  if (first <= last) {
+    glBufferSubData( GL_ARRAY_BUFFER, first*len*sizeof(GLfloat), (last-first+1)*len*sizeof(GLfloat)
+                   , _pyramid.levelData(level) + first*len);
+  } else {
+    glBufferSubData( GL_ARRAY_BUFFER, first*len*sizeof(GLfloat), (count-first)*len*sizeof(GLfloat)
+                   , _pyramid.levelData(level) + first*len);
+    glBufferSubData( GL_ARRAY_BUFFER, 0, (last+1)*len*sizeof(GLfloat)
+                   , _pyramid.levelData(level));
+  }
+}
+
 
 void RadarEngine::clearTexture() {
   glDisable(GL_BLEND);
@@ -160,6 +312,14 @@ void RadarEngine::clearTexture() {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   _fbo->release();
+
+  if (_cpu_mode) {
+    _converter.clear();
+
+    glBindTexture(GL_TEXTURE_2D, _cpu_tex_id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _converter.width(), _converter.width(), GL_RGBA, GL_UNSIGNED_BYTE, _converter.image());
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
 }
 
 
@@ -169,10 +329,23 @@ void RadarEngine::updateTexture(const RLIState& _rli_state) {
     return;
   }
 
-  if (QVector2D(_center_shift - _rli_state.center_shift).length() > 0.5f) {
-      clearTexture();
-      _center_shift = _rli_state.center_shift;
-    }
+  if (_cpu_mode) {
+    updateCpuTexture(_rli_state);
+    return;
+  }
+
+  // The picture is moved, rotated or resized: the whole circle is drawn again
+  // from the amplitudes in the buffers, so it stays complete
+  bool shifted = QVector2D(_center_shift - _rli_state.center_shift).length() > 0.5f;
+  bool rotated = northShiftChanged(_rli_state.north_shift);
+
+  if (shifted || rotated || _redraw_circle) {
+    clearTexture();
+    _center_shift = _rli_state.center_shift;
+    _north_shift = _rli_state.north_shift;
+    _redraw_circle = false;
+    _draw_circle = true;
+  }
 
   // Calculate which pelengs we should draw
   // --------------------------------------
@@ -238,6 +411,53 @@ void RadarEngine::updateTexture(const RLIState& _rli_state) {
   _draw_circle = false;
 }
 
+void RadarEngine::updateCpuTexture(const RLIState& _rli_state) {
+  bool shifted = false;
+
+  if (northShiftChanged(_rli_state.north_shift)) {
+    _north_shift = _rli_state.north_shift;
+    _converter.markAllDirty();
+  }
+
+  if (QVector2D(_center_shift - _rli_state.center_shift).length() > 0.5f) {
+    _center_shift = _rli_state.center_shift;
+    _converter.setCenterShift(_center_shift);
+    shifted = true;
+  }
+
+  int north_shift = qRound(_rli_state.north_shift * _peleng_count / 360.0);
+
+  QRect rect = _converter.convert(_pyramid, north_shift);
+  // Pixels which went out of range after the shift are cleared too
+  if (shifted)
+    rect = QRect(0, 0, _converter.width(), _converter.width());
+  if (rect.isEmpty())
+    return;
+
+  // ES 2.0 has no GL_UNPACK_ROW_LENGTH, so the dirty rectangle is packed before upload
+  int width = _converter.width();
+  _upload_buffer.resize(static_cast<size_t>(rect.width()) * rect.height());
+
+  for (int row = 0; row < rect.height(); row++)
+    memcpy( &_upload_buffer[static_cast<size_t>(row) * rect.width()]
+          , _converter.image() + static_cast<size_t>(rect.top() + row) * width + rect.left()
+          , rect.width() * sizeof(uint32_t) );
+
+  glBindTexture(GL_TEXTURE_2D, _cpu_tex_id);
+  glTexSubImage2D( GL_TEXTURE_2D, 0, rect.left(), rect.top(), rect.width(), rect.height()
+                 , GL_RGBA, GL_UNSIGNED_BYTE, _upload_buffer.data() );
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  _last_drawn_peleng = _last_added_peleng;
+  _draw_circle = false;
+}
+
+// Rotation by less than a peleng is not visible
+bool RadarEngine::northShiftChanged(double north_shift) const {
+  double diff = std::fmod(std::fabs(north_shift - _north_shift), 360.0);
+  return std::min(diff, 360.0 - diff) >= 360.0 / _peleng_count;
+}
+
 void RadarEngine::drawPelengs(int first, int last) {
   // Clear depth when the new cycle begins to avoid the previous circle data
   if (first == 0) {
@@ -245,21 +465,30 @@ void RadarEngine::drawPelengs(int first, int last) {
     glClear(GL_DEPTH_BUFFER_BIT);
   }
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[ATTR_POSITION]);
+  glDepthFunc(GL_GREATER);
+
+  for (int level = 0; level < _pyramid.levelCount(); level++)
+    drawLevelPelengs(level, first >> level, last >> level);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void RadarEngine::drawLevelPelengs(int level, int first, int last) {
+  int strip_len = 2*(_pyramid.bandMaxRadius(level) - _pyramid.bandMinRadius(level) + 1) + 2;
+
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[level][ATTR_POSITION]);
   glVertexAttribPointer(_attr_locs[ATTR_POSITION], 1, GL_FLOAT, GL_FALSE, 0, (void*) (0 * sizeof(GLfloat)));
   glEnableVertexAttribArray(_attr_locs[ATTR_POSITION]);
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[ATTR_AMPLITUDE]);
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[level][ATTR_AMPLITUDE]);
   glVertexAttribPointer( _attr_locs[ATTR_AMPLITUDE], 1, GL_FLOAT, GL_FALSE, 0, (void*) (0 * sizeof(GLfloat)));
   glEnableVertexAttribArray(_attr_locs[ATTR_AMPLITUDE]);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_ids[level]);
 
-  glDepthFunc(GL_GREATER);
   glDrawElements( GL_TRIANGLE_STRIP
-                , (last-first+1)*(2*_peleng_len+2)
+                , (last-first+1)*strip_len
                 , GL_UNSIGNED_INT
-                , (const GLvoid*)(first*(2*_peleng_len+2) * sizeof(GLuint)));
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+                , (const GLvoid*)(first*strip_len * sizeof(GLuint)));
 }
@@ -5,6 +5,8 @@
 #include <QColor>
 #include <QVector2D>
 
+#include <memory>
+
 #include <QOpenGLFunctions>
 #include <QOpenGLFramebufferObject>
 #include <QOpenGLShaderProgram>
@@ -12,6 +14,24 @@
 
 #include "../../common/rlistate.h"
 #include "radarpalette.h"
+#include "radarpyramid.h"
+#include "radarscanconverter.h"
+
+// Vertex positions and strip indices of all pyramid levels. They depend on the radar
+// parameters only, so engines with equal parameters share one table
+struct RadarCoordTable {
+  int peleng_count = 0;
+  int peleng_len   = 0;
+
+  std::vector<GLuint> draw_indices[RadarPyramid::MAX_LEVEL + 1];
+  std::vector<GLfloat> positions[RadarPyramid::MAX_LEVEL + 1];
+
+  // Builds the table or returns the last one built for the same parameters.
+  // Thread-safe, a call during the build waits for it, so the table may be
+  // prepared on the pool before the engines are created
+  static std::shared_ptr<const RadarCoordTable> get(int pel_count, int pel_len);
+};
+
 
 // Класс для отрисовки радарного круга
 class RadarEngine : public QObject, protected QOpenGLFunctions {
@@ -21,14 +41,19 @@ public:
   virtual ~RadarEngine  ();
 
   inline QSize size()           const { return _fbo->size(); }
-  inline GLuint textureId()     const { return _fbo->texture(); }
+  inline GLuint textureId()     const { return _cpu_mode ? _cpu_tex_id : _fbo->texture(); }
 
-  inline GLuint ampsVboId()     const { return _vbo_ids[ATTR_AMPLITUDE]; }
+  // Copy of the source amplitudes, pelengCount() pelengs of pelengLength() samples
+  inline const float* amplitudes() const { return _pyramid.levelData(0); }
   inline GLuint paletteTexId()  const { return _palette->texture(); }
 
+  inline bool hasData()         const { return _has_data; }
+
   inline int pelengCount()      const { return _peleng_count; }
   inline int pelengLength()     const { return _peleng_len; }
 
+  void setTrailMode(bool trail);
+
 public slots:
   void onBrightnessChanged(int br);
 
@@ -44,9 +69,15 @@ public slots:
 private:
   void initShader();
 
-  void fillCoordTable();
+  void uploadLevelData(int level, int first, int last);
+
+  bool northShiftChanged(double north_shift) const;
 
   void drawPelengs(int first, int last);
+  void drawLevelPelengs(int level, int first, int last);
+
+  void updateColorTable();
+  void updateCpuTexture(const RLIState& _rli_state);
 
   bool _has_data = false;
 
@@ -54,12 +85,23 @@ private:
   int _peleng_count = 0;
   int _peleng_len   = 0;
 
-  std::vector<GLuint> _draw_indices;
-  std::vector<GLfloat> _positions;
+  // Near range is drawn from pelengs decimated by max, see RadarPyramid
+  RadarPyramid _pyramid;
+
+  // Scan conversion on CPU (-cpu), the image is uploaded to _cpu_tex_id
+  bool _cpu_mode;
+  RadarScanConverter _converter;
+  std::vector<uint32_t> _upload_buffer;
+  GLuint _cpu_tex_id = 0;
+
+  std::shared_ptr<const RadarCoordTable> _coords;
 
   bool  _draw_circle;
   int  _last_drawn_peleng, _last_added_peleng;
   QPointF _center_shift { 0.0, 0.0 };
+  // North shift the picture was drawn with
+  double _north_shift = 0.0;
+  bool _redraw_circle = false;
 
   // OpenGL vars
   QOpenGLFramebufferObject* _fbo = nullptr;
@@ -80,12 +122,13 @@ private:
        , UNIF_NORTH_SHIFT   = 6
        , UNIF_COUNT         = 7 } ;
 
-  GLuint _vbo_ids[ATTR_COUNT];
+  // Buffers per pyramid level
+  GLuint _vbo_ids[RadarPyramid::MAX_LEVEL + 1][ATTR_COUNT];
   // OpenGL program uniforms locations
   int _unif_locs[UNIF_COUNT];
   // OpenGL program attributres locations
   int _attr_locs[ATTR_COUNT];
-  GLuint _ind_vbo_id;
+  GLuint _ind_vbo_ids[RadarPyramid::MAX_LEVEL + 1];
 
   // Palette
   RadarPalette* _palette;
@@ -0,0 +1,188 @@
+#include "radarhistory.h"
+#include "../../common/properties.h"
+#include "../../common/rlisimd.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <QDebug>
+#include <QDateTime>
+#include <QApplication>
+
+RadarHistory::RadarHistory(int pel_count, int pel_len, int revolutions, QObject* parent) : QObject(parent) {
+  _stat = qApp->property(PROPERTY_RADAR_STAT).toBool();
+
+  _revs.resize(static_cast<size_t>(std::max(1, revolutions) + 1));
+  resize(pel_count, pel_len);
+}
+
+RadarHistory::~RadarHistory() {
+}
+
+
+void RadarHistory::resize(int pel_count, int pel_len) {
+  if (_peleng_count == pel_count && _peleng_len == pel_len)
+    return;
+
+  _peleng_count = pel_count;
+  _peleng_len = pel_len;
+  _packed.resize(static_cast<size_t>(pel_len));
+
+  clear();
+}
+
+void RadarHistory::clear() {
+  // Buffers keep their capacity, a revolution takes about the same size as the previous one
+  for (Revolution& rev : _revs) {
+    rev.data.clear();
+    rev.starts.assign(static_cast<size_t>(_peleng_count), NONE);
+    rev.msecs = 0;
+  }
+
+  _head = 0;
+  _count = 0;
+  _last_peleng = -1;
+}
+
+
+const RadarHistory::Revolution* RadarHistory::find(qint64 serial) const {
+  if (serial < firstSerial() || serial > lastSerial())
+    return nullptr;
+
+  int back = static_cast<int>(_serial - serial);
+  int size = static_cast<int>(_revs.size());
+  return &_revs[static_cast<size_t>((_head - back + size) % size)];
+}
+
+qint64 RadarHistory::revolutionMsecs(qint64 serial) const {
+  const Revolution* rev = find(serial);
+  return rev != nullptr ? rev->msecs : 0;
+}
+
+size_t RadarHistory::revolutionBytes(qint64 serial) const {
+  const Revolution* rev = find(serial);
+  return rev != nullptr ? rev->data.size() + rev->starts.size() * sizeof(uint32_t) : 0;
+}
+
+size_t RadarHistory::bytes() const {
+  size_t total = 0;
+  for (const Revolution& rev : _revs)
+    total += rev.data.capacity() + rev.starts.capacity() * sizeof(uint32_t);
+  return total;
+}
+
+
+void RadarHistory::updateData(int offset, int count, GLfloat* amps) {
+  if (_peleng_count <= 0)
+    return;
+
+  for (int i = 0; i < count; i++) {
+    int peleng = (offset + i) % _peleng_count;
+
+    if (peleng <= _last_peleng)
+      finishRevolution();
+
+    if (_last_peleng < 0)
+      _rev_timer.start();
+
+    encode(_revs[static_cast<size_t>(_head)], peleng, amps + static_cast<size_t>(i) * _peleng_len);
+    _last_peleng = peleng;
+  }
+}
+
+void RadarHistory::finishRevolution() {
+  Revolution& done = _revs[static_cast<size_t>(_head)];
+  done.msecs = _rev_timer.restart();
+
+  _head = (_head + 1) % static_cast<int>(_revs.size());
+  _count = std::min(_count + 1, capacity());
+  _serial++;
+
+  Revolution& next = _revs[static_cast<size_t>(_head)];
+  next.data.clear();
+  std::fill(next.starts.begin(), next.starts.end(), NONE);
+  _last_peleng = -1;
+
+  if (_stat) {
+    size_t raw = static_cast<size_t>(_peleng_count) * _peleng_len * sizeof(GLfloat);
+    size_t packed = revolutionBytes(lastSerial());
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+             << "Radar history: revolution" << packed / 1024 << "KB"
+             << QString("(%1% of raw),").arg(100.0 * packed / raw, 0, 'f', 1)
+             << _count << "revolutions in" << bytes() / 1024 << "KB";
+  }
+}
+
+
+void RadarHistory::encode(Revolution& rev, int peleng, const GLfloat* amps) {
+  std::vector<uint8_t>& data = rev.data;
+  rev.starts[static_cast<size_t>(peleng)] = static_cast<uint32_t>(data.size());
+
+  RLISimd::packu8(amps, _packed.data(), _packed.size());
+  const uint8_t* bytes = _packed.data();
+
+  int i = 0;
+  while (i < _peleng_len) {
+    if (bytes[i] > 0) {
+      data.push_back(bytes[i]);
+      i++;
+      continue;
+    }
+
+    int run = 1;
+    while (i + run < _peleng_len && run < 255 && bytes[i + run] == 0)
+      run++;
+
+    data.push_back(0);
+    data.push_back(static_cast<uint8_t>(run));
+    i += run;
+  }
+}
+
+void RadarHistory::decodePeleng(const Revolution& rev, int peleng, GLfloat* out) const {
+  uint32_t start = rev.starts[static_cast<size_t>(peleng)];
+  if (start == NONE) {
+    memset(out, 0, static_cast<size_t>(_peleng_len) * sizeof(GLfloat));
+    return;
+  }
+
+  const uint8_t* p = rev.data.data() + start;
+  int i = 0;
+  while (i < _peleng_len) {
+    if (*p != 0) {
+      out[i++] = *p++;
+    } else {
+      int run = p[1];
+      std::fill(out + i, out + i + run, 0.f);
+      i += run;
+      p += 2;
+    }
+  }
+}
+
+
+bool RadarHistory::decode(qint64 serial, int first, int count, GLfloat* out) const {
+  const Revolution* rev = find(serial);
+  if (rev == nullptr)
+    return false;
+
+  for (int i = 0; i < count; i++)
+    decodePeleng(*rev, (first + i) % _peleng_count, out + static_cast<size_t>(i) * _peleng_len);
+
+  return true;
+}
+
+void RadarHistory::decodeLatest(GLfloat* out) const {
+  const Revolution& current = _revs[static_cast<size_t>(_head)];
+  const Revolution* last = find(lastSerial());
+
+  for (int peleng = 0; peleng < _peleng_count; peleng++) {
+    GLfloat* dst = out + static_cast<size_t>(peleng) * _peleng_len;
+
+    if (current.starts[static_cast<size_t>(peleng)] != NONE || last == nullptr)
+      decodePeleng(current, peleng, dst);
+    else
+      decodePeleng(*last, peleng, dst);
+  }
+}
@@ -0,0 +1,80 @@
+#ifndef RADARHISTORY_H
+#define RADARHISTORY_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QOpenGLFunctions>
+
+// История обзоров для стоп-кадра.
+// Keeps the last revolutions of processed video in a ring. Samples are truncated
+// to bytes as in the processor history and every peleng is run-length encoded:
+// a zero byte is followed by the length of the zero run, other bytes are literal.
+// A revolution ends when the peleng index goes back, so the ring holds
+// the revolution being received and up to capacity() complete ones.
+// Complete revolutions are numbered by serial, the newest has lastSerial().
+class RadarHistory : public QObject {
+  Q_OBJECT
+public:
+  explicit RadarHistory(int pel_count, int pel_len, int revolutions, QObject* parent = nullptr);
+  virtual ~RadarHistory();
+
+  inline int capacity()         const { return static_cast<int>(_revs.size()) - 1; }
+  inline int count()            const { return _count; }
+  inline bool isEmpty()         const { return _count == 0; }
+
+  inline qint64 firstSerial()   const { return _serial - _count; }
+  inline qint64 lastSerial()    const { return _serial - 1; }
+
+  // Pelengs [first, first + count) of a complete revolution, missing pelengs are zero
+  bool decode(qint64 serial, int first, int count, GLfloat* out) const;
+  // Every peleng from the revolution being received or, if it has not come yet, the last complete one
+  void decodeLatest(GLfloat* out) const;
+
+  // Receive time of a complete revolution
+  qint64 revolutionMsecs(qint64 serial) const;
+  size_t revolutionBytes(qint64 serial) const;
+  size_t bytes() const;
+
+public slots:
+  void resize(int pel_count, int pel_len);
+  void clear();
+
+  void updateData(int offset, int count, GLfloat* amps);
+
+private:
+  struct Revolution {
+    std::vector<uint8_t> data;
+    // Start of every peleng in data, NONE if it has not come
+    std::vector<uint32_t> starts;
+    qint64 msecs = 0;
+  };
+
+  enum : uint32_t { NONE = 0xFFFFFFFFu };
+
+  const Revolution* find(qint64 serial) const;
+  void encode(Revolution& rev, int peleng, const GLfloat* amps);
+  void decodePeleng(const Revolution& rev, int peleng, GLfloat* out) const;
+  void finishRevolution();
+
+  int _peleng_count = 0;
+  int _peleng_len   = 0;
+
+  // _revs[_head] is being received, complete ones go back from it
+  std::vector<Revolution> _revs;
+  int _head = 0;
+  int _count = 0;
+  qint64 _serial = 0;
+
+  int _last_peleng = -1;
+  QElapsedTimer _rev_timer;
+
+  // Peleng packed to bytes before encoding
+  std::vector<uint8_t> _packed;
+
+  bool _stat;
+};
+
+#endif // RADARHISTORY_H
@@ -25,6 +25,7 @@ RadarPalette::RadarPalette(QOpenGLContext* context, QObject* parent)
 
   rgbRLI_Var = 0;
   brightnessRLI = 255;
+  trailMode = false;
 
   tex = new QOpenGLTexture(QOpenGLTexture::Target2D);
 
@@ -58,6 +59,11 @@ void RadarPalette::setBrightness(int val) {
   updatePalette();
 }
 
+void RadarPalette::setTrailMode(bool val) {
+  trailMode = val;
+  updatePalette();
+}
+
 
 
 void RadarPalette::updatePalette() {
@@ -98,7 +104,13 @@ void RadarPalette::updatePalette() {
   for (int j = 0; j < 16; j++) {
     float R, G, B;
 
-    if (j == 0) {
+    if (trailMode) {
+      // Следы: линейно от цвета фона до цвета следов
+      const rgbRLI_struct& c = rgbRLI[rgbRLI_Var][n];
+      R = br * (c.Rbg + j * (c.Rtk - c.Rbg) / 15.f);
+      G = br * (c.Gbg + j * (c.Gtk - c.Gbg) / 15.f);
+      B = br * (c.Bbg + j * (c.Btk - c.Bbg) / 15.f);
+    } else if (j == 0) {
       // Вычисление цвета фона
       R = br * rgbRLI[rgbRLI_Var][n].Rbg;
       G = br * rgbRLI[rgbRLI_Var][n].Gbg;
@@ -124,8 +136,10 @@ void RadarPalette::updatePalette() {
   }
 
   QImage img(1, 16, QImage::Format_RGB888);
-  for (int i = 0; i < 16; i++)
-    img.setPixel(0, i, qRgb(palette[i][0], palette[i][1], palette[i][2]));
+  for (int i = 0; i < 16; i++) {
+    colors[i] = qRgb(palette[i][0], palette[i][1], palette[i][2]);
+    img.setPixel(0, i, colors[i]);
+  }
 
   tex->destroy();
   tex->setData(img, QOpenGLTexture::DontGenerateMipMaps);
@@ -3,6 +3,7 @@
 
 #include <QOpenGLFunctions>
 #include <QOpenGLTexture>
+#include <QColor>
 
 // Класс для расчета радарной палитры
 class RadarPalette : public QObject, protected QOpenGLFunctions {
@@ -14,8 +15,12 @@ public:
 
   void setRgbVar(int var);
   void setBrightness(int br);
+  // Палитра следов: от цвета фона до цвета следов
+  void setTrailMode(bool trail);
 
   inline GLuint texture() { return tex->textureId(); }
+  // Цвет градации 0..15
+  inline QRgb color(int i) const { return colors[i]; }
 
 private:
   // Расчёт зависимости RGBкодов цвета от амплитуды входного сигнала
@@ -24,8 +29,10 @@ private:
   // Параметры:
   int rgbRLI_Var;         //Текущая палитра (день/ночь)
   int brightnessRLI;      //Яркость РЛИ 0..255
+  bool trailMode;         //Палитра следов
 
   // Текущая палитра
+  QRgb colors[16];
   QOpenGLTexture* tex;
 };
 
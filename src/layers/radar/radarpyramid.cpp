@@ -0,0 +1,97 @@
+#include "radarpyramid.h"
+#include "../../common/rlisimd.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+static double const PI = acos(-1);
+
+RadarPyramid::RadarPyramid() {
+  for (int i = 0; i <= MAX_LEVEL; i++) {
+    _band_min[i] = 0;
+    _band_max[i] = -1;
+  }
+}
+
+void RadarPyramid::resize(int pel_count, int pel_len) {
+  layout(pel_count, pel_len);
+
+  for (int k = 0; k <= MAX_LEVEL; k++) {
+    if (k < _level_count)
+      _levels[k].assign(static_cast<size_t>(levelPelengCount(k)) * levelLength(k), 0.f);
+    else
+      std::vector<float>().swap(_levels[k]);
+  }
+}
+
+void RadarPyramid::layout(int pel_count, int pel_len) {
+  _peleng_count = pel_count;
+  _peleng_len = pel_len;
+
+  _level_count = 1;
+  while ( _level_count <= MAX_LEVEL
+       && (pel_count >> _level_count) >= MIN_LEVEL_PELENGS
+       && (pel_count % (1 << _level_count)) == 0 )
+    _level_count++;
+
+  // Radius at which the arc between two pelengs of level k is one pixel
+  auto one_pixel_radius = [pel_count](int k) {
+    return static_cast<int>(std::ceil(pel_count / (2.0 * PI * (1 << k))));
+  };
+
+  _band_max[0] = pel_len - 1;
+  _band_min[0] = (_level_count > 1) ? std::min(one_pixel_radius(1), pel_len - 1) : 0;
+
+  for (int k = 1; k < _level_count; k++) {
+    _band_max[k] = _band_min[k-1];
+    _band_min[k] = (k == _level_count - 1) ? 0 : std::min(one_pixel_radius(k+1), _band_max[k]);
+  }
+}
+
+void RadarPyramid::clear() {
+  for (int k = 0; k < _level_count; k++)
+    std::fill(_levels[k].begin(), _levels[k].end(), 0.f);
+}
+
+int RadarPyramid::levelForRadius(int radius) const {
+  for (int k = 0; k < _level_count; k++)
+    if (radius >= _band_min[k])
+      return k;
+
+  return _level_count - 1;
+}
+
+void RadarPyramid::update(int offset, int count, const float* amps) {
+  if (_peleng_count <= 0 || count <= 0)
+    return;
+
+  count = std::min(count, _peleng_count);
+
+  for (int i = 0; i < count; i++) {
+    int peleng = (offset + i) % _peleng_count;
+    memcpy(&_levels[0][static_cast<size_t>(peleng) * _peleng_len], amps + static_cast<size_t>(i) * _peleng_len, _peleng_len * sizeof(float));
+  }
+
+  for (int k = 1; k < _level_count; k++) {
+    int lvl_count = levelPelengCount(k);
+    int src_len = levelLength(k-1);
+    int dst_len = levelLength(k);
+
+    int first = offset >> k;
+    int last = (offset + count - 1) >> k;
+    if (last - first >= lvl_count)
+      last = first + lvl_count - 1;
+
+    const float* src = _levels[k-1].data();
+    float* dst = _levels[k].data();
+
+    for (int c = first; c <= last; c++) {
+      size_t pel = static_cast<size_t>(c % lvl_count);
+      RLISimd::maxf( src + (2*pel) * src_len
+                   , src + (2*pel + 1) * src_len
+                   , dst + pel * dst_len
+                   , static_cast<size_t>(dst_len) );
+    }
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef RADARPYRAMID_H
+#define RADARPYRAMID_H
+
+#include <vector>
+
+// Пирамида прореженных по пеленгу амплитуд для ближней зоны.
+// Near the center hundreds of pelengs fall into one pixel, so every level k
+// keeps pel_count >> k pelengs, each one the max of two pelengs of level k-1.
+// Level k is used for radii in [bandMinRadius(k), bandMaxRadius(k)], where the
+// arc between two of its pelengs is 0.5..1 pixel. Level 0 is the source data.
+class RadarPyramid {
+public:
+  enum { MAX_LEVEL = 6, MIN_LEVEL_PELENGS = 64 };
+
+  RadarPyramid();
+
+  void resize(int pel_count, int pel_len);
+  // Levels and bands of resize() without the level data
+  void layout(int pel_count, int pel_len);
+  void clear();
+
+  // Takes a block of source pelengs and refreshes every coarser level
+  void update(int offset, int count, const float* amps);
+
+  inline int levelCount()               const { return _level_count; }
+  inline int levelPelengCount(int lvl)  const { return _peleng_count >> lvl; }
+  // Stored samples per peleng of level lvl (radii 0..bandMaxRadius)
+  inline int levelLength(int lvl)       const { return _band_max[lvl] + 1; }
+  inline const float* levelData(int lvl) const { return _levels[lvl].data(); }
+
+  inline int bandMinRadius(int lvl)     const { return _band_min[lvl]; }
+  inline int bandMaxRadius(int lvl)     const { return _band_max[lvl]; }
+
+  int levelForRadius(int radius) const;
+
+private:
+  int _peleng_count = 0;
+  int _peleng_len   = 0;
+  int _level_count  = 1;
+
+  int _band_min[MAX_LEVEL + 1];
+  int _band_max[MAX_LEVEL + 1];
+
+  // Level 0 is a copy of the source data, it is needed to rebuild
+  // coarse pelengs which are only partially covered by an incoming block
+  std::vector<float> _levels[MAX_LEVEL + 1];
+};
+
+#endif // RADARPYRAMID_H
@@ -0,0 +1,184 @@
+#include "radarscanconverter.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+static double const PI = acos(-1);
+
+const uint32_t RadarScanConverter::TRANSPARENT_COLOR;
+
+RadarScanConverter::RadarScanConverter() {
+  for (int i = 0; i < 256; i++)
+    _colors[i] = TRANSPARENT_COLOR;
+}
+
+void RadarScanConverter::resize(int pel_count, int pel_len, int tex_radius) {
+  if (_peleng_count == pel_count && _peleng_len == pel_len && _width == 2*tex_radius+1)
+    return;
+
+  _peleng_count = pel_count;
+  _peleng_len = pel_len;
+  _width = 2*tex_radius+1;
+
+  _image.assign(static_cast<size_t>(_width)*_width, TRANSPARENT_COLOR);
+
+  fillLookupTables();
+}
+
+void RadarScanConverter::setCenterShift(const QPointF& shift) {
+  if (_center_shift == shift)
+    return;
+
+  _center_shift = shift;
+  fillLookupTables();
+  clear();
+}
+
+void RadarScanConverter::setColorTable(const uint32_t* colors) {
+  std::copy(colors, colors + 256, _colors);
+  markAllDirty();
+}
+
+void RadarScanConverter::clear() {
+  std::fill(_image.begin(), _image.end(), TRANSPARENT_COLOR);
+  markAllDirty();
+}
+
+void RadarScanConverter::markAllDirty() {
+  _all_dirty = true;
+}
+
+void RadarScanConverter::markDirty(int offset, int count) {
+  int sector_count = static_cast<int>(_dirty.size());
+  if (sector_count == 0 || count <= 0)
+    return;
+
+  int first = offset / SECTOR_PELENGS;
+  int last = (offset + count - 1) / SECTOR_PELENGS;
+  if (last - first >= sector_count)
+    last = first + sector_count - 1;
+
+  for (int s = first; s <= last; s++)
+    _dirty[s % sector_count] = 1;
+}
+
+
+// Pixel centers are mapped the same way as radar.vert.glsl maps pelengs to the FBO:
+// x = r*sin(phi), y = -r*cos(phi) around the shifted center, inside the FBO circle only
+void RadarScanConverter::fillLookupTables() {
+  int sector_count = std::max(1, _peleng_count / SECTOR_PELENGS);
+
+  _sectors.assign(sector_count, Sector());
+  _dirty.assign(sector_count, 0);
+  _all_dirty = true;
+
+  if (_peleng_count <= 0 || _width <= 0)
+    return;
+
+  double fbo_radius = _width / 2.0;
+  double cx = fbo_radius + _center_shift.x();
+  double cy = fbo_radius + _center_shift.y();
+
+  for (int row = 0; row < _width; row++) {
+    for (int col = 0; col < _width; col++) {
+      double fx = col + 0.5;
+      double fy = row + 0.5;
+
+      if (std::hypot(fx - fbo_radius, fy - fbo_radius) > fbo_radius)
+        continue;
+
+      double dx = fx - cx;
+      double dy = fy - cy;
+
+      int radius = static_cast<int>(std::sqrt(dx*dx + dy*dy) + 0.5);
+      if (radius >= _peleng_len)
+        continue;
+
+      double phi = atan2(dx, -dy);
+      int bearing = static_cast<int>(std::floor((phi / (2*PI)) * _peleng_count + 0.5));
+      bearing = ((bearing % _peleng_count) + _peleng_count) % _peleng_count;
+
+      Sector& sector = _sectors[std::min(bearing / SECTOR_PELENGS, sector_count - 1)];
+
+      Entry e;
+      e.pixel   = static_cast<uint32_t>(row*_width + col);
+      e.bearing = static_cast<uint16_t>(bearing);
+      e.radius  = static_cast<uint16_t>(radius);
+      sector.entries.push_back(e);
+
+      sector.rect |= QRect(col, row, 1, 1);
+    }
+  }
+}
+
+
+QRect RadarScanConverter::convert(const RadarPyramid& pyramid, int north_shift_pelengs) {
+  if (_peleng_count <= 0)
+    return QRect();
+
+  int sector_count = static_cast<int>(_sectors.size());
+
+  QVector<int> sectors;
+
+  if (_all_dirty) {
+    for (int s = 0; s < sector_count; s++)
+      sectors.push_back(s);
+  } else {
+    // Source sectors are rotated by the north shift, so one of them touches two image sectors
+    std::vector<char> touched(sector_count, 0);
+    int shift = ((north_shift_pelengs % _peleng_count) + _peleng_count) % _peleng_count;
+
+    for (int s = 0; s < sector_count; s++) {
+      if (!_dirty[s])
+        continue;
+
+      int first = (s*SECTOR_PELENGS + shift) % _peleng_count;
+      int last = (first + SECTOR_PELENGS - 1) % _peleng_count;
+      touched[std::min(first / SECTOR_PELENGS, sector_count - 1)] = 1;
+      touched[std::min(last / SECTOR_PELENGS, sector_count - 1)] = 1;
+    }
+
+    for (int s = 0; s < sector_count; s++)
+      if (touched[s])
+        sectors.push_back(s);
+  }
+
+  std::fill(_dirty.begin(), _dirty.end(), 0);
+  _all_dirty = false;
+
+  QtConcurrent::blockingMap(sectors, [this, &pyramid, north_shift_pelengs](int& sector) {
+    convertSector(pyramid, sector, north_shift_pelengs);
+  });
+
+  QRect rect;
+  for (int s : sectors)
+    rect |= _sectors[s].rect;
+
+  return rect;
+}
+
+void RadarScanConverter::convertSector(const RadarPyramid& pyramid, int sector, int north_shift_pelengs) {
+  int levels = pyramid.levelCount();
+
+  const float* data[RadarPyramid::MAX_LEVEL + 1];
+  int lengths[RadarPyramid::MAX_LEVEL + 1];
+  for (int k = 0; k < levels; k++) {
+    data[k] = pyramid.levelData(k);
+    lengths[k] = pyramid.levelLength(k);
+  }
+
+  int shift = ((north_shift_pelengs % _peleng_count) + _peleng_count) % _peleng_count;
+
+  for (const Entry& e : _sectors[sector].entries) {
+    int peleng = (e.bearing - shift + _peleng_count) % _peleng_count;
+    int k = pyramid.levelForRadius(e.radius);
+
+    float amp = data[k][(peleng >> k)*lengths[k] + e.radius];
+    int index = std::min(255, std::max(0, static_cast<int>(amp)));
+
+    _image[e.pixel] = _colors[index];
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef RADARSCANCONVERTER_H
+#define RADARSCANCONVERTER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <QRect>
+#include <QPointF>
+
+#include "radarpyramid.h"
+
+// Программное преобразование радарной развертки в растр.
+// Used by RadarEngine when there is no GPU to rasterize peleng strips.
+// Every pixel of the circle image is mapped once to a (bearing, radius) pair,
+// near range pixels read the max-decimated pelengs of RadarPyramid.
+// Pixels are grouped by angular sectors which are converted on the thread pool.
+class RadarScanConverter {
+public:
+  enum { SECTOR_PELENGS = 1 << RadarPyramid::MAX_LEVEL };
+
+  RadarScanConverter();
+
+  void resize(int pel_count, int pel_len, int tex_radius);
+  void setCenterShift(const QPointF& shift);
+
+  // Colors for amplitudes 0..255, RGBA byte order
+  void setColorTable(const uint32_t* colors);
+
+  void clear();
+
+  void markDirty(int offset, int count);
+  void markAllDirty();
+
+  // Converts dirty sectors and returns the image area which has changed
+  QRect convert(const RadarPyramid& pyramid, int north_shift_pelengs);
+
+  inline int width()              const { return _width; }
+  inline const uint32_t* image()  const { return _image.data(); }
+
+  static const uint32_t TRANSPARENT_COLOR = 0x00FFFFFF;
+
+private:
+  struct Entry {
+    uint32_t pixel;
+    uint16_t bearing;
+    uint16_t radius;
+  };
+
+  struct Sector {
+    std::vector<Entry> entries;
+    QRect rect;
+  };
+
+  void fillLookupTables();
+  void convertSector(const RadarPyramid& pyramid, int sector, int north_shift_pelengs);
+
+  int _peleng_count = 0;
+  int _peleng_len   = 0;
+  int _width        = 0;
+
+  QPointF _center_shift { 0.0, 0.0 };
+
+  std::vector<Sector> _sectors;
+  // Dirty sectors in the source peleng space
+  std::vector<char> _dirty;
+  bool _all_dirty = true;
+
+  std::vector<uint32_t> _image;
+  uint32_t _colors[256];
+};
+
+#endif // RADARSCANCONVERTER_H
@@ -0,0 +1,71 @@
+#include "radartrails.h"
+#include "../../common/rlisimd.h"
+
+#include <cmath>
+#include <algorithm>
+
+// Amplitude below which the radar shader draws nothing
+static const float TRAIL_THREASHOLD = 1.f;
+
+RadarTrails::RadarTrails(int pel_count, int pel_len, QObject* parent) : QObject(parent) {
+  resize(pel_count, pel_len);
+  setRevolutions(_revolutions);
+}
+
+RadarTrails::~RadarTrails() {
+}
+
+
+void RadarTrails::resize(int pel_count, int pel_len) {
+  if (_peleng_count == pel_count && _peleng_len == pel_len)
+    return;
+
+  _peleng_count = pel_count;
+  _peleng_len = pel_len;
+
+  _accum.assign(static_cast<size_t>(pel_count) * pel_len, 0.f);
+  _trails.assign(static_cast<size_t>(pel_count) * pel_len, 0.f);
+}
+
+void RadarTrails::clear() {
+  std::fill(_accum.begin(), _accum.end(), 0.f);
+  std::fill(_trails.begin(), _trails.end(), 0.f);
+}
+
+void RadarTrails::setEnabled(bool enabled) {
+  if (_enabled == enabled)
+    return;
+
+  _enabled = enabled;
+  clear();
+}
+
+void RadarTrails::setRevolutions(int revs) {
+  _revolutions = std::max(1, revs);
+  // 255 * decay^revolutions == TRAIL_THREASHOLD
+  _decay = static_cast<float>(std::pow(TRAIL_THREASHOLD / 255.0, 1.0 / _revolutions));
+}
+
+
+void RadarTrails::updateData(int offset, int count, GLfloat* amps) {
+  if (!_enabled || _peleng_count <= 0)
+    return;
+
+  count = std::min(count, _peleng_count);
+
+  // The block is split where it wraps over the circle start,
+  // RadarEngine::updateData takes only contiguous pelengs
+  int first = offset % _peleng_count;
+  while (count > 0) {
+    int part = std::min(count, _peleng_count - first);
+    size_t pos = static_cast<size_t>(first) * _peleng_len;
+    size_t n = static_cast<size_t>(part) * _peleng_len;
+
+    RLISimd::decayMaxf(&_accum[pos], amps, _decay, &_trails[pos], n);
+    emit updateTrailData(first, part, &_trails[pos]);
+
+    amps += n;
+    count -= part;
+    first = 0;
+  }
+}
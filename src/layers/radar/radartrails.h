@@ -0,0 +1,48 @@
+#ifndef RADARTRAILS_H
+#define RADARTRAILS_H
+
+#include <vector>
+
+#include <QObject>
+#include <QOpenGLFunctions>
+
+// Накопление следов (послесвечения) радарного видео.
+// Keeps a polar accumulation buffer of the same size as the radar data.
+// Every incoming peleng decays its own accumulated samples once per revolution
+// and takes the max with the new echo, so the cost follows the data rate.
+// The decayed history is emitted as trail amplitudes for the tails RadarEngine.
+class RadarTrails : public QObject {
+  Q_OBJECT
+public:
+  explicit RadarTrails(int pel_count, int pel_len, QObject* parent = nullptr);
+  virtual ~RadarTrails();
+
+  inline bool isEnabled()       const { return _enabled; }
+  inline int revolutions()      const { return _revolutions; }
+
+signals:
+  void updateTrailData(int offset, int count, GLfloat* amps);
+
+public slots:
+  void resize(int pel_count, int pel_len);
+  void clear();
+
+  void setEnabled(bool enabled);
+  // Number of revolutions after which the strongest echo fades out
+  void setRevolutions(int revs);
+
+  void updateData(int offset, int count, GLfloat* amps);
+
+private:
+  bool _enabled = false;
+  int _revolutions = 4;
+  float _decay = 1.f;
+
+  int _peleng_count = 0;
+  int _peleng_len   = 0;
+
+  std::vector<GLfloat> _accum;
+  std::vector<GLfloat> _trails;
+};
+
+#endif // RADARTRAILS_H
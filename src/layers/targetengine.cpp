@@ -3,21 +3,40 @@
 #include "../common/properties.h"
 #include "../common/rlimath.h"
 
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
 #include <QImage>
 #include <QDateTime>
 
 
 TargetEngine::TargetEngine(QOpenGLContext* context, QObject* parent) : QObject(parent), QOpenGLFunctions(context) {
   _tailsTime = 1;
-  _selected = "";
+  _selected = -1;
+
+  _has_origin = false;
 
-  startTimer(2000);
+  _capacity = 0;
+  _all_dirty = true;
+
+  _tail_head = 0;
+  _tail_vbo_capacity = 0;
+  for (int row = 0; row < TAIL_POINTS; row++) {
+    _tail_dirty_first[row] = INT_MAX;
+    _tail_dirty_last[row] = -1;
+  }
+
+  _tails_clock.start();
+  connect(&_tailsTimer, SIGNAL(timeout()), this, SLOT(onTailsTimer()));
+  onTailsModeChanged(0, _tailsTime);
 
   initializeOpenGLFunctions();
 
   _prog = new QOpenGLShaderProgram();
 
   glGenBuffers(1, &_ind_vbo_id);
+  glGenBuffers(1, &_tail_vbo_id);
   glGenBuffers(AIS_TRGT_ATTR_COUNT, _vbo_ids);
 
   initShader();
@@ -32,104 +51,276 @@ TargetEngine::~TargetEngine() {
   //delete _selection_tex;
 
   glDeleteBuffers(AIS_TRGT_ATTR_COUNT, _vbo_ids);
+  glDeleteBuffers(1, &_tail_vbo_id);
   glDeleteBuffers(1, &_ind_vbo_id);
 }
 
+// Picks the nearest target within 32 pixels,
+// a click next to the selected one moves to the next nearest
 void TargetEngine::select(const GeoPos& coords, double scale) {
-  for (const QString& tag: _targets.keys()) {
-    if (tag == _selected)
-      continue;
+  double x, y;
+  toLocal(coords, x, y);
+  _index.nearest(x, y, _index.size(), 32 * scale, _found);
 
-    float dist = RLIMath::GCDistance(coords.lat, coords.lon, _targets[tag].latitude, _targets[tag].longtitude);
+  if (!_found.empty()) {
+    auto it = std::find(_found.begin(), _found.end(), _slot_index.value(_selected, -1));
+    int slot = (it == _found.end()) ? _found[0] : _found[(it - _found.begin() + 1) % _found.size()];
 
-    if ((1000 * dist / scale) < 32) {
-      _selected = tag;
-      emit selectedTargetUpdated(_selected, _targets[_selected]);
-      return;
+    if (_slot_keys[slot] != _selected) {
+      _selected = _slot_keys[slot];
+      emit selectedTargetUpdated(_slot_tags[slot], _slot_trgts[slot]);
     }
   }
 }
 
+int TargetEngine::countInSector(const GeoPos& center, double min_radius, double max_radius, double min_angle, double max_angle) {
+  double cx, cy;
+  toLocal(center, cx, cy);
+  _index.radius(cx, cy, max_radius, _found);
 
-void TargetEngine::timerEvent(QTimerEvent* e) {
-  Q_UNUSED(e);
+  double width = fmod(fmod(max_angle - min_angle, 360.0) + 360.0, 360.0);
+  int count = 0;
 
-  _trgtsMutex.lock();
+  for (int slot : _found) {
+    double x, y;
+    toLocal(GeoPos(_slot_trgts[slot].latitude, _slot_trgts[slot].longtitude), x, y);
 
-  QList<QString> tags = _targets.keys();
-  for (int i = 0; i < tags.count(); i++) {
-    QString tag = tags[i];
-    _tails[tag].push_back(QVector2D(_targets[tag].latitude,_targets[tag].longtitude));
+    double dx = x - cx, dy = y - cy;
+    if (dx*dx + dy*dy < min_radius*min_radius)
+      continue;
 
-    while (_tails[tag].size() > TRG_TAIL_NUM)
-      _tails[tag].removeFirst();
+    double bearing = RLIMath::degs(atan2(dx, dy));
+    if (fmod(fmod(bearing - min_angle, 360.0) + 360.0, 360.0) <= width)
+      count++;
   }
 
-  _trgtsMutex.unlock();
+  return count;
+}
+
+void TargetEngine::toLocal(const GeoPos& pos, double& x, double& y) const {
+  x = RLIMath::rads(pos.lon - _origin.lon) * RLIMath::ERADM * cos(RLIMath::rads(_origin.lat));
+  y = RLIMath::rads(pos.lat - _origin.lat) * RLIMath::ERADM;
+}
+
+
+// Writes the ring row at the head for every slot, the row older than the whole ring is overwritten
+void TargetEngine::onTailsTimer() {
+  int count = _slot_tags.size();
+  if (count == 0)
+    return;
+
+  GLfloat now = _tails_clock.elapsed() / 1000.f;
+  int prev = (_tail_head + TAIL_POINTS - 1) % TAIL_POINTS;
+
+  for (int slot = 0; slot < count; slot++) {
+    const RLITarget& trgt = _slot_trgts[slot];
+    const GLfloat* last = &_tails[6*(prev*_capacity + slot) + 3];
+    GLfloat* seg = &_tails[6*(_tail_head*_capacity + slot)];
+
+    // The first sample of a target is a point
+    seg[0] = (last[2] < 0) ? trgt.latitude : last[0];
+    seg[1] = (last[2] < 0) ? trgt.longtitude : last[1];
+    seg[2] = now;
+    seg[3] = trgt.latitude;
+    seg[4] = trgt.longtitude;
+    seg[5] = now;
+  }
+
+  markTailDirty(_tail_head, 0);
+  markTailDirty(_tail_head, count - 1);
+  _tail_head = (_tail_head + 1) % TAIL_POINTS;
 }
 
 void TargetEngine::onTailsModeChanged(int mode, int minutes) {
   Q_UNUSED(mode);
 
-  if (_tailsTimer.isActive())
-      _tailsTimer.stop();
-
+  _tailsTimer.stop();
   _tailsTime = minutes;
 
-  if(_tailsTime <= 0) {
-    _trgtsMutex.lock();
-    //qDebug() << QDateTime::currentDateTime() << ": " << "onTailsTimer";
+  // The ring covers the whole tail time, older samples are faded out by the shader
+  if (_tailsTime > 0)
+    _tailsTimer.start((_tailsTime * 60 * 1000) / TAIL_POINTS);
+}
+
+void TargetEngine::addFeed(TargetFeed* feed) {
+  _feeds.push_back(feed);
+}
+
+bool TargetEngine::hasUpdates() const {
+  for (TargetFeed* feed : _feeds)
+    if (feed->pending())
+      return true;
+
+  if (_all_dirty || !_dirty_slots.empty())
+    return true;
+
+  for (int row = 0; row < TAIL_POINTS; row++)
+    if (_tail_dirty_first[row] <= _tail_dirty_last[row])
+      return true;
+
+  return false;
+}
+
+void TargetEngine::update() {
+  int count = _slot_tags.size();
 
-    QList<QString> tags = _targets.keys();
-    for (int i = 0; i < tags.count(); i++) {
-      QString tag = tags[i];
-      _tails[tag].push_back(QVector2D(_targets[tag].latitude,_targets[tag].longtitude));
+  for (int f = 0; f < _feeds.size(); f++) {
+    const TargetBatch* batch = _feeds[f]->take();
+    if (batch == nullptr)
+      continue;
+
+    for (int i = 0; i < batch->size(); i++) {
+      qint64 key = (static_cast<qint64>(f) << 32) | batch->ids[i];
 
-      if (_tails[tag].size() > TRG_TAIL_NUM)
-        _tails[tag].removeFirst();
+      if (batch->removed[i])
+        removeTarget(key);
+      else
+        setTarget(key, _feeds[f]->tagPrefix() + QString::number(batch->ids[i]), batch->targets[i]);
     }
+  }
+
+  if (_slot_tags.size() != count)
+    emit targetCountChanged(_slot_tags.size());
+}
+
+// Returns true for a new target, the tag is used only for new ones
+bool TargetEngine::setTarget(qint64 key, const QString& tag, const RLITarget& target) {
+  auto it = _slot_index.find(key);
+
+  if (!_has_origin) {
+    _origin = GeoPos(target.latitude, target.longtitude);
+    _has_origin = true;
+  }
+
+  if (it == _slot_index.end()) {
+    int slot = _slot_tags.size();
+    _slot_index.insert(key, slot);
+    _slot_keys.push_back(key);
+    _slot_tags.push_back(tag);
+    _slot_trgts.push_back(target);
 
-    _trgtsMutex.unlock();
+    reserveSlots(slot + 1);
+    writeSlot(slot);
+
+    _selected = key;
+    return true;
   }
-  else
-    _tailsTimer.start((_tailsTime * 60 * 1000) / TRG_TAIL_NUM);
+
+  int slot = it.value();
+  _slot_trgts[slot] = target;
+  writeSlot(slot);
+
+  if (key == _selected)
+    emit selectedTargetUpdated(_slot_tags[slot], target);
+
+  return false;
 }
 
-void TargetEngine::updateTarget(QString tag, RLITarget target) {
-  _trgtsMutex.lock();
+bool TargetEngine::removeTarget(qint64 key) {
+  auto it = _slot_index.find(key);
+  if (it == _slot_index.end())
+    return false;
 
-  if (!_targets.contains(tag)) {
-    _targets.insert(tag, target);
-    _tails.insert(tag, QList<QVector2D>());
-    _selected = tag;
-    emit targetCountChanged(_targets.size());
-  } else {
-    _targets[tag] = target;
-    if (tag == _selected)
-      emit selectedTargetUpdated(tag, target);
+  int slot = it.value();
+  int last = _slot_tags.size() - 1;
+  QString tag = _slot_tags[slot];
+  _slot_index.erase(it);
+
+  _index.remove(last);
+
+  if (slot != last) {
+    _slot_keys[slot] = _slot_keys[last];
+    _slot_tags[slot] = _slot_tags[last];
+    _slot_trgts[slot] = _slot_trgts[last];
+    _slot_index[_slot_keys[slot]] = slot;
+    writeSlot(slot);
   }
 
-  _trgtsMutex.unlock();
+  _slot_keys.pop_back();
+  _slot_tags.pop_back();
+  _slot_trgts.pop_back();
+  moveTail(last, slot);
+
+  if (key == _selected) {
+    emit selectedTargetUpdated(tag, RLITarget());
+    _selected = -1;
+  }
+
+  return true;
 }
 
 
-void TargetEngine::deleteTarget(QString tag) {
-  _trgtsMutex.lock();
+// Grows vertex arrays, new GPU buffers are allocated and filled on the next draw
+void TargetEngine::reserveSlots(int count) {
+  if (count <= _capacity)
+    return;
 
-  if (_targets.contains(tag)) {
-    _targets.remove(tag);
-    _tails.remove(tag);
-    emit targetCountChanged(_targets.size());
+  int old_capacity = _capacity;
+  _capacity = std::max(64, std::max(count, 2*_capacity));
 
-    if (tag == _selected) {
-      emit selectedTargetUpdated(tag, RLITarget());
-      _selected = "";
-    }
+  _coords.resize(4*2*_capacity, 0.f);
+  _heading.resize(4*_capacity, 0.f);
+  _rotation.resize(4*_capacity, 0.f);
+  _course.resize(4*_capacity, 0.f);
+  _speed.resize(4*_capacity, 0.f);
+  _slot_dirty.resize(_capacity, 0);
+
+  // Tail rows get wider
+  std::vector<GLfloat> tails(6*TAIL_POINTS*_capacity, -1.f);
+  for (int row = 0; row < TAIL_POINTS && old_capacity > 0; row++)
+    std::copy( _tails.begin() + 6*row*old_capacity, _tails.begin() + 6*(row+1)*old_capacity
+             , tails.begin() + 6*row*_capacity );
+  _tails.swap(tails);
+
+  _all_dirty = true;
+}
+
+void TargetEngine::writeSlot(int slot) {
+  const RLITarget& trgt = _slot_trgts[slot];
+
+  for (int i = 4*slot; i < 4*slot + 4; i++) {
+    _coords[2*i]   = trgt.latitude;
+    _coords[2*i+1] = trgt.longtitude;
+    _heading[i]    = trgt.heading;
+    _rotation[i]   = trgt.rotation;
+    _course[i]     = trgt.course_grnd;
+    _speed[i]      = trgt.speed_grnd;
   }
 
-  _trgtsMutex.unlock();
+  double x, y;
+  toLocal(GeoPos(trgt.latitude, trgt.longtitude), x, y);
+  _index.update(slot, x, y);
+
+  markDirty(slot);
 }
 
+void TargetEngine::markDirty(int slot) {
+  if (_all_dirty || _slot_dirty[slot])
+    return;
+
+  _slot_dirty[slot] = 1;
+  _dirty_slots.push_back(slot);
+}
+
+// Moves the tail of slot from into slot to, slot from is left without a tail
+void TargetEngine::moveTail(int from, int to) {
+  for (int row = 0; row < TAIL_POINTS; row++) {
+    GLfloat* src = &_tails[6*(row*_capacity + from)];
+
+    if (from != to) {
+      std::copy(src, src + 6, &_tails[6*(row*_capacity + to)]);
+      markTailDirty(row, to);
+    }
+
+    src[2] = src[5] = -1.f;
+    markTailDirty(row, from);
+  }
+}
+
+void TargetEngine::markTailDirty(int row, int slot) {
+  _tail_dirty_first[row] = std::min(_tail_dirty_first[row], slot);
+  _tail_dirty_last[row] = std::max(_tail_dirty_last[row], slot);
+}
 
 void TargetEngine::initShader() {
   _prog->addShaderFromSourceFile(QOpenGLShader::Vertex, SHADERS_PATH + "trgt.vert.glsl");
@@ -144,18 +335,21 @@ void TargetEngine::initShader() {
   _attr_locs[AIS_TRGT_ATTR_ROTATION] = _prog->attributeLocation("rotation");
   _attr_locs[AIS_TRGT_ATTR_COURSE] = _prog->attributeLocation("course");
   _attr_locs[AIS_TRGT_ATTR_SPEED] = _prog->attributeLocation("speed");
+  _time_attr_loc = _prog->attributeLocation("sample_time");
 
   _unif_locs[AIS_TRGT_UNIF_MVP] = _prog->uniformLocation("mvp_matrix");
   _unif_locs[AIS_TRGT_UNIF_CENTER] = _prog->uniformLocation("center");
   _unif_locs[AIS_TRGT_UNIF_SCALE] = _prog->uniformLocation("scale");
   _unif_locs[AIS_TRGT_UNIF_TYPE] = _prog->uniformLocation("type");
+  _unif_locs[AIS_TRGT_UNIF_NOW] = _prog->uniformLocation("now");
+  _unif_locs[AIS_TRGT_UNIF_DURATION] = _prog->uniformLocation("tail_duration");
 
   _prog->release();
 }
 
 
 void TargetEngine::draw(const QMatrix4x4& mvp_matrix, const RLIState& state) {
-  _trgtsMutex.lock();
+  int count = _slot_tags.size();
 
   _prog->bind();
 
@@ -164,7 +358,7 @@ void TargetEngine::draw(const QMatrix4x4& mvp_matrix, const RLIState& state) {
   glUniform2f(_unif_locs[AIS_TRGT_UNIF_CENTER], coords.lat, coords.lon);
   _prog->setUniformValue(_unif_locs[AIS_TRGT_UNIF_MVP], mvp_matrix);
 
-  initBuffersTrgts("");
+  uploadSlots();
   bindBuffers();
 
   glUniform1f(_unif_locs[AIS_TRGT_UNIF_TYPE], 0);
@@ -175,7 +369,7 @@ void TargetEngine::draw(const QMatrix4x4& mvp_matrix, const RLIState& state) {
   glBindTexture(GL_TEXTURE_2D, _asset_tex->textureId());
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
-  glDrawElements(GL_TRIANGLES, 6*_targets.size(), GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(0));
+  glDrawElements(GL_TRIANGLES, 6*count, GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(0));
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
   glBindTexture(GL_TEXTURE_2D, 0);
@@ -184,10 +378,10 @@ void TargetEngine::draw(const QMatrix4x4& mvp_matrix, const RLIState& state) {
 
   // Draw target headings
   glUniform1f(_unif_locs[AIS_TRGT_UNIF_TYPE], 1);
-  glDrawArrays(GL_LINES, 0,  _targets.size()*4);
+  glDrawArrays(GL_LINES, 0, count*4);
 
   glUniform1f(_unif_locs[AIS_TRGT_UNIF_TYPE], 2);
-  glDrawArrays(GL_LINES, 0, _targets.size()*4);
+  glDrawArrays(GL_LINES, 0, count*4);
 
 
 #if !(defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0))
@@ -195,30 +389,49 @@ void TargetEngine::draw(const QMatrix4x4& mvp_matrix, const RLIState& state) {
 #endif
 
 
-  // Draw tails++
-  if (_tailsTime) {
-    int pCount = initBuffersTails();
-    bindBuffers();
+  // Draw tails, all rings in one call, empty segments are dropped by the shader
+  if (_tailsTime > 0 && _capacity > 0) {
+    uploadTails();
+
+    glBindBuffer(GL_ARRAY_BUFFER, _tail_vbo_id);
+    glVertexAttribPointer(_attr_locs[AIS_TRGT_ATTR_COORDS], 2, GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), reinterpret_cast<const GLvoid*>(0));
+    glEnableVertexAttribArray(_attr_locs[AIS_TRGT_ATTR_COORDS]);
+    glVertexAttribPointer(_time_attr_loc, 1, GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), reinterpret_cast<const GLvoid*>(2*sizeof(GLfloat)));
+    glEnableVertexAttribArray(_time_attr_loc);
+
+    for (int attr = AIS_TRGT_ATTR_ORDER; attr < AIS_TRGT_ATTR_COUNT; attr++) {
+      glDisableVertexAttribArray(_attr_locs[attr]);
+      glVertexAttrib1f(_attr_locs[attr], 0);
+    }
+
+    glUniform1f(_unif_locs[AIS_TRGT_UNIF_NOW], _tails_clock.elapsed() / 1000.f);
+    glUniform1f(_unif_locs[AIS_TRGT_UNIF_DURATION], _tailsTime * 60.f);
     glUniform1f(_unif_locs[AIS_TRGT_UNIF_TYPE], 3);
-    glDrawArrays(GL_POINTS, 0, pCount);
-  }
+    glDrawArrays(GL_LINES, 0, 2*TAIL_POINTS*_capacity);
 
+    glDisableVertexAttribArray(_time_attr_loc);
+  }
 
-  if (_selected != "" && _targets.contains(_selected)) {
-    initBuffersTrgts(_selected);
+  // Selection mark is drawn from the slot vertices, but not rotated
+  int selected = _slot_index.value(_selected, -1);
+  if (selected >= 0) {
     bindBuffers();
+    glDisableVertexAttribArray(_attr_locs[AIS_TRGT_ATTR_HEADING]);
+    glDisableVertexAttribArray(_attr_locs[AIS_TRGT_ATTR_COURSE]);
+    glVertexAttrib1f(_attr_locs[AIS_TRGT_ATTR_HEADING], 0);
+    glVertexAttrib1f(_attr_locs[AIS_TRGT_ATTR_COURSE], 0);
 
     glUniform1f(_unif_locs[AIS_TRGT_UNIF_TYPE], 0);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, _selection_tex->textureId());
-    glDrawArrays(GL_TRIANGLE_FAN, 0,  4);
+    glDrawArrays(GL_TRIANGLE_FAN, 4*selected, 4);
     glBindTexture(GL_TEXTURE_2D, 0);
   }
 
-  _prog->release();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-  _trgtsMutex.unlock();
+  _prog->release();
 }
 
 
@@ -249,103 +462,96 @@ void TargetEngine::bindBuffers() {
 }
 
 
-int TargetEngine::initBuffersTails() {
-  std::vector<GLfloat> point;
+// Sends changed slots to the GPU. Dirty slots are merged into runs,
+// so a batch of updates from one source costs a few glBufferSubData calls
+void TargetEngine::uploadSlots() {
+  const int ATTRS[] = { AIS_TRGT_ATTR_COORDS, AIS_TRGT_ATTR_HEADING, AIS_TRGT_ATTR_ROTATION, AIS_TRGT_ATTR_COURSE, AIS_TRGT_ATTR_SPEED };
+  const GLfloat* data[] = { _coords.data(), _heading.data(), _rotation.data(), _course.data(), _speed.data() };
+  const int sizes[] = { 2, 1, 1, 1, 1 };
 
-  QList<QString> keys = _tails.keys();
-
-  for (int trgt = 0; trgt < keys.size(); trgt++) {
-    for (int i = 0; i < _tails[keys[trgt]].size(); i++) {
-      point.push_back(_tails[keys[trgt]][i].x());
-      point.push_back(_tails[keys[trgt]][i].y());
-    }
-  }
+  if (_all_dirty) {
+    std::vector<GLfloat> order(4*_capacity);
+    std::vector<GLuint> draw_indices(6*_capacity);
 
-  int point_count = point.size()/2;
+    for (int i = 0; i < _capacity; i++) {
+      for (int j = 0; j < 4; j++)
+        order[4*i + j] = j;
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_COORDS]);
-  glBufferData(GL_ARRAY_BUFFER, point_count*2*sizeof(GLfloat), point.data(), GL_DYNAMIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_ORDER]);
-  glBufferData(GL_ARRAY_BUFFER, point_count*sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+      draw_indices[6*i + 0] = 4*i;
+      draw_indices[6*i + 1] = 4*i+1;
+      draw_indices[6*i + 2] = 4*i+2;
+      draw_indices[6*i + 3] = 4*i;
+      draw_indices[6*i + 4] = 4*i+2;
+      draw_indices[6*i + 5] = 4*i+3;
+    }
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_HEADING]);
-  glBufferData(GL_ARRAY_BUFFER, point_count*sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_ORDER]);
+    glBufferData(GL_ARRAY_BUFFER, order.size()*sizeof(GLfloat), order.data(), GL_STATIC_DRAW);
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_ROTATION]);
-  glBufferData(GL_ARRAY_BUFFER, point_count*sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+    for (int a = 0; a < 5; a++) {
+      glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[ATTRS[a]]);
+      glBufferData(GL_ARRAY_BUFFER, 4*sizes[a]*_capacity*sizeof(GLfloat), data[a], GL_DYNAMIC_DRAW);
+    }
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_COURSE]);
-  glBufferData(GL_ARRAY_BUFFER, point_count*sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, draw_indices.size()*sizeof(GLuint), draw_indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    _all_dirty = false;
+  } else if (!_dirty_slots.empty()) {
+    std::sort(_dirty_slots.begin(), _dirty_slots.end());
+
+    size_t i = 0;
+    while (i < _dirty_slots.size()) {
+      size_t j = i + 1;
+      while (j < _dirty_slots.size() && _dirty_slots[j] == _dirty_slots[j-1] + 1)
+        j++;
+
+      int first = _dirty_slots[i];
+      int count = _dirty_slots[j-1] - first + 1;
+
+      for (int a = 0; a < 5; a++) {
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[ATTRS[a]]);
+        glBufferSubData( GL_ARRAY_BUFFER
+                       , 4*sizes[a]*first*sizeof(GLfloat)
+                       , 4*sizes[a]*count*sizeof(GLfloat)
+                       , data[a] + 4*sizes[a]*first );
+      }
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_SPEED]);
-  glBufferData(GL_ARRAY_BUFFER, point_count*sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+      i = j;
+    }
+  }
 
-  return point_count;
+  for (int slot : _dirty_slots)
+    _slot_dirty[slot] = 0;
+  _dirty_slots.clear();
 }
 
+// Sends the changed slot range of every ring row, the whole buffer after it grows
+void TargetEngine::uploadTails() {
+  glBindBuffer(GL_ARRAY_BUFFER, _tail_vbo_id);
 
-void TargetEngine::initBuffersTrgts(QString tag) {
-  std::vector<GLfloat> point, order, heading, rotation, course, speed;
-  std::vector<GLuint> draw_indices;
-
-  QList<QString> keys = _targets.keys();
-
-  if (tag == "") {
-    for (int trgt = 0; trgt < keys.size(); trgt++) {
-      for (int i = 0; i < 4; i++) {
-        order.push_back(i);
-        point.push_back(_targets[keys[trgt]].latitude);
-        point.push_back(_targets[keys[trgt]].longtitude);
-        heading.push_back(_targets[keys[trgt]].heading);
-        rotation.push_back(_targets[keys[trgt]].rotation);
-        course.push_back(_targets[keys[trgt]].course_grnd);
-        speed.push_back(_targets[keys[trgt]].speed_grnd);
-      }
-    }
+  if (_tail_vbo_capacity != _capacity) {
+    glBufferData(GL_ARRAY_BUFFER, _tails.size()*sizeof(GLfloat), _tails.data(), GL_DYNAMIC_DRAW);
+    _tail_vbo_capacity = _capacity;
   } else {
-    for (int i = 0; i < 4; i++) {
-      order.push_back(i);
-      point.push_back(_targets[tag].latitude);
-      point.push_back(_targets[tag].longtitude);
-      heading.push_back(0);
-      rotation.push_back(0);
-      course.push_back(0);
-      speed.push_back(0);
+    for (int row = 0; row < TAIL_POINTS; row++) {
+      int first = _tail_dirty_first[row];
+      if (first > _tail_dirty_last[row])
+        continue;
+
+      int offset = 6*(row*_capacity + first);
+      glBufferSubData( GL_ARRAY_BUFFER
+                     , offset*sizeof(GLfloat)
+                     , 6*(_tail_dirty_last[row] - first + 1)*sizeof(GLfloat)
+                     , _tails.data() + offset );
     }
   }
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_COORDS]);
-  glBufferData(GL_ARRAY_BUFFER, point.size()*sizeof(GLfloat), point.data(), GL_DYNAMIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_ORDER]);
-  glBufferData(GL_ARRAY_BUFFER, order.size()*sizeof(GLfloat), order.data(), GL_DYNAMIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_HEADING]);
-  glBufferData(GL_ARRAY_BUFFER, heading.size()*sizeof(GLfloat), heading.data(), GL_DYNAMIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_ROTATION]);
-  glBufferData(GL_ARRAY_BUFFER, rotation.size()*sizeof(GLfloat), rotation.data(), GL_DYNAMIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_COURSE]);
-  glBufferData(GL_ARRAY_BUFFER, course.size()*sizeof(GLfloat), course.data(), GL_DYNAMIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo_ids[AIS_TRGT_ATTR_SPEED]);
-  glBufferData(GL_ARRAY_BUFFER, speed.size()*sizeof(GLfloat), speed.data(), GL_DYNAMIC_DRAW);
-
-
-  for (int i = 0; i < _targets.size(); i++) {
-    draw_indices.push_back(4*i);
-    draw_indices.push_back(4*i+1);
-    draw_indices.push_back(4*i+2);
-    draw_indices.push_back(4*i);
-    draw_indices.push_back(4*i+2);
-    draw_indices.push_back(4*i+3);
+  for (int row = 0; row < TAIL_POINTS; row++) {
+    _tail_dirty_first[row] = INT_MAX;
+    _tail_dirty_last[row] = -1;
   }
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ind_vbo_id);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6*_targets.size()*sizeof(GLuint), draw_indices.data(), GL_DYNAMIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 QOpenGLTexture* TargetEngine::initTexture(QString path) {
@@ -3,14 +3,18 @@
 
 #include "../common/rlistate.h"
 #include "../common/rlimath.h"
+#include "../common/targetindex.h"
 
-#include "../datasources/targetdatasource.h"
+#include "../datasources/targetfeed.h"
+
+#include <vector>
 
 #include <QPoint>
-#include <QMutex>
 #include <QList>
+#include <QHash>
 #include <QTimer>
 #include <QVector2D>
+#include <QElapsedTimer>
 
 #include <QOpenGLTexture>
 #include <QOpenGLFunctions>
@@ -18,6 +22,13 @@
 #include <QOpenGLShaderProgram>
 
 
+// Target table keeps targets in packed slots [0, count), deletion moves the last
+// target into the freed slot. Vertex data of every slot lives in GPU buffers
+// all the time, only slots changed since the last frame are sent with glBufferSubData.
+// Targets come from TargetFeeds, update() takes one batch of each feed per frame,
+// a slot key is the feed number and the target id within the feed.
+// Tails are rings of TAIL_POINTS segments per slot in one buffer, a tail timer tick
+// writes one ring row for all slots, old segments fade out in the shader.
 class TargetEngine : public QObject, protected QOpenGLFunctions {
   Q_OBJECT
 
@@ -25,44 +36,86 @@ public:
   explicit TargetEngine(QOpenGLContext* context, QObject* parent = nullptr);
   virtual ~TargetEngine();
 
+  void addFeed(TargetFeed* feed);
+  // Applies changes published by the feeds since the last call
+  void update();
+  // Feed batches or a tail tick not drawn yet
+  bool hasUpdates() const;
+
   void draw(const QMatrix4x4& mvp_matrix, const RLIState& state);
 
-  inline int targetCount() const { return _targets.size(); }
-  inline const QString& selectedTag() const { return _selected; }
-  inline RLITarget selectedTrgt() const { return _targets.value(_selected); }
+  inline int targetCount() const { return _slot_tags.size(); }
+  inline QString selectedTag() const { return _slot_index.contains(_selected) ? _slot_tags[_slot_index[_selected]] : QString(); }
+  // Targets inside the sector around center, radii in metres, true bearings in degrees
+  int countInSector(const GeoPos& center, double min_radius, double max_radius, double min_angle, double max_angle);
+
+  inline RLITarget selectedTrgt() const { return _slot_index.contains(_selected) ? _slot_trgts[_slot_index[_selected]] : RLITarget(); }
 
 signals:
   void targetCountChanged(int count);
   void selectedTargetUpdated(const QString& tag, const RLITarget& trgt);
 
-protected slots:
-  void timerEvent(QTimerEvent* e);
+private slots:
+  void onTailsTimer();
 
 public slots:
   void onTailsModeChanged(int mode, int minutes);
 
   void select(const GeoPos& coords, double scale);
 
-  void deleteTarget(QString tag);
-  void updateTarget(QString tag, RLITarget target);
-
 private:
   void bindBuffers();
-  void initBuffersTrgts(QString tag);
-  int initBuffersTails();
+  bool setTarget(qint64 key, const QString& tag, const RLITarget& target);
+  bool removeTarget(qint64 key);
+  void reserveSlots(int count);
+  void writeSlot(int slot);
+  void markDirty(int slot);
+  void moveTail(int from, int to);
+  void markTailDirty(int row, int slot);
+
+  void toLocal(const GeoPos& pos, double& x, double& y) const;
+  void uploadSlots();
+  void uploadTails();
 
   void initShader();
   QOpenGLTexture* initTexture(QString path);
 
-  QMutex _trgtsMutex;
-  QString _selected;
-  QMap<QString, RLITarget> _targets;
+  QVector<TargetFeed*> _feeds;
+  qint64 _selected;
+
+  QHash<qint64, int> _slot_index;
+  QVector<qint64> _slot_keys;
+  QVector<QString> _slot_tags;
+  QVector<RLITarget> _slot_trgts;
+
+  // Slot positions in metres around the first target
+  bool _has_origin;
+  GeoPos _origin { 0.0, 0.0 };
+  TargetIndex _index;
+  std::vector<int> _found;
+
+  // Vertex data of slots, 4 vertices per target
+  int _capacity;
+  std::vector<GLfloat> _coords, _heading, _rotation, _course, _speed;
+  // Slots to send before the next draw, all of them after the buffers grow
+  std::vector<int> _dirty_slots;
+  std::vector<char> _slot_dirty;
+  bool _all_dirty;
 
   QTimer _tailsTimer;
-  QMap<QString, QList<QVector2D> > _tails;
   int _tailsTime; // Maximum tails time in minutes
-
-  enum {TRG_TAIL_NUM = 4};
+  QElapsedTimer _tails_clock;
+
+  // Ring row r, slot s is a GL_LINES segment from the previous sample to the sample
+  // at row r: 2 vertices of (lat, lon, time), time is in seconds of _tails_clock, -1 for none.
+  // Rows are _capacity slots wide, so a tick sends one contiguous row
+  enum { TAIL_POINTS = 32 };
+  int _tail_head;
+  int _tail_vbo_capacity;
+  std::vector<GLfloat> _tails;
+  // Dirty slots range of every row, first > last if the row is clean
+  int _tail_dirty_first[TAIL_POINTS];
+  int _tail_dirty_last[TAIL_POINTS];
 
   // Mask shader programs
   QOpenGLTexture* _asset_tex;
@@ -81,11 +134,15 @@ private:
        , AIS_TRGT_UNIF_CENTER = 1
        , AIS_TRGT_UNIF_SCALE = 2
        , AIS_TRGT_UNIF_TYPE = 3
-       , AIS_TRGT_UNIF_COUNT = 4 } ;
+       , AIS_TRGT_UNIF_NOW = 4
+       , AIS_TRGT_UNIF_DURATION = 5
+       , AIS_TRGT_UNIF_COUNT = 6 } ;
 
   GLuint _ind_vbo_id;
+  GLuint _tail_vbo_id;
   GLuint _vbo_ids[AIS_TRGT_ATTR_COUNT];
   GLuint _attr_locs[AIS_TRGT_ATTR_COUNT];
+  GLuint _time_attr_loc; // tails only
   GLuint _unif_locs[AIS_TRGT_UNIF_COUNT];
 };
 
@@ -8,6 +8,7 @@
 
 #include "common/rlilayout.h"
 #include "common/properties.h"
+#include "common/startuptrace.h"
 
 #define RLI_THREADS_NUM 6 // Required number of threads in global QThreadPool
 
@@ -15,6 +16,8 @@ void parseArgs(QApplication* a);
 
 
 int main(int argc, char *argv[]) {
+  StartupTrace::start();
+
   if (QThreadPool::globalInstance()->maxThreadCount() < RLI_THREADS_NUM)
     QThreadPool::globalInstance()->setMaxThreadCount(RLI_THREADS_NUM);
   qDebug() << "Max number of threads: " << QThreadPool::globalInstance()->maxThreadCount();
@@ -28,7 +31,9 @@ int main(int argc, char *argv[]) {
   format.setSamples(1);
   QGLFormat::setDefaultFormat(format);
 
+  qint64 window_begin = StartupTrace::now();
   MainWindow w;
+  StartupTrace::record("Main window", window_begin, StartupTrace::now());
   w.showFullScreen();
 
   return a.exec();
@@ -41,10 +46,19 @@ void parseArgs(QApplication* a) {
     qDebug() << "-bp to show debug buttons panel";
     qDebug() << "-p to setup peleng size (default: 800)";
     qDebug() << "-b to setup count of pelengs per circle (default: 4096)";
-    qDebug() << "-f to setup delay between frames in milliseconds (default: 25)";
+    qDebug() << "-f to setup minimal delay between frames in milliseconds, frames are drawn only on changes (default: 25)";
     qDebug() << "-d to setup delay between sending data blocks by radardatasource in milliseconds (default: 15)";
     qDebug() << "-s to setup size of data blocks to send in pelengs (default: 64)";
+    qDebug() << "-cpu to convert radar scan to image on CPU instead of GPU";
+    qDebug() << "-cfar to enable CFAR thresholding of radar video";
+    qDebug() << "-stat to log radar video processing throughput every revolution and frame rate and latency every 5 s";
+    qDebug() << "-history to setup count of radar revolutions kept for freeze frame and replay (default: 16)";
+    qDebug() << "-radar to receive radar video from udp:<port>, udp:<address>:<port> or udp:<multicast group>:<port> (no default, video is simulated)";
+    qDebug() << "-ais to read AIS NMEA from udp:<port>, tcp:<host>:<port>, - (stdin), a pipe or a log file (no default, targets are simulated)";
+    qDebug() << "-record to write radar video, ship state and AIS targets as they come to a file";
+    qDebug() << "-replay to take radar video, ship state and targets from a file written with -record instead of the sources";
     qDebug() << "-w to setup rliwidget size (example: 1024x768, no default, depends on screen size)";
+    qDebug() << "-trace to write the startup trace in Chrome trace format to a file (the summary is always logged)";
     exit(0);
   }
 
@@ -55,7 +69,26 @@ void parseArgs(QApplication* a) {
   a->setProperty(PROPERTY_FRAME_DELAY, args.contains("-f") ? args[args.indexOf("-f") + 1].toInt() : 25);
   a->setProperty(PROPERTY_DATA_DELAY, args.contains("-d") ? args[args.indexOf("-d") + 1].toInt() : 30);
   a->setProperty(PROPERTY_BLOCK_SIZE, args.contains("-s") ? args[args.indexOf("-s") + 1].toInt() : 128);
+  a->setProperty(PROPERTY_RADAR_CPU, args.contains("-cpu"));
+  a->setProperty(PROPERTY_RADAR_CFAR, args.contains("-cfar"));
+  a->setProperty(PROPERTY_RADAR_STAT, args.contains("-stat"));
+  a->setProperty(PROPERTY_RADAR_HISTORY, args.contains("-history") ? args[args.indexOf("-history") + 1].toInt() : 16);
+
+  if (args.contains("-radar"))
+    a->setProperty(PROPERTY_RADAR_SOURCE, args[args.indexOf("-radar") + 1]);
+
+  if (args.contains("-ais"))
+    a->setProperty(PROPERTY_AIS_SOURCE, args[args.indexOf("-ais") + 1]);
+
+  if (args.contains("-record"))
+    a->setProperty(PROPERTY_RECORD, args[args.indexOf("-record") + 1]);
+
+  if (args.contains("-replay"))
+    a->setProperty(PROPERTY_REPLAY, args[args.indexOf("-replay") + 1]);
 
   if (args.contains("-w"))
     a->setProperty(PROPERTY_RLI_WIDGET_SIZE, args[args.indexOf("-w") + 1]);
+
+  if (args.contains("-trace"))
+    a->setProperty(PROPERTY_STARTUP_TRACE, args[args.indexOf("-trace") + 1]);
 }
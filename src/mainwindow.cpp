@@ -24,6 +24,56 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   _ship_ds = new ShipDataSource(this);
   _target_ds = new TargetDataSource(this);
 
+  // Обработка видео в отдельном потоке
+  _radar_proc = new RadarVideoProcessor( qApp->property(PROPERTY_BEARINGS_PER_CYCLE).toInt()
+                                       , qApp->property(PROPERTY_PELENG_SIZE).toInt() );
+  _radar_proc->moveToThread(&_proc_thread);
+  connect(&_proc_thread, SIGNAL(finished()), _radar_proc, SLOT(deleteLater()));
+
+  connect( _radar_ds, SIGNAL(updateRadarData(int, int, GLfloat*))
+         , _radar_proc, SLOT(processData(int, int, GLfloat*))
+         , Qt::QueuedConnection );
+
+  // Выделение отметок в отдельном потоке
+  _plot_extractor = new RadarPlotExtractor( qApp->property(PROPERTY_BEARINGS_PER_CYCLE).toInt()
+                                          , qApp->property(PROPERTY_PELENG_SIZE).toInt() );
+  _plot_extractor->moveToThread(&_plot_thread);
+  connect(&_plot_thread, SIGNAL(finished()), _plot_extractor, SLOT(deleteLater()));
+
+  connect( _radar_proc, SIGNAL(updateRadarData(int, int, GLfloat*))
+         , _plot_extractor, SLOT(updateData(int, int, GLfloat*))
+         , Qt::QueuedConnection );
+
+  _tracker = new RadarTracker(qApp->property(PROPERTY_BEARINGS_PER_CYCLE).toInt());
+  _tracker->moveToThread(&_plot_thread);
+  connect(&_plot_thread, SIGNAL(finished()), _tracker, SLOT(deleteLater()));
+
+  connect( _plot_extractor, SIGNAL(plotsExtracted(QVector<RadarPlot>))
+         , _tracker, SLOT(onPlotsExtracted(QVector<RadarPlot>)) );
+
+  // Запись входных данных: producers only copy, the recorder thread encodes and writes
+  QString record_path = qApp->property(PROPERTY_RECORD).toString();
+  if (!record_path.isEmpty()) {
+    _recorder = new DataRecorder( record_path
+                                , qApp->property(PROPERTY_BEARINGS_PER_CYCLE).toInt()
+                                , qApp->property(PROPERTY_PELENG_SIZE).toInt() );
+
+    connect( _radar_ds, SIGNAL(updateRadarData(int, int, GLfloat*))
+           , _recorder, SLOT(recordRadar(int, int, GLfloat*))
+           , Qt::DirectConnection );
+    connect( _ship_ds, SIGNAL(shipStateChanged(RLIShipState))
+           , _recorder, SLOT(recordShip(RLIShipState))
+           , Qt::DirectConnection );
+
+    DataRecorder* recorder = _recorder;
+    _target_ds->feed()->setPublishHook([recorder](const TargetBatch& batch) { recorder->recordTargets(batch); });
+
+    _recorder->start();
+  }
+
+  _proc_thread.start();
+  _plot_thread.start();
+
   _radar_ds->start();
   _ship_ds->start();
   _target_ds->start();
@@ -39,6 +89,18 @@ MainWindow::~MainWindow() {
   _ship_ds->finish();
   _target_ds->finish();
 
+  // Everything queued before the sources stopped is written
+  if (_recorder != nullptr) {
+    _recorder->stop();
+    _recorder->wait();
+    delete _recorder;
+  }
+
+  _proc_thread.quit();
+  _proc_thread.wait();
+  _plot_thread.quit();
+  _plot_thread.wait();
+
   delete _radar_ds;
   delete _ship_ds;
   delete _target_ds;
@@ -69,16 +131,9 @@ void MainWindow::resizeEvent(QResizeEvent* e) {
   qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "MainWindow resizeEvent finish";
 }
 
-void MainWindow::timerEvent(QTimerEvent* e) {
-  Q_UNUSED(e);
-  wgtRLI->update();
-}
-
 void MainWindow::onRLIWidgetInitialized() {
-  wgtRLI->setupRadarDataSource(_radar_ds);
+  wgtRLI->setupRadarProcessor(_radar_proc);
+  wgtRLI->setupTracker(_tracker);
   wgtRLI->setupTargetDataSource(_target_ds);
   wgtRLI->setupShipDataSource(_ship_ds);
-
-  int frame = qApp->property(PROPERTY_FRAME_DELAY).toInt();
-  startTimer(frame, Qt::CoarseTimer);
 }
@@ -3,6 +3,7 @@
 
 #include <QMainWindow>
 #include <QSet>
+#include <QThread>
 
 #include "rlicontrolwidget.h"
 #include "rlidisplaywidget.h"
@@ -10,9 +11,15 @@
 #include "datasources/radardatasource.h"
 #include "datasources/shipdatasource.h"
 #include "datasources/targetdatasource.h"
+#include "datasources/datarecorder.h"
+
+#include "processing/radarvideoprocessor.h"
+#include "processing/radarplotextractor.h"
+#include "processing/radartracker.h"
 
 Q_DECLARE_METATYPE(RLITarget)
 Q_DECLARE_METATYPE(RLIShipState)
+Q_DECLARE_METATYPE(RadarPlot)
 
 class MainWindow : public QMainWindow
 {
@@ -24,7 +31,6 @@ public:
 
 protected slots:
   void resizeEvent(QResizeEvent* e);
-  void timerEvent(QTimerEvent* e);
 
   void onRLIWidgetInitialized();
 
@@ -33,6 +39,17 @@ private:
   ShipDataSource*     _ship_ds;
   TargetDataSource*   _target_ds;
 
+  // Запись входных данных (-record)
+  DataRecorder*       _recorder = nullptr;
+
+  RadarVideoProcessor* _radar_proc;
+  QThread             _proc_thread;
+
+  // Extractor and tracker share one thread
+  RadarPlotExtractor* _plot_extractor;
+  RadarTracker*       _tracker;
+  QThread             _plot_thread;
+
   RLIDisplayWidget*   wgtRLI;
   RLIControlWidget*   wgtButtonPanel;
 };
@@ -0,0 +1,234 @@
+#include "radarplotextractor.h"
+#include "../common/properties.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QDateTime>
+#include <QCoreApplication>
+
+// Амплитуда, выше которой отсчёт относится к отметке
+static const float PLOT_THREASHOLD    = 64.f;
+// Limits of a point target
+static const int   PLOT_MIN_SIZE      = 4;
+static const int   PLOT_MAX_PELENGS   = 128;
+static const int   PLOT_MAX_SAMPLES   = 48;
+
+
+RadarPlotExtractor::RadarPlotExtractor(int pel_count, int pel_len, QObject* parent) : QObject(parent) {
+  _peleng_count = pel_count;
+  _peleng_len = pel_len;
+
+  _prev_runs.reserve(pel_len / 2 + 1);
+  _cur_runs.reserve(pel_len / 2 + 1);
+  _comps.reserve(1024);
+
+  _stat = qApp->property(PROPERTY_RADAR_STAT).toBool();
+}
+
+RadarPlotExtractor::~RadarPlotExtractor() {
+}
+
+
+void RadarPlotExtractor::updateData(int offset, int count, GLfloat* amps) {
+  if (_stat)
+    _stat_timer.start();
+
+  for (int i = 0; i < count; i++) {
+    int peleng = (offset + i) % _peleng_count;
+
+    // Pelengs are expected in order, after a gap all components are closed
+    if (_last_peleng >= 0 && peleng != (_last_peleng + 1) % _peleng_count) {
+      for (const Run& run : _prev_runs)
+        closeComponent(findRoot(run.comp));
+      _prev_runs.clear();
+    }
+
+    _last_peleng = peleng;
+    _peleng_seq++;
+
+    processPeleng(amps + static_cast<size_t>(i) * _peleng_len);
+  }
+
+  if (_stat)
+    collectStat(count, _stat_timer.nsecsElapsed());
+
+  if (!_plots.isEmpty()) {
+    emit plotsExtracted(_plots);
+    _plots.clear();
+  }
+}
+
+void RadarPlotExtractor::processPeleng(const GLfloat* amps) {
+  _cur_runs.clear();
+
+  // Runs of samples above threashold
+  for (int r = 0; r < _peleng_len; r++) {
+    if (amps[r] < PLOT_THREASHOLD)
+      continue;
+
+    int first = r;
+    while (r + 1 < _peleng_len && amps[r + 1] >= PLOT_THREASHOLD)
+      r++;
+
+    _cur_runs.push_back(Run { first, r, -1 });
+  }
+
+  // Join with overlapping runs of the previous peleng, both lists are sorted by range
+  size_t p = 0;
+  for (Run& run : _cur_runs) {
+    while (p < _prev_runs.size() && _prev_runs[p].last < run.first)
+      p++;
+
+    for (size_t q = p; q < _prev_runs.size() && _prev_runs[q].first <= run.last; q++) {
+      int root = findRoot(_prev_runs[q].comp);
+      run.comp = (run.comp < 0) ? root : unite(run.comp, root);
+    }
+
+    if (run.comp < 0)
+      run.comp = newComponent();
+
+    Component& c = _comps[run.comp];
+    for (int r = run.first; r <= run.last; r++) {
+      c.sum_amp         += amps[r];
+      c.sum_amp_peleng  += amps[r] * static_cast<double>(_peleng_seq);
+      c.sum_amp_radius  += amps[r] * r;
+      c.max_amp          = std::max(c.max_amp, amps[r]);
+    }
+
+    c.size += run.last - run.first + 1;
+    c.min_radius = std::min(c.min_radius, run.first);
+    c.max_radius = std::max(c.max_radius, run.last);
+    c.first_peleng = std::min(c.first_peleng, _peleng_seq);
+    c.last_peleng = _peleng_seq;
+  }
+
+  for (Run& run : _cur_runs)
+    run.comp = findRoot(run.comp);
+
+  // Components of the previous peleng which were not continued are complete
+  for (const Run& run : _prev_runs) {
+    int root = findRoot(run.comp);
+    if (_comps[root].last_peleng < _peleng_seq && _comps[root].parent != -2)
+      closeComponent(root);
+  }
+
+  for (int comp : _merged_comps)
+    _free_comps.push_back(comp);
+  _merged_comps.clear();
+
+  std::swap(_prev_runs, _cur_runs);
+}
+
+
+int RadarPlotExtractor::newComponent() {
+  int comp;
+
+  if (_free_comps.empty()) {
+    comp = static_cast<int>(_comps.size());
+    _comps.push_back(Component());
+  } else {
+    comp = _free_comps.back();
+    _free_comps.pop_back();
+  }
+
+  Component& c = _comps[comp];
+  c.sum_amp = c.sum_amp_peleng = c.sum_amp_radius = 0.0;
+  c.max_amp = 0.f;
+  c.size = 0;
+  c.min_radius = _peleng_len;
+  c.max_radius = -1;
+  c.first_peleng = _peleng_seq;
+  c.last_peleng = _peleng_seq;
+  c.parent = comp;
+
+  return comp;
+}
+
+int RadarPlotExtractor::findRoot(int comp) {
+  while (_comps[comp].parent >= 0 && _comps[comp].parent != comp) {
+    int parent = _comps[comp].parent;
+    if (_comps[parent].parent >= 0)
+      _comps[comp].parent = _comps[parent].parent;
+    comp = parent;
+  }
+
+  return comp;
+}
+
+int RadarPlotExtractor::unite(int a, int b) {
+  if (a == b)
+    return a;
+
+  // The bigger component stays the root
+  if (_comps[a].size < _comps[b].size)
+    std::swap(a, b);
+
+  Component& ca = _comps[a];
+  const Component& cb = _comps[b];
+
+  ca.sum_amp         += cb.sum_amp;
+  ca.sum_amp_peleng  += cb.sum_amp_peleng;
+  ca.sum_amp_radius  += cb.sum_amp_radius;
+  ca.max_amp          = std::max(ca.max_amp, cb.max_amp);
+  ca.size            += cb.size;
+  ca.min_radius       = std::min(ca.min_radius, cb.min_radius);
+  ca.max_radius       = std::max(ca.max_radius, cb.max_radius);
+  ca.first_peleng     = std::min(ca.first_peleng, cb.first_peleng);
+  ca.last_peleng      = std::max(ca.last_peleng, cb.last_peleng);
+
+  _comps[b].parent = a;
+  _merged_comps.push_back(b);
+
+  return a;
+}
+
+// Parent -2 marks a closed component until it is reused
+void RadarPlotExtractor::closeComponent(int comp) {
+  Component& c = _comps[comp];
+  if (c.parent == -2)
+    return;
+
+  c.parent = -2;
+  _free_comps.push_back(comp);
+
+  if ( c.size < PLOT_MIN_SIZE
+    || c.last_peleng - c.first_peleng + 1 > PLOT_MAX_PELENGS
+    || c.max_radius - c.min_radius + 1 > PLOT_MAX_SAMPLES
+    || c.sum_amp <= 0.0 )
+    return;
+
+  RadarPlot plot;
+
+  double peleng = c.sum_amp_peleng / c.sum_amp;
+  peleng -= static_cast<double>(static_cast<int64_t>(peleng / _peleng_count)) * _peleng_count;
+
+  plot.peleng     = static_cast<float>(peleng);
+  plot.radius     = static_cast<float>(c.sum_amp_radius / c.sum_amp);
+  plot.amplitude  = c.max_amp;
+  plot.size       = c.size;
+  plot.time       = QDateTime::currentMSecsSinceEpoch();
+
+  _plots.push_back(plot);
+}
+
+
+void RadarPlotExtractor::collectStat(int count, qint64 nsecs) {
+  _stat_nsecs += nsecs;
+  _stat_max_nsecs = std::max(_stat_max_nsecs, nsecs);
+  _stat_pelengs += count;
+  _stat_plots += _plots.size();
+
+  if (_stat_pelengs < _peleng_count)
+    return;
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+           << "Plot extraction:" << _stat_plots << "plots in" << _stat_pelengs << "pelengs,"
+           << _stat_nsecs / 1e6 << "ms total," << _stat_max_nsecs / 1e3 << "us max per block,"
+           << _comps.size() << "components allocated";
+
+  _stat_nsecs = 0;
+  _stat_max_nsecs = 0;
+  _stat_pelengs = 0;
+  _stat_plots = 0;
+}
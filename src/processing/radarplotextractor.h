@@ -0,0 +1,90 @@
+#ifndef RADARPLOTEXTRACTOR_H
+#define RADARPLOTEXTRACTOR_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QOpenGLFunctions>
+
+// Отметка цели, выделенная из радарного видео
+struct RadarPlot {
+  float   peleng    { 0.f };  // Bearing of the centroid in pelengs
+  float   radius    { 0.f };  // Range of the centroid in samples
+  float   amplitude { 0.f };  // Max amplitude
+  int     size      { 0 };    // Samples above threashold
+  qint64  time      { 0 };    // Msecs since epoch when the plot was closed
+};
+
+// Выделение отметок целей.
+// Pelengs are thresholded into runs of samples, runs overlapping runs of the previous
+// peleng are joined into connected components (union-find), so the data is streamed
+// peleng by peleng. A component is closed as soon as a peleng does not continue it
+// and its amplitude weighted centroid is published, latency is one data block.
+// Components wider than the limits (coast, clutter) are dropped.
+class RadarPlotExtractor : public QObject {
+  Q_OBJECT
+public:
+  explicit RadarPlotExtractor(int pel_count, int pel_len, QObject* parent = nullptr);
+  virtual ~RadarPlotExtractor();
+
+signals:
+  void plotsExtracted(const QVector<RadarPlot>& plots);
+
+public slots:
+  void updateData(int offset, int count, GLfloat* amps);
+
+private:
+  struct Run {
+    int first;
+    int last;
+    int comp;
+  };
+
+  struct Component {
+    double  sum_amp;
+    double  sum_amp_peleng;
+    double  sum_amp_radius;
+    float   max_amp;
+    int     size;
+    int     min_radius, max_radius;
+    int64_t first_peleng, last_peleng;
+    int     parent;
+  };
+
+  void processPeleng(const GLfloat* amps);
+
+  int newComponent();
+  int findRoot(int comp);
+  int unite(int a, int b);
+  void closeComponent(int comp);
+
+  void collectStat(int count, qint64 nsecs);
+
+  int _peleng_count;
+  int _peleng_len;
+
+  // Unwrapped peleng counter, components crossing north keep continuous bearings
+  int64_t _peleng_seq = -1;
+  int _last_peleng = -1;
+
+  std::vector<Run> _prev_runs;
+  std::vector<Run> _cur_runs;
+
+  std::vector<Component> _comps;
+  std::vector<int> _free_comps;
+  std::vector<int> _merged_comps;
+
+  QVector<RadarPlot> _plots;
+
+  bool _stat;
+  QElapsedTimer _stat_timer;
+  qint64 _stat_max_nsecs = 0;
+  qint64 _stat_nsecs = 0;
+  int _stat_pelengs = 0;
+  int _stat_plots = 0;
+};
+
+#endif // RADARPLOTEXTRACTOR_H
@@ -0,0 +1,400 @@
+#include "radartracker.h"
+#include "../common/properties.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <QDebug>
+#include <QDateTime>
+#include <QCoreApplication>
+
+static const double KNOT2MPS          = RLIMath::MILE2METER / 3600.0;
+
+// Measurement and acceleration noise
+static const double MEASURE_SIGMA_SAMPLES = 2.0;
+static const double ACCEL_SIGMA       = 0.5;      // m/s^2
+// Initial uncertainty of a manually acquired track
+static const double ACQUIRE_SIGMA     = 300.0;    // m
+static const double ACQUIRE_SPEED_SIGMA = 15.0;   // m/s
+
+// Chi-square 99% for 2 degrees of freedom
+static const double GATE_CHI2         = 9.21;
+// A batch covers one sector, so plots are gated only with tracks indexed within
+// TRACK_SEARCH of them: the gate is cut to MAX_GATE and a track moves
+// at MAX_TRACK_KNOTS at most while it is not predicted (no longer than LOST_MSECS)
+static const double MAX_GATE          = 1500.0;   // m
+static const double MAX_TRACK_KNOTS   = 60.0;
+
+// Tracks of automatic initiation are confirmed after CONFIRM_HITS plots,
+// until then a track is dropped when it misses MISS_SCANS scans
+static const int    CONFIRM_HITS      = 3;
+static const double MISS_SCANS        = 1.5;
+static const qint64 LOST_MSECS        = 15000;
+// Scan period until it is measured, 24 rpm
+static const qint64 DEFAULT_SCAN_MSECS = 2500;
+
+static const double TRACK_SEARCH      = MAX_GATE + MAX_TRACK_KNOTS * KNOT2MPS * LOST_MSECS / 1000.0;
+
+// Danger limits
+static const double CPA_LIMIT_MILES   = 1.0;
+static const double TCPA_LIMIT_MINS   = 12.0;
+// Targets further than this can't come within the CPA limit in TCPA limit time
+static const double MAX_CLOSING_KNOTS = 60.0;
+static const double DANGER_RANGE      = (CPA_LIMIT_MILES + MAX_CLOSING_KNOTS * TCPA_LIMIT_MINS / 60.0) * RLIMath::MILE2METER;
+
+// Index cells
+static const double TRACK_CELL        = 2000.0;   // m
+static const double PLOT_CELL         = 500.0;    // m
+
+
+RadarTracker::RadarTracker(int pel_count, QObject* parent) : QObject(parent), _track_index(TRACK_CELL), _plot_index(PLOT_CELL) {
+  _peleng_count = pel_count;
+  _scan_msecs = DEFAULT_SCAN_MSECS;
+  _stat = qApp->property(PROPERTY_RADAR_STAT).toBool();
+}
+
+RadarTracker::~RadarTracker() {
+}
+
+
+void RadarTracker::setGeometry(const GeoPos& ship, double course, double speed, double sample_metres, double north_shift) {
+  QMutexLocker locker(&_geometry_mutex);
+
+  _geometry.ship = ship;
+  _geometry.course = course;
+  _geometry.speed = speed;
+  _geometry.sample_metres = sample_metres;
+  _geometry.north_shift = north_shift;
+}
+
+RadarTracker::Geometry RadarTracker::geometry() {
+  QMutexLocker locker(&_geometry_mutex);
+  return _geometry;
+}
+
+
+void RadarTracker::toLocal(const GeoPos& pos, double& x, double& y) const {
+  x = RLIMath::rads(pos.lon - _origin.lon) * RLIMath::ERADM * cos(RLIMath::rads(_origin.lat));
+  y = RLIMath::rads(pos.lat - _origin.lat) * RLIMath::ERADM;
+}
+
+GeoPos RadarTracker::toGeo(double x, double y) const {
+  return GeoPos( _origin.lat + RLIMath::degs(y / RLIMath::ERADM)
+               , _origin.lon + RLIMath::degs(x / (RLIMath::ERADM * cos(RLIMath::rads(_origin.lat)))) );
+}
+
+
+void RadarTracker::acquire(double lat, double lon) {
+  Geometry geom = geometry();
+
+  if (!_has_origin) {
+    _origin = geom.ship;
+    _has_origin = true;
+  }
+
+  double x, y;
+  toLocal(GeoPos(lat, lon), x, y);
+
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  addTrack(x, y, ACQUIRE_SIGMA, now, true);
+  publish(geom, now);
+}
+
+int RadarTracker::addTrack(double x, double y, double sigma, qint64 time, bool manual) {
+  _ids.push_back(_next_id++);
+  _x.push_back(x);
+  _y.push_back(y);
+  _vx.push_back(0.0);
+  _vy.push_back(0.0);
+  _p00.push_back(sigma * sigma);
+  _p01.push_back(0.0);
+  _p11.push_back(ACQUIRE_SPEED_SIGMA * ACQUIRE_SPEED_SIGMA);
+  _time.push_back(time);
+  _last_hit.push_back(time);
+  _hits.push_back(manual ? CONFIRM_HITS : 1);
+  _manual.push_back(manual ? 1 : 0);
+
+  int index = static_cast<int>(_ids.size()) - 1;
+  _track_index.update(index, x, y);
+  return index;
+}
+
+void RadarTracker::removeTrack(int index) {
+  int last = static_cast<int>(_ids.size()) - 1;
+
+  _ids[index] = _ids[last];       _ids.pop_back();
+  _x[index] = _x[last];           _x.pop_back();
+  _y[index] = _y[last];           _y.pop_back();
+  _vx[index] = _vx[last];         _vx.pop_back();
+  _vy[index] = _vy[last];         _vy.pop_back();
+  _p00[index] = _p00[last];       _p00.pop_back();
+  _p01[index] = _p01[last];       _p01.pop_back();
+  _p11[index] = _p11[last];       _p11.pop_back();
+  _time[index] = _time[last];     _time.pop_back();
+  _last_hit[index] = _last_hit[last]; _last_hit.pop_back();
+  _hits[index] = _hits[last];     _hits.pop_back();
+  _manual[index] = _manual[last]; _manual.pop_back();
+
+  _track_index.remove(last);
+  if (index != last)
+    _track_index.update(index, _x[index], _y[index]);
+}
+
+
+void RadarTracker::predict(int index, qint64 time) {
+  double dt = (time - _time[index]) / 1000.0;
+  if (dt <= 0.0)
+    return;
+
+  double q = ACCEL_SIGMA * ACCEL_SIGMA;
+  double dt2 = dt*dt;
+
+  _x[index] += _vx[index] * dt;
+  _y[index] += _vy[index] * dt;
+
+  double p00 = _p00[index], p01 = _p01[index], p11 = _p11[index];
+  _p00[index] = p00 + 2*dt*p01 + dt2*p11 + q*dt2*dt2/4;
+  _p01[index] = p01 + dt*p11 + q*dt2*dt/2;
+  _p11[index] = p11 + q*dt2;
+
+  _time[index] = time;
+  _track_index.update(index, _x[index], _y[index]);
+}
+
+void RadarTracker::correct(int index, double mx, double my, double r) {
+  double s = _p00[index] + r*r;
+  double k0 = _p00[index] / s;
+  double k1 = _p01[index] / s;
+
+  double ex = mx - _x[index];
+  double ey = my - _y[index];
+
+  _x[index] += k0 * ex;
+  _y[index] += k0 * ey;
+  _vx[index] += k1 * ex;
+  _vy[index] += k1 * ey;
+
+  double p00 = _p00[index], p01 = _p01[index], p11 = _p11[index];
+  _p00[index] = (1 - k0) * p00;
+  _p01[index] = (1 - k0) * p01;
+  _p11[index] = p11 - k1 * p01;
+
+  _hits[index]++;
+
+  _track_index.update(index, _x[index], _y[index]);
+}
+
+
+void RadarTracker::onPlotsExtracted(const QVector<RadarPlot>& plots) {
+  if (_stat)
+    _stat_timer.start();
+
+  Geometry geom = geometry();
+  if (!_has_origin) {
+    _origin = geom.ship;
+    _has_origin = true;
+  }
+
+  double ship_x, ship_y;
+  toLocal(geom.ship, ship_x, ship_y);
+
+  int plot_count = plots.size();
+  int track_count = trackCount();
+
+  _plot_x.resize(plot_count);
+  _plot_y.resize(plot_count);
+  _plot_index.clear();
+  for (int i = 0; i < plot_count; i++) {
+    double bearing = RLIMath::rads(geom.north_shift + 360.0 * plots[i].peleng / _peleng_count);
+    double range = plots[i].radius * geom.sample_metres;
+    _plot_x[i] = ship_x + range * sin(bearing);
+    _plot_y[i] = ship_y + range * cos(bearing);
+    _plot_index.update(i, _plot_x[i], _plot_y[i]);
+  }
+
+  qint64 now = plot_count > 0 ? plots[plot_count - 1].time : QDateTime::currentMSecsSinceEpoch();
+
+  double r = MEASURE_SIGMA_SAMPLES * geom.sample_metres;
+
+  // Tracks near the plots, the rest are out of the batch sector and are not predicted
+  _near_tracks.clear();
+  _track_used.assign(track_count, 0);
+  for (int i = 0; i < plot_count; i++) {
+    _track_index.radius(_plot_x[i], _plot_y[i], TRACK_SEARCH, _found);
+    for (int t : _found)
+      if (!_track_used[t]) {
+        _track_used[t] = 1;
+        _near_tracks.push_back(t);
+      }
+  }
+
+  // Gating
+  _candidates.clear();
+  for (int t : _near_tracks) {
+    predict(t, now);
+
+    double s = _p00[t] + r*r;
+    double gate = std::min(GATE_CHI2 * s, MAX_GATE * MAX_GATE);
+
+    _plot_index.radius(_x[t], _y[t], sqrt(gate), _found);
+    for (int i : _found) {
+      double ex = _plot_x[i] - _x[t];
+      double ey = _plot_y[i] - _y[t];
+      double d2 = ex*ex + ey*ey;
+
+      if (d2 < gate)
+        _candidates.push_back(Candidate { static_cast<float>(d2 / s), i, t });
+    }
+  }
+
+  // Association, nearest pairs first
+  std::sort(_candidates.begin(), _candidates.end(), [](const Candidate& a, const Candidate& b) {
+    return a.dist < b.dist;
+  });
+
+  _plot_used.assign(plot_count, 0);
+  _track_used.assign(track_count, 0);
+
+  for (const Candidate& c : _candidates) {
+    if (_plot_used[c.plot] || _track_used[c.track])
+      continue;
+
+    _plot_used[c.plot] = 1;
+    _track_used[c.track] = 1;
+    correct(c.track, _plot_x[c.plot], _plot_y[c.plot], r);
+    _last_hit[c.track] = now;
+  }
+
+  // Автозахват: every plot left starts a tentative track
+  for (int i = 0; i < plot_count; i++)
+    if (!_plot_used[i])
+      addTrack(_plot_x[i], _plot_y[i], r, now, false);
+
+  updateScanPeriod(plots, now);
+
+  if (_stat) {
+    qint64 nsecs = _stat_timer.nsecsElapsed();
+    _stat_nsecs += nsecs;
+    _stat_max_nsecs = std::max(_stat_max_nsecs, nsecs);
+    _stat_plots += plot_count;
+    _stat_batches++;
+  }
+
+  publish(geom, now);
+}
+
+
+// Plots come in bearing order, the sweep crosses north when the bearing goes back by half a circle
+void RadarTracker::updateScanPeriod(const QVector<RadarPlot>& plots, qint64 now) {
+  if (plots.isEmpty())
+    return;
+
+  if (_last_plot_peleng >= 0.f && plots.first().peleng < _last_plot_peleng - _peleng_count / 2) {
+    if (_scan_start >= 0 && now > _scan_start)
+      _scan_msecs = now - _scan_start;
+    _scan_start = now;
+  }
+
+  _last_plot_peleng = plots.last().peleng;
+}
+
+
+// Tracks out of the last batches are extrapolated to now
+void RadarTracker::closestApproach(int index, const Geometry& geom, qint64 now, double& cpa, double& tcpa) const {
+  double ship_x, ship_y;
+  toLocal(geom.ship, ship_x, ship_y);
+
+  double own_vx = geom.speed * KNOT2MPS * sin(RLIMath::rads(geom.course));
+  double own_vy = geom.speed * KNOT2MPS * cos(RLIMath::rads(geom.course));
+
+  double dt = std::max(now - _time[index], qint64(0)) / 1000.0;
+  double rx = _x[index] + _vx[index] * dt - ship_x;
+  double ry = _y[index] + _vy[index] * dt - ship_y;
+  double vx = _vx[index] - own_vx;
+  double vy = _vy[index] - own_vy;
+
+  double v2 = vx*vx + vy*vy;
+  tcpa = (v2 > 1e-6) ? -(rx*vx + ry*vy) / v2 : 0.0;
+
+  double cx = rx + vx * std::max(tcpa, 0.0);
+  double cy = ry + vy * std::max(tcpa, 0.0);
+  cpa = sqrt(cx*cx + cy*cy);
+}
+
+// Sends tracks which got a plot (or were acquired), removes lost ones
+// and reports the most dangerous target
+void RadarTracker::publish(const Geometry& geom, qint64 now) {
+  bool danger = false;
+  double danger_cpa = 0.0, danger_tcpa = 0.0;
+
+  double ship_x, ship_y;
+  toLocal(geom.ship, ship_x, ship_y);
+
+  _track_index.radius(ship_x, ship_y, DANGER_RANGE, _found);
+  for (int t : _found) {
+    if (_hits[t] < CONFIRM_HITS)
+      continue;
+
+    double cpa, tcpa;
+    closestApproach(t, geom, now, cpa, tcpa);
+
+    double cpa_miles = cpa / RLIMath::MILE2METER;
+    double tcpa_mins = tcpa / 60.0;
+
+    if (cpa_miles < CPA_LIMIT_MILES && tcpa_mins >= 0.0 && tcpa_mins < TCPA_LIMIT_MINS)
+      if (!danger || tcpa_mins < danger_tcpa) {
+        danger = true;
+        danger_cpa = cpa_miles;
+        danger_tcpa = tcpa_mins;
+      }
+  }
+
+  for (int t = 0; t < trackCount(); t++) {
+    if (_hits[t] < CONFIRM_HITS || _last_hit[t] != now)
+      continue;
+
+    double cpa, tcpa;
+    closestApproach(t, geom, now, cpa, tcpa);
+
+    GeoPos pos = toGeo(_x[t], _y[t]);
+
+    RLITarget target;
+    target.latitude = pos.lat;
+    target.longtitude = pos.lon;
+    target.heading = -1;
+    target.course_grnd = fmod(RLIMath::degs(atan2(_vx[t], _vy[t])) + 360.0, 360.0);
+    target.speed_grnd = sqrt(_vx[t]*_vx[t] + _vy[t]*_vy[t]) / KNOT2MPS;
+    target.cpa = cpa / RLIMath::MILE2METER;
+    target.tcpa = tcpa / 60.0;
+
+    _feed.put(static_cast<quint32>(_ids[t]), target);
+  }
+
+  // Tentative tracks were never published
+  qint64 miss_msecs = static_cast<qint64>(MISS_SCANS * _scan_msecs);
+  for (int t = trackCount() - 1; t >= 0; t--) {
+    if (_hits[t] < CONFIRM_HITS) {
+      if (now - _last_hit[t] > miss_msecs)
+        removeTrack(t);
+    } else if (now - _last_hit[t] > LOST_MSECS) {
+      _feed.remove(static_cast<quint32>(_ids[t]));
+      removeTrack(t);
+    }
+  }
+
+  _feed.publish();
+
+  emit dangerUpdated(danger, danger_cpa, danger_tcpa);
+
+  if (_stat && now - _stat_since >= 1000) {
+    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+             << "Tracking:" << trackCount() << "tracks," << _stat_plots << "plots in" << _stat_batches << "batches,"
+             << _stat_nsecs / 1e6 << "ms total," << _stat_max_nsecs / 1e3 << "us max per batch";
+
+    _stat_nsecs = 0;
+    _stat_max_nsecs = 0;
+    _stat_plots = 0;
+    _stat_batches = 0;
+    _stat_since = now;
+  }
+}
@@ -0,0 +1,125 @@
+#ifndef RADARTRACKER_H
+#define RADARTRACKER_H
+
+#include <vector>
+
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include "../common/rlimath.h"
+#include "../common/targetindex.h"
+#include "../datasources/targetfeed.h"
+#include "radarplotextractor.h"
+
+// Сопровождение целей (САРП).
+// Tracks live in a local metric frame (x east, y north) around the first ship position.
+// Each track is a constant velocity Kalman filter, x and y share one 2x2 covariance.
+// Plots of a batch are associated with predicted tracks inside a chi-square gate
+// (candidates are taken from a grid index of plots),
+// pairs are taken by increasing distance (greedy global nearest neighbour).
+// A batch covers one sector, only tracks found near its plots in the grid index
+// of tracks are predicted and gated.
+// Every plot left starts a tentative track, which is confirmed after CONFIRM_HITS plots
+// and dropped if a scan passes without a plot for it.
+// Track data is kept as structure of arrays, removal swaps with the last track.
+class RadarTracker : public QObject {
+  Q_OBJECT
+public:
+  explicit RadarTracker(int pel_count, QObject* parent = nullptr);
+  virtual ~RadarTracker();
+
+  // Own ship and radar picture geometry, may be called from any thread
+  void setGeometry(const GeoPos& ship, double course, double speed, double sample_metres, double north_shift);
+
+  inline int trackCount() const { return static_cast<int>(_ids.size()); }
+  // Confirmed tracks as "R<id>" targets
+  inline TargetFeed* feed() { return &_feed; }
+
+signals:
+  // Most dangerous target: CPA in miles, TCPA in minutes
+  void dangerUpdated(bool danger, double cpa, double tcpa);
+
+public slots:
+  void onPlotsExtracted(const QVector<RadarPlot>& plots);
+  // Ручной захват
+  void acquire(double lat, double lon);
+
+private:
+  struct Geometry {
+    GeoPos ship { 0.0, 0.0 };
+    double course = 0.0;
+    double speed = 0.0;
+    double sample_metres = 1.0;
+    double north_shift = 0.0;
+  };
+
+  struct Candidate {
+    float dist;
+    int plot;
+    int track;
+  };
+
+  Geometry geometry();
+
+  void toLocal(const GeoPos& pos, double& x, double& y) const;
+  GeoPos toGeo(double x, double y) const;
+
+  int addTrack(double x, double y, double sigma, qint64 time, bool manual);
+  void updateScanPeriod(const QVector<RadarPlot>& plots, qint64 now);
+  void removeTrack(int index);
+
+  void predict(int index, qint64 time);
+  void correct(int index, double mx, double my, double r);
+
+  // Distance (m) and time (s) of the closest point of approach to own ship
+  void closestApproach(int index, const Geometry& geom, qint64 now, double& cpa, double& tcpa) const;
+  void publish(const Geometry& geom, qint64 now);
+
+  int _peleng_count;
+
+  TargetFeed _feed { "R" };
+
+  QMutex _geometry_mutex;
+  Geometry _geometry;
+
+  bool _has_origin = false;
+  GeoPos _origin { 0.0, 0.0 };
+
+  int _next_id = 1;
+
+  // Antenna scan period, measured by the plots crossing north
+  qint64 _scan_msecs;
+  qint64 _scan_start = -1;
+  float _last_plot_peleng = -1.f;
+
+  // Tracks, structure of arrays
+  std::vector<int>    _ids;
+  std::vector<double> _x, _y, _vx, _vy;
+  std::vector<double> _p00, _p01, _p11;
+  std::vector<qint64> _time;       // Time the state is predicted to
+  std::vector<qint64> _last_hit;   // Time of the last associated plot
+  std::vector<int>    _hits;
+  std::vector<char>   _manual;
+
+  TargetIndex _track_index;
+
+  // Work buffers
+  TargetIndex _plot_index;
+  std::vector<int> _found;
+  std::vector<int> _near_tracks;
+  std::vector<double> _plot_x, _plot_y;
+  std::vector<Candidate> _candidates;
+  std::vector<char> _plot_used, _track_used;
+
+  bool _stat;
+  QElapsedTimer _stat_timer;
+  qint64 _stat_nsecs = 0;
+  qint64 _stat_max_nsecs = 0;
+  int _stat_plots = 0;
+  int _stat_batches = 0;
+  qint64 _stat_since = 0;
+};
+
+#endif // RADARTRACKER_H
@@ -0,0 +1,207 @@
+#include "radarvideoprocessor.h"
+#include "../common/properties.h"
+#include "../common/rlisimd.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QDateTime>
+#include <QCoreApplication>
+
+// Part of the peleng affected by STC
+static const float STC_RANGE_PART  = 0.25f;
+
+// FTC: number of preceding samples the echo is differentiated against
+static const int   FTC_WINDOW      = 12;
+
+// CA-CFAR: guard and training cells on each side, threshold factor
+static const int   CFAR_GUARD      = 2;
+static const int   CFAR_TRAINING   = 16;
+static const float CFAR_FACTOR     = 2.5f;
+
+static const float MAX_AMPLITUDE   = 255.f;
+
+
+RadarVideoProcessor::RadarVideoProcessor(int pel_count, int pel_len, QObject* parent) : QObject(parent) {
+  _peleng_count = pel_count;
+  _peleng_len = pel_len;
+
+  _stc_curve.resize(pel_len);
+  _prefix.resize(pel_len + 1);
+  _mean.resize(pel_len);
+  _work.resize(pel_len);
+  _output.assign(static_cast<size_t>(pel_count) * pel_len, 0.f);
+
+  _history.assign(static_cast<size_t>(HISTORY_REVOLUTIONS) * pel_count * pel_len, 0);
+  _history_plane.assign(pel_count, 0);
+  _correlated.resize(pel_len);
+
+  _cfar.store(qApp->property(PROPERTY_RADAR_CFAR).toBool());
+  _stat = qApp->property(PROPERTY_RADAR_STAT).toBool();
+}
+
+RadarVideoProcessor::~RadarVideoProcessor() {
+}
+
+
+void RadarVideoProcessor::processData(int offset, int count, GLfloat* amps) {
+  if (_stat)
+    _stat_timer.start();
+
+  float water = _water.load();
+  if (water != _stc_water)
+    updateStcCurve(water);
+
+  float gain = _gain.load();
+  float rain = _rain.load();
+  bool cfar = _cfar.load();
+  bool interference = _interference.load();
+
+  for (int i = 0; i < count; i++) {
+    int peleng = (offset + i) % _peleng_count;
+    processPeleng( peleng
+                 , amps + static_cast<size_t>(i) * _peleng_len
+                 , &_output[static_cast<size_t>(peleng) * _peleng_len]
+                 , gain, rain, interference, cfar );
+  }
+
+  if (_stat)
+    collectStat(count, _stat_timer.nsecsElapsed());
+
+  // The output is emitted in parts which do not wrap over the circle start,
+  // readers take the block as contiguous pelengs
+  count = std::min(count, _peleng_count);
+  int first = offset % _peleng_count;
+  while (count > 0) {
+    int part = std::min(count, _peleng_count - first);
+    emit updateRadarData(first, part, &_output[static_cast<size_t>(first) * _peleng_len]);
+
+    count -= part;
+    first = 0;
+  }
+}
+
+void RadarVideoProcessor::processPeleng(int peleng, const GLfloat* src, GLfloat* dst, float gain, float rain, bool interference, bool cfar) {
+  size_t len = static_cast<size_t>(_peleng_len);
+
+  // ВАРУ (STC): подавление помех от моря на ближней дальности
+  RLISimd::subScaledClampf(src, _stc_curve.data(), 1.f, _work.data(), len);
+
+  // СДЦ (FTC): дифференцирование по дальности, подавление дождя
+  if (rain > 0.f) {
+    RLISimd::prefixSumf(_work.data(), _prefix.data(), len);
+
+    // Near zero range the window is shorter
+    int edge = std::min(FTC_WINDOW, _peleng_len);
+    for (int r = 0; r < edge; r++)
+      _mean[r] = r > 0 ? _prefix[r] / r : 0.f;
+
+    if (_peleng_len > FTC_WINDOW)
+      RLISimd::windowMeanf( &_prefix[FTC_WINDOW], &_prefix[0], 1.f / FTC_WINDOW
+                          , &_mean[FTC_WINDOW], len - FTC_WINDOW );
+
+    RLISimd::subScaledClampf(_work.data(), _mean.data(), rain / MAX_AMPLITUDE, _work.data(), len);
+  }
+
+  // Усиление: 0 - номинальное, 255 - в 5 раз
+  RLISimd::scaleClampf(_work.data(), 1.f + gain / 64.f, MAX_AMPLITUDE, dst, len);
+
+  rejectInterference(peleng, dst, interference);
+
+  // CA-CFAR по средней амплитуде обучающих ячеек
+  if (cfar) {
+    RLISimd::prefixSumf(dst, _prefix.data(), len);
+
+    // Full training windows on both sides between first and last,
+    // samples at the ends have cut windows
+    int first = std::min(CFAR_GUARD + CFAR_TRAINING, _peleng_len);
+    int last = std::max(first, _peleng_len - CFAR_GUARD - CFAR_TRAINING);
+
+    for (int r = 0; r < first; r++)
+      _mean[r] = cfarMean(r);
+    for (int r = last; r < _peleng_len; r++)
+      _mean[r] = cfarMean(r);
+
+    if (last > first)
+      RLISimd::windowMean2f( &_prefix[first - CFAR_GUARD], &_prefix[first - CFAR_GUARD - CFAR_TRAINING]
+                           , &_prefix[first + CFAR_GUARD + CFAR_TRAINING + 1], &_prefix[first + CFAR_GUARD + 1]
+                           , 1.f / (2 * CFAR_TRAINING), &_mean[first], static_cast<size_t>(last - first) );
+
+    RLISimd::thresholdf(dst, _mean.data(), CFAR_FACTOR, dst, len);
+  }
+}
+
+// Pulses of other radars are not synchronous with ours and fall on different
+// samples every revolution, while echoes repeat. The peleng is limited by the median
+// (or min) of the same bearing over the last HISTORY_REVOLUTIONS revolutions.
+void RadarVideoProcessor::rejectInterference(int peleng, GLfloat* dst, bool apply) {
+  size_t len = static_cast<size_t>(_peleng_len);
+  size_t plane_size = static_cast<size_t>(_peleng_count) * len;
+
+  int plane = (_history_plane[peleng] + 1) % HISTORY_REVOLUTIONS;
+  _history_plane[peleng] = static_cast<uint8_t>(plane);
+
+  uint8_t* rows[HISTORY_REVOLUTIONS];
+  for (int k = 0; k < HISTORY_REVOLUTIONS; k++)
+    rows[k] = &_history[k * plane_size + peleng * len];
+
+  RLISimd::packu8(dst, rows[plane], len);
+
+  if (!apply)
+    return;
+
+  if (HISTORY_REVOLUTIONS == 3) {
+    RLISimd::median3u8(rows[0], rows[1], rows[2], _correlated.data(), len);
+  } else {
+    RLISimd::minu8(rows[0], rows[1], _correlated.data(), len);
+    for (int k = 2; k < HISTORY_REVOLUTIONS; k++)
+      RLISimd::minu8(_correlated.data(), rows[k], _correlated.data(), len);
+  }
+
+  RLISimd::minf_u8(dst, _correlated.data(), dst, len);
+}
+
+// Mean of the training cells of the sample from the prefix sums, windows are cut at the peleng ends
+float RadarVideoProcessor::cfarMean(int r) const {
+  int l1 = std::max(0, r - CFAR_GUARD - CFAR_TRAINING);
+  int l2 = std::max(0, r - CFAR_GUARD);
+  int r1 = std::min(_peleng_len, r + CFAR_GUARD + 1);
+  int r2 = std::min(_peleng_len, r + CFAR_GUARD + CFAR_TRAINING + 1);
+
+  int cells = (l2 - l1) + (r2 - r1);
+  return cells > 0 ? ((_prefix[l2] - _prefix[l1]) + (_prefix[r2] - _prefix[r1])) / cells : 0.f;
+}
+
+// Attenuation falls quadratically from `water` at zero range to 0 at STC_RANGE_PART of the peleng
+void RadarVideoProcessor::updateStcCurve(float water) {
+  _stc_water = water;
+
+  int stc_len = static_cast<int>(_peleng_len * STC_RANGE_PART);
+
+  for (int r = 0; r < _peleng_len; r++) {
+    if (r < stc_len) {
+      float k = 1.f - static_cast<float>(r) / stc_len;
+      _stc_curve[r] = water * k * k;
+    } else {
+      _stc_curve[r] = 0.f;
+    }
+  }
+}
+
+
+void RadarVideoProcessor::collectStat(int count, qint64 nsecs) {
+  _stat_nsecs += nsecs;
+  _stat_pelengs += count;
+
+  if (_stat_pelengs < _peleng_count)
+    return;
+
+  double secs = _stat_nsecs / 1e9;
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+           << "Video processing:" << _stat_pelengs << "pelengs in" << secs * 1000.0 << "ms,"
+           << (secs > 0.0 ? _stat_pelengs / secs : 0.0) << "pelengs/s,"
+           << (secs > 0.0 ? _stat_pelengs / secs / _peleng_count : 0.0) << "revolutions/s";
+
+  _stat_nsecs = 0;
+  _stat_pelengs = 0;
+}
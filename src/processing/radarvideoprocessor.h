@@ -0,0 +1,84 @@
+#ifndef RADARVIDEOPROCESSOR_H
+#define RADARVIDEOPROCESSOR_H
+
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QOpenGLFunctions>
+
+// Обработка радарного видео между источником данных и RadarEngine.
+// Lives in its own thread. Every peleng goes through
+//   STC (water) -> FTC (rain) -> gain -> interference rejection -> CFAR
+// and the result is written to a buffer of one revolution, which is emitted
+// the same way as RadarDataSource::updateRadarData.
+// Settings are atomics, so they can be changed from the GUI thread at any time.
+class RadarVideoProcessor : public QObject {
+  Q_OBJECT
+public:
+  // Revolutions kept for scan-to-scan correlation
+  enum { HISTORY_REVOLUTIONS = 3 };
+
+  explicit RadarVideoProcessor(int pel_count, int pel_len, QObject* parent = nullptr);
+  virtual ~RadarVideoProcessor();
+
+  // Values 0..255 as in RLIState
+  inline void setGain(float val)    { _gain.store(val); }
+  inline void setWater(float val)   { _water.store(val); }
+  inline void setRain(float val)    { _rain.store(val); }
+  inline void setCfar(bool val)     { _cfar.store(val); }
+  // Подавление несинхронных помех, history is recorded even when it is off
+  inline void setInterferenceRejection(bool val) { _interference.store(val); }
+
+signals:
+  void updateRadarData(int offset, int count, GLfloat* amps);
+
+public slots:
+  void processData(int offset, int count, GLfloat* amps);
+
+private:
+  void processPeleng(int peleng, const GLfloat* src, GLfloat* dst, float gain, float rain, bool interference, bool cfar);
+  void rejectInterference(int peleng, GLfloat* dst, bool apply);
+
+  void updateStcCurve(float water);
+  float cfarMean(int r) const;
+
+  void collectStat(int count, qint64 nsecs);
+
+  int _peleng_count;
+  int _peleng_len;
+
+  std::atomic<float> _gain  { 0.f };
+  std::atomic<float> _water { 0.f };
+  std::atomic<float> _rain  { 0.f };
+  std::atomic<bool>  _cfar  { false };
+  std::atomic<bool>  _interference { false };
+
+  // Water value the STC curve was built for
+  float _stc_water = -1.f;
+  std::vector<GLfloat> _stc_curve;
+
+  // Work buffers of one peleng
+  std::vector<GLfloat> _prefix;
+  std::vector<GLfloat> _mean;
+  std::vector<GLfloat> _work;
+
+  // History ring of HISTORY_REVOLUTIONS planes pel_count x pel_len, one byte per sample,
+  // and the plane each peleng has been written to last
+  std::vector<uint8_t> _history;
+  std::vector<uint8_t> _history_plane;
+  std::vector<uint8_t> _correlated;
+
+  // Processed data of the last revolution
+  std::vector<GLfloat> _output;
+
+  // Throughput statistics (-stat)
+  bool _stat;
+  QElapsedTimer _stat_timer;
+  qint64 _stat_nsecs = 0;
+  int _stat_pelengs = 0;
+};
+
+#endif // RADARVIDEOPROCESSOR_H
@@ -8,10 +8,12 @@
 #include <QDebug>
 #include <QDateTime>
 #include <QApplication>
+#include <QtConcurrentRun>
 
 #include "common/properties.h"
 #include "common/rlistrings.h"
 #include "common/rlimath.h"
+#include "common/startuptrace.h"
 
 
 RLIDisplayWidget::RLIDisplayWidget(QWidget *parent) : QOpenGLWidget(parent) {
@@ -20,6 +22,7 @@ RLIDisplayWidget::RLIDisplayWidget(QWidget *parent) : QOpenGLWidget(parent) {
   qRegisterMetaType<RLITarget>("RadarTarget");
   qRegisterMetaType<RLIShipState>("RLIShipState");
   qRegisterMetaType<RLIString>("RLIString");
+  qRegisterMetaType<QVector<RadarPlot>>("QVector<RadarPlot>");
 
   _chart_mngr.loadCharts();
   connect( &_chart_mngr, SIGNAL(newChartAvailable(QString)), SLOT(onNewChartAvailable(QString)));
@@ -34,7 +37,13 @@ RLIDisplayWidget::~RLIDisplayWidget() {
   delete _infoFonts;
   delete _radarEngine;
   delete _tailsEngine;
+  delete _trails;
+  delete _history;
   delete _maskEngine;
+
+  QMetaObject::invokeMethod(_chartEngine, "stop", Qt::BlockingQueuedConnection);
+  _chart_thread.quit();
+  _chart_thread.wait();
   delete _chartEngine;
   delete _menuEngine;
   delete _magnEngine;
@@ -49,19 +58,48 @@ RLIDisplayWidget::~RLIDisplayWidget() {
 }
 
 
-void RLIDisplayWidget::setupRadarDataSource(RadarDataSource* rds) {
-  connect( rds, SIGNAL(updateRadarData(int, int, GLfloat*))
-         , _radarEngine, SLOT(updateData(int, int, GLfloat*))
+void RLIDisplayWidget::setupRadarProcessor(RadarVideoProcessor* proc) {
+  _radarProc = proc;
+  updateVideoProcessing();
+
+  connect( proc, SIGNAL(updateRadarData(int, int, GLfloat*))
+         , this, SLOT(onRadarData(int, int, GLfloat*))
+         , Qt::QueuedConnection );
+
+  connect( proc, SIGNAL(updateRadarData(int, int, GLfloat*))
+         , _history, SLOT(updateData(int, int, GLfloat*))
+         , Qt::QueuedConnection );
+
+  connect( proc, SIGNAL(updateRadarData(int, int, GLfloat*))
+         , _trails, SLOT(updateData(int, int, GLfloat*))
          , Qt::QueuedConnection );
 
-  connect( rds, SIGNAL(updateTrailData(int, int, GLfloat*))
-         , _tailsEngine, SLOT(updateData(int, int, GLfloat*))
+  connect( proc, SIGNAL(updateRadarData(int, int, GLfloat*))
+         , _scheduler, SLOT(onRadarData())
          , Qt::QueuedConnection );
 }
 
+void RLIDisplayWidget::setupTracker(RadarTracker* tracker) {
+  _tracker = tracker;
+  _trgtEngine->addFeed(tracker->feed());
+
+  connect( tracker, SIGNAL(dangerUpdated(bool,double,double))
+         , _infoEngine, SLOT(onDangerUpdated(bool,double,double))
+         , Qt::QueuedConnection );
+}
+
+void RLIDisplayWidget::updateVideoProcessing() {
+  if (_radarProc == nullptr)
+    return;
+
+  _radarProc->setGain(_state.gain);
+  _radarProc->setWater(_state.water);
+  _radarProc->setRain(_state.rain);
+  _radarProc->setInterferenceRejection(_state.interference_rejection);
+}
+
 void RLIDisplayWidget::setupTargetDataSource(TargetDataSource* tds) {
-  connect( tds, SIGNAL(updateTarget(QString,RadarTarget))
-         , _trgtEngine, SLOT(updateTarget(QString,RadarTarget)));
+  _trgtEngine->addFeed(tds->feed());
 }
 
 void RLIDisplayWidget::setupShipDataSource(ShipDataSource* sds) {
@@ -82,7 +120,6 @@ void RLIDisplayWidget::onNewChartAvailable(const QString& name) {
   //if (name == "CO200008.000") {
     qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Setting up chart " << name;
     _chartEngine->setChart(_chart_mngr.getChart(name), _chart_mngr.refs());
-    qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Setting up chart finished";
   }
 }
 
@@ -111,6 +148,7 @@ void RLIDisplayWidget::initializeGL() {
     return;
 
   qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "GL init start";
+  qint64 init_begin = StartupTrace::now();
 
   initializeOpenGLFunctions();
 
@@ -128,56 +166,79 @@ void RLIDisplayWidget::initializeGL() {
   int circle_radius = _layout_manager.layout()->circle.radius;
 
   // Layers initialization
+  // CPU side preparation runs on the pool, this thread only makes GL objects:
+  //   radar coord table  ->  radar engine, tails engine
+  //   font images        ->  fonts  ->  mask, menu
+  //   mode images        ->  mode textures
+  // S52 assets are prepared by the chart thread, charts are read by ChartManager
   //-------------------------------------------------------------
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Fonts init start";
-  _infoFonts = new InfoFonts(context(), "data/textures/fonts");
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Fonts init finish";
-
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar engine init start";
-  _radarEngine = new RadarEngine(bearings_per_cycle, peleng_size, circle_radius, context(), this);  
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar engine init finish";
-
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Tails engine init start";
-  _tailsEngine = new RadarEngine(bearings_per_cycle, peleng_size, circle_radius, context(), this);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Tails engine init finish";
-
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Mask engine init start";
-  qDebug() << _layout_manager.size();
-  qDebug() << _layout_manager.layout()->circle.radius;
-  _maskEngine = new MaskEngine(_layout_manager.size(), _layout_manager.layout()->circle, _infoFonts, context(), _state, this);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Mask engine init finish";
+  // Strips are not drawn with -cpu, so the coord table is not needed
+  QFuture<void> coord_table;
+  if (!qApp->property(PROPERTY_RADAR_CPU).toBool())
+    coord_table = QtConcurrent::run([=]() {
+      RadarCoordTable::get(bearings_per_cycle, peleng_size);
+    });
+  QFuture<QHash<QString, QImage>> font_images = QtConcurrent::run([]() {
+    StartupTrace::Span span("Font images");
+    return InfoFonts::loadImages("data/textures/fonts");
+  });
+  QFuture<QMap<char, QImage>> mode_images = QtConcurrent::run([]() {
+    StartupTrace::Span span("Mode images");
+    return loadModeImages("data/textures/symbols/");
+  });
+
+  {
+    StartupTrace::Span span("Chart engine");
+    _chartEngine = new ChartEngine(circle_radius, _chart_mngr.refs(), context());
+    _chartEngine->moveToThread(&_chart_thread);
+    _chart_thread.start();
+    QMetaObject::invokeMethod(_chartEngine, "prepare", Qt::QueuedConnection);
+  }
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Chart engine init start";
-  _chartEngine = new ChartEngine(circle_radius, _chart_mngr.refs(), context(), this);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Chart engine init finish";
+  {
+    // Both engines take the table of the pool task, waiting for it if it is still being built
+    StartupTrace::Span span("Radar engines");
+    _radarEngine = new RadarEngine(bearings_per_cycle, peleng_size, circle_radius, context(), this);
+    _tailsEngine = new RadarEngine(bearings_per_cycle, peleng_size, circle_radius, context(), this);
+    _tailsEngine->setTrailMode(true);
+    _trails = new RadarTrails(bearings_per_cycle, peleng_size, this);
+    _history = new RadarHistory(bearings_per_cycle, peleng_size, qApp->property(PROPERTY_RADAR_HISTORY).toInt(), this);
+  }
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Info engine init start";
-  _infoEngine = new InfoEngine(_layout_manager.layout(), context(), this);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Info engine init finish";
+  {
+    StartupTrace::Span span("Fonts");
+    _infoFonts = new InfoFonts(context(), font_images.result());
+  }
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Menu engine init start";
-  _menuEngine = new MenuEngine(_layout_manager.layout()->menu, context(), this);
-  _menuEngine->setFonts(_infoFonts);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Menu engine init finish";
+  {
+    StartupTrace::Span span("Mask engine");
+    _maskEngine = new MaskEngine(_layout_manager.size(), _layout_manager.layout()->circle, _infoFonts, context(), _state, this);
+  }
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Magnifier engine init start";
-  _magnEngine = new MagnifierEngine(_layout_manager.layout()->magnifier, context(), this);
-  _magnEngine->setAmplitudesVBOId(_radarEngine->ampsVboId());
-  _magnEngine->setPalletteTextureId(_radarEngine->paletteTexId());
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Magnifier engine init finish";
+  {
+    StartupTrace::Span span("Info engine");
+    _infoEngine = new InfoEngine(_layout_manager.layout(), context(), this);
+  }
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Target engine init start";
-  _trgtEngine = new TargetEngine(context(), this);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Target engine init finish";
+  {
+    StartupTrace::Span span("Menu engine");
+    _menuEngine = new MenuEngine(_layout_manager.layout()->menu, context(), this);
+    _menuEngine->setFonts(_infoFonts);
+  }
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Route engine init start";
-  _routeEngine = new RouteEngine(context(), this);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Route engine init finish";
+  {
+    StartupTrace::Span span("Magnifier engine");
+    _magnEngine = new MagnifierEngine(_layout_manager.layout()->magnifier, context(), this);
+    _magnEngine->setPalletteTextureId(_radarEngine->paletteTexId());
+  }
 
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Controls engine init start";
-  _ctrlEngine = new ControlsEngine(context(), this);
-  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Controls engine init finish";
+  {
+    StartupTrace::Span span("Target, route and controls engines");
+    _trgtEngine = new TargetEngine(context(), this);
+    _routeEngine = new RouteEngine(context(), this);
+    _ctrlEngine = new ControlsEngine(context(), this);
+  }
 
   //-------------------------------------------------------------
 
@@ -185,16 +246,32 @@ void RLIDisplayWidget::initializeGL() {
 
   _program = new QOpenGLShaderProgram(this);
   initShaders();
-  initModeTextures(tr("data/textures/symbols/"));
+
+  {
+    StartupTrace::Span span("Mode textures");
+    initModeTextures(mode_images.result());
+  }
 
   connect( _menuEngine, SIGNAL(radarBrightnessChanged(int))
          , _radarEngine, SLOT(onBrightnessChanged(int)));
+  connect( _menuEngine, SIGNAL(radarBrightnessChanged(int))
+         , _tailsEngine, SLOT(onBrightnessChanged(int)));
+
+  connect( _trails, SIGNAL(updateTrailData(int, int, GLfloat*))
+         , _tailsEngine, SLOT(updateData(int, int, GLfloat*)));
+
+  _replay_timer.setInterval(20);
+  connect( &_replay_timer, SIGNAL(timeout())
+         , this, SLOT(onReplayTimer()));
 
   connect( _menuEngine, SIGNAL(languageChanged(RLIString))
          , _menuEngine, SLOT(onLanguageChanged(RLIString)));
   connect( _menuEngine, SIGNAL(languageChanged(RLIString))
          , _infoEngine, SLOT(onLanguageChanged(RLIString)));
 
+  connect( _menuEngine, SIGNAL(tailsModeChanged(RLIString))
+         , this, SLOT(onTailsModeChanged(RLIString)));
+
   connect( _trgtEngine, SIGNAL(targetCountChanged(int))
          , _infoEngine, SLOT(onTargetCountChanged(int)));
   connect( _trgtEngine, SIGNAL(selectedTargetUpdated(QString,RadarTarget))
@@ -210,9 +287,16 @@ void RLIDisplayWidget::initializeGL() {
   connect( _menuEngine, SIGNAL(finishRouteEdit())
          , this, SLOT(onRouteEditionFinished()));
 
+  _scheduler = new FrameScheduler(this, qApp->property(PROPERTY_FRAME_DELAY).toInt(), [this]() { return layersChanged(); }, this);
+
+  connect( _chartEngine, SIGNAL(imagePublished())
+         , _scheduler, SLOT(onChartImage())
+         , Qt::QueuedConnection );
+
   emit initialized();
   _initialized = true;
 
+  StartupTrace::record("GL init", init_begin, StartupTrace::now());
   qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "GL init finish";
 }
 
@@ -232,10 +316,20 @@ void RLIDisplayWidget::initShaders() {
   _program->release();
 }
 
-void RLIDisplayWidget::initModeTextures(const QString& path) {
+QMap<char, QImage> RLIDisplayWidget::loadModeImages(const QString& path) {
+  QMap<char, QImage> images;
+
   for (QString fName : QDir(path).entryList(QStringList { "*.png" })) {
     QString name = fName.right(fName.length() - fName.lastIndexOf("/") - 1).replace(".png", "");
-    QImage img = QImage(path + fName);
+    images.insert(name[0].toLatin1(), QImage(path + fName));
+  }
+
+  return images;
+}
+
+void RLIDisplayWidget::initModeTextures(const QMap<char, QImage>& images) {
+  for (char name : images.keys()) {
+    const QImage& img = images[name];
 
     QOpenGLTexture* tex = new QOpenGLTexture(QOpenGLTexture::Target2D);
 
@@ -246,7 +340,7 @@ void RLIDisplayWidget::initModeTextures(const QString& path) {
 
     tex->setData(img, QOpenGLTexture::DontGenerateMipMaps);
 
-    _mode_textures.insert(name[0].toLatin1(), tex);
+    _mode_textures.insert(name, tex);
   }
 }
 
@@ -332,11 +426,37 @@ void RLIDisplayWidget::paintGL() {
   if (!_initialized)
     return;
 
+  _scheduler->beginFrame();
+
   updateLayers();
   glFlush();
 
   paintLayers();
   glFlush();
+
+  _scheduler->endFrame();
+
+  if (!_first_frame_traced) {
+    StartupTrace::mark("First frame");
+    _first_frame_traced = true;
+  }
+
+  // The trace ends with the first frame showing radar video
+  if (!_startup_traced && _radarEngine->hasData()) {
+    StartupTrace::mark("First radar frame");
+    StartupTrace::finish(qApp->property(PROPERTY_STARTUP_TRACE).toString());
+    _startup_traced = true;
+  }
+}
+
+
+// Changes of the layers which are not reported by a signal
+bool RLIDisplayWidget::layersChanged() {
+  // Часы
+  if (frameTimes.isEmpty() || frameTimes.last().time().second() != QTime::currentTime().second())
+    return true;
+
+  return _infoEngine->needsUpdate() || _menuEngine->needsUpdate() || _trgtEngine->hasUpdates();
 }
 
 
@@ -361,8 +481,11 @@ void RLIDisplayWidget::paintLayers() {
   if (_state.orientation == RLIOrientation::NORTH)
     drawRect(QRect(topLeft, _chartEngine->size()), _chartEngine->textureId());
 
+  // Следы под текущим видео
+  if (_trails->isEnabled())
+    drawRect(QRect(topLeft, _tailsEngine->size()), _tailsEngine->textureId());
+
   drawRect(QRect(topLeft, _radarEngine->size()), _radarEngine->textureId());
-  drawRect(QRect(topLeft, _tailsEngine->size()), _tailsEngine->textureId());
 
 
   QPointF center = layout->circle.center;
@@ -399,17 +522,31 @@ void RLIDisplayWidget::paintLayers() {
 
 
 void RLIDisplayWidget::updateLayers() {
+  // Radar samples are drawn one per pixel
+  if (_tracker != nullptr)
+    _tracker->setGeometry(_state.ship_position, _state.ship_course, _state.ship_speed, _state.chart_scale, _state.north_shift);
+
   _radarEngine->updateTexture(_state);
-  _tailsEngine->updateTexture(_state);
+  if (_trails->isEnabled())
+    _tailsEngine->updateTexture(_state);
 
   QString colorScheme = _chart_mngr.refs()->getColorScheme();
   _chartEngine->update(_state, colorScheme);
+  _trgtEngine->update();
+
+  // Тревога по зоне захвата
+  double scale = _state.chart_scale;
+  int intruders = _trgtEngine->countInSector( _state.ship_position
+                                            , _state.capt_min_rad * scale, _state.capt_max_rad * scale
+                                            , _state.capt_min_angle, _state.capt_max_angle );
+  _infoEngine->onGuardZoneAlarm(intruders > 0);
+
   _infoEngine->update(_infoFonts);
   _menuEngine->update();
   _maskEngine->update(_state, _layout_manager.layout()->circle, false);
 
   if (_state.state == RLIWidgetState::MAGNIFIER)
-    _magnEngine->update(_state);
+    _magnEngine->update(_state, _radarEngine->amplitudes(), _radarEngine->pelengCount(), _radarEngine->pelengLength());
 }
 
 
@@ -456,7 +593,116 @@ void RLIDisplayWidget::drawRect(const QRectF& rect, GLuint textureId) {
 
 
 
+void RLIDisplayWidget::onRadarData(int offset, int count, GLfloat* amps) {
+  if (!_frozen)
+    _radarEngine->updateData(offset, count, amps);
+}
+
+void RLIDisplayWidget::freezeRadar() {
+  _frozen = true;
+  _frozen_serial = -1;
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar frozen," << _history->count() << "revolutions in history";
+}
+
+// The engine takes the latest data of every peleng, the live video continues from there
+void RLIDisplayWidget::unfreezeRadar() {
+  _replay_timer.stop();
+  _frozen = false;
+  _frozen_serial = -1;
+
+  _history_frame.resize(static_cast<size_t>(_radarEngine->pelengCount()) * _radarEngine->pelengLength());
+  _history->decodeLatest(_history_frame.data());
+  _radarEngine->updateData(0, _radarEngine->pelengCount(), _history_frame.data());
+  requestFrame(FrameScheduler::RADAR_DATA);
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "Radar live";
+}
+
+void RLIDisplayWidget::stepHistory(int step) {
+  if (_history->isEmpty())
+    return;
+
+  _replay_timer.stop();
+  if (!_frozen)
+    freezeRadar();
+
+  // The freeze moment is after the last complete revolution
+  qint64 serial = _frozen_serial < 0 ? _history->lastSerial() + 1 : _frozen_serial;
+  serial = qBound(_history->firstSerial(), serial + step, _history->lastSerial());
+
+  showRevolution(serial);
+}
+
+void RLIDisplayWidget::showRevolution(qint64 serial) {
+  int pel_count = _radarEngine->pelengCount();
+  _history_frame.resize(static_cast<size_t>(pel_count) * _radarEngine->pelengLength());
+
+  if (!_history->decode(serial, 0, pel_count, _history_frame.data()))
+    return;
+
+  _frozen_serial = serial;
+  _radarEngine->updateData(0, pel_count, _history_frame.data());
+  requestFrame(FrameScheduler::RADAR_DATA);
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": "
+           << "Radar revolution" << serial - _history->lastSerial() << "of" << _history->count()
+           << ":" << _history->revolutionBytes(serial) / 1024 << "KB";
+}
+
+void RLIDisplayWidget::startReplay() {
+  if (_history->isEmpty())
+    return;
+
+  if (!_frozen)
+    freezeRadar();
+
+  _replay_serial = _history->firstSerial();
+  _replay_peleng = 0;
+  _replay_clock.start();
+  _history_frame.resize(static_cast<size_t>(_radarEngine->pelengCount()) * _radarEngine->pelengLength());
+  _replay_timer.start();
+}
+
+// Sends the pelengs the radar would have sent since the last tick, after the newest revolution goes live
+void RLIDisplayWidget::onReplayTimer() {
+  int pel_count = _radarEngine->pelengCount();
+  int pel_len = _radarEngine->pelengLength();
+
+  // Old revolutions are dropped by the history while the replay goes on
+  if (_replay_serial < _history->firstSerial()) {
+    _replay_serial = _history->firstSerial();
+    _replay_peleng = 0;
+    _replay_clock.restart();
+  }
+
+  qint64 msecs = qMax<qint64>(1, _history->revolutionMsecs(_replay_serial));
+  int target = static_cast<int>(qMin<qint64>(pel_count, _replay_clock.elapsed() * pel_count / msecs));
+
+  if (target > _replay_peleng) {
+    GLfloat* frame = _history_frame.data() + static_cast<size_t>(_replay_peleng) * pel_len;
+    _history->decode(_replay_serial, _replay_peleng, target - _replay_peleng, frame);
+    _radarEngine->updateData(_replay_peleng, target - _replay_peleng, frame);
+    _replay_peleng = target;
+    _frozen_serial = _replay_serial;
+    requestFrame(FrameScheduler::RADAR_DATA);
+  }
+
+  if (_replay_peleng < pel_count)
+    return;
+
+  if (++_replay_serial > _history->lastSerial()) {
+    unfreezeRadar();
+    return;
+  }
+
+  _replay_peleng = 0;
+  _replay_clock.restart();
+}
+
+
 void RLIDisplayWidget::onShipStateChanged(const RLIShipState& sst) {
+  requestFrame(FrameScheduler::SHIP);
+
   _state.ship_position  = sst.position;
   _state.ship_course    = sst.course;
   _state.ship_speed     = sst.speed;
@@ -471,6 +717,8 @@ void RLIDisplayWidget::onShipStateChanged(const RLIShipState& sst) {
 
 
 void RLIDisplayWidget::mouseMoveEvent(QMouseEvent* event) {
+  requestFrame(FrameScheduler::INPUT);
+
   auto diff = event->pos() - _layout_manager.layout()->circle.center;
   QVector2D diffV(diff);
   if (diffV.length() < 0.66f * _layout_manager.layout()->circle.radius)
@@ -485,6 +733,8 @@ void RLIDisplayWidget::mouseMoveEvent(QMouseEvent* event) {
 }
 
 void RLIDisplayWidget::mousePressEvent(QMouseEvent* event) {
+  requestFrame(FrameScheduler::INPUT);
+
   auto coords = RLIMath::pos_to_coords( _state.ship_position
                                       , _layout_manager.layout()->circle.center
                                       , event->pos()
@@ -494,28 +744,73 @@ void RLIDisplayWidget::mousePressEvent(QMouseEvent* event) {
 
 
 
+// Захват: the tracker starts a track at the cursor and takes the nearest plot
+void RLIDisplayWidget::acquireTarget() {
+  if (_tracker == nullptr)
+    return;
+
+  QPointF cursor = _state.cursor_pos - _state.center_shift;
+  GeoPos coords = RLIMath::pos_to_coords(_state.ship_position, QPointF(0, 0), cursor, _state.chart_scale);
+
+  QMetaObject::invokeMethod( _tracker, "acquire", Qt::QueuedConnection
+                           , Q_ARG(double, coords.lat), Q_ARG(double, coords.lon) );
+}
+
+
+void RLIDisplayWidget::onTailsModeChanged(RLIString mode) {
+  requestFrame(FrameScheduler::INPUT);
+
+  int minutes = 1;
+
+  switch (mode) {
+  case RLI_STR_ARRAY_TRACK_2:   minutes = 2;  break;
+  case RLI_STR_ARRAY_TRACK_3:   minutes = 3;  break;
+  case RLI_STR_ARRAY_TRACK_6:   minutes = 6;  break;
+  case RLI_STR_ARRAY_TRACK_12:  minutes = 12; break;
+  default:                      break;
+  }
+
+  _trgtEngine->onTailsModeChanged(1, minutes);
+  _infoEngine->onTailsChanged(minutes);
+}
+
 void RLIDisplayWidget::onGainChanged(float value) {
+  requestFrame(FrameScheduler::INPUT);
+
   _infoEngine->updateGain(_state.gain = value);
+  updateVideoProcessing();
 }
 
 void RLIDisplayWidget::onWaterChanged(float value) {
+  requestFrame(FrameScheduler::INPUT);
+
   _infoEngine->updateWater(_state.water = value);
+  updateVideoProcessing();
 }
 
 void RLIDisplayWidget::onRainChanged(float value) {
+  requestFrame(FrameScheduler::INPUT);
+
   _infoEngine->updateRain(_state.rain = value);
+  updateVideoProcessing();
 }
 
 void RLIDisplayWidget::onApchChanged(float value) {
+  requestFrame(FrameScheduler::INPUT);
+
   _infoEngine->updateApch(_state.apch = value);
 }
 
 void RLIDisplayWidget::onEmissionChanged(float value) {
+  requestFrame(FrameScheduler::INPUT);
+
   _infoEngine->updateEmission(_state.emission = value);
 }
 
 
 void RLIDisplayWidget::onRouteEditionStarted() {
+  requestFrame(FrameScheduler::INPUT);
+
   _routeEngine->clearCurrentRoute();
   _routeEngine->addPointToCurrent(_state.ship_position);
   _state.visir_center_pos = _state.ship_position;
@@ -523,6 +818,8 @@ void RLIDisplayWidget::onRouteEditionStarted() {
 }
 
 void RLIDisplayWidget::onRouteEditionFinished() {
+  requestFrame(FrameScheduler::INPUT);
+
   _state.state = RLIWidgetState::MAIN_MENU;
 }
 
@@ -534,6 +831,8 @@ void RLIDisplayWidget::keyReleaseEvent(QKeyEvent *event) {
 
 
 void RLIDisplayWidget::keyPressEvent(QKeyEvent* event) {
+  requestFrame(FrameScheduler::INPUT);
+
   pressedKeys.insert(event->key());
   auto mod_keys = event->modifiers();
 
@@ -553,6 +852,7 @@ void RLIDisplayWidget::keyPressEvent(QKeyEvent* event) {
     if (mod_keys & Qt::ShiftModifier)
       emit _infoEngine->updateRain(  _state.rain = qMin(_state.rain + 5.0f, 255.0f) );
 
+    updateVideoProcessing();
     break;
 
   case Qt::Key_PageDown:
@@ -565,10 +865,13 @@ void RLIDisplayWidget::keyPressEvent(QKeyEvent* event) {
     if (mod_keys & Qt::ShiftModifier)
       emit _infoEngine->updateRain( _state.rain = qMax(_state.rain - 5.0f, 0.0f) );
 
+    updateVideoProcessing();
     break;
 
   // Под. имп. Помех
   case Qt::Key_S:
+    _state.interference_rejection = !_state.interference_rejection;
+    updateVideoProcessing();
     break;
 
   // Меню
@@ -632,13 +935,15 @@ void RLIDisplayWidget::keyPressEvent(QKeyEvent* event) {
 
   // Следы точки
   case Qt::Key_T:
+    // Длительность следов: 2, 4, 8, 16 оборотов
+    _trails->setRevolutions(_trails->revolutions() >= 16 ? 2 : 2*_trails->revolutions());
     break;
 
   // Выбор цели
   case Qt::Key_Up:
     if (mod_keys & Qt::ControlModifier) {
       //_state.ship_position.lat += 0.010;
-      if (_state.magn_min_rad + _state.magn_height < 800) {
+      if (_state.magn_min_rad + _state.magnRadii() < _radarEngine->pelengLength()) {
         _state.magn_min_rad += 1;
       }
     } else {
@@ -691,6 +996,7 @@ void RLIDisplayWidget::keyPressEvent(QKeyEvent* event) {
   // Захват
   case Qt::Key_Return:
   case Qt::Key_Enter:
+    acquireTarget();
     break;
 
   //Сброс
@@ -720,6 +1026,9 @@ void RLIDisplayWidget::keyPressEvent(QKeyEvent* event) {
 
   //Накоп. Видео
   case Qt::Key_V:
+    _trails->setEnabled(!_trails->isEnabled());
+    _tailsEngine->clearData();
+    _tailsEngine->clearTexture();
     break;
 
   //Сброс АС
@@ -765,8 +1074,26 @@ void RLIDisplayWidget::keyPressEvent(QKeyEvent* event) {
   case Qt::Key_G:
     break;
 
-  //Стоп-кадр
+  // Масштаб лупы: 1/2, 1, 2, 4 пикселя на отсчёт, Shift - билинейная интерполяция
+  case Qt::Key_Z:
+    if (mod_keys & Qt::ShiftModifier)
+      _state.magn_bilinear = !_state.magn_bilinear;
+    else
+      _state.magn_zoom = _state.magn_zoom >= MagnifierEngine::MAX_ZOOM ? MagnifierEngine::MIN_ZOOM : _state.magn_zoom + 1;
+    break;
+
+  // Стоп-кадр, Shift - обзор назад, Ctrl - обзор вперёд, Alt - повтор сохранённых обзоров
   case Qt::Key_F:
+    if (mod_keys & Qt::ShiftModifier)
+      stepHistory(-1);
+    else if (mod_keys & Qt::ControlModifier)
+      stepHistory(1);
+    else if (mod_keys & Qt::AltModifier)
+      startReplay();
+    else if (_frozen)
+      unfreezeRadar();
+    else
+      freezeRadar();
     break;
 
   //Откл. Звука
@@ -2,6 +2,9 @@
 #define RLIDISPLAYWIDGET_H
 
 #include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QThread>
 #include <QWidget>
 #include <QMouseEvent>
 
@@ -13,12 +16,18 @@
 
 #include "common/rlilayout.h"
 #include "common/rlistate.h"
+#include "common/framescheduler.h"
 
 #include "datasources/radardatasource.h"
 #include "datasources/shipdatasource.h"
 #include "datasources/targetdatasource.h"
 
+#include "processing/radarvideoprocessor.h"
+#include "processing/radartracker.h"
+
 #include "layers/radar/radarengine.h"
+#include "layers/radar/radartrails.h"
+#include "layers/radar/radarhistory.h"
 #include "layers/chart/chartengine.h"
 #include "layers/info/infoengine.h"
 #include "layers/info/menuengine.h"
@@ -37,7 +46,8 @@ public:
 
   float frameRate();
 
-  void setupRadarDataSource(RadarDataSource* rds);
+  void setupRadarProcessor(RadarVideoProcessor* proc);
+  void setupTracker(RadarTracker* tracker);
   void setupTargetDataSource(TargetDataSource* tds);
   void setupShipDataSource(ShipDataSource* sds);
 
@@ -65,27 +75,43 @@ private slots:
   void onNewChartAvailable(const QString& name);
 
   void onShipStateChanged(const RLIShipState& sst);
+  void onTailsModeChanged(RLIString mode);
 
   void onRouteEditionStarted();
   void onRouteEditionFinished();
 
+  void onRadarData(int offset, int count, GLfloat* amps);
+  void onReplayTimer();
+
 private:
   QSet<int> pressedKeys;
 
   bool _initialized = false;
+  bool _first_frame_traced = false;
+  bool _startup_traced = false;
 
   QMutex frameRateMutex;
   QQueue<QDateTime> frameTimes;
 
   void debugInfo();
   void initShaders();
-  void initModeTextures(const QString& path);
+  static QMap<char, QImage> loadModeImages(const QString& path);
+  void initModeTextures(const QMap<char, QImage>& images);
 
   void paintLayers();
   void updateLayers();
+  void updateVideoProcessing();
 
   void drawRect(const QRectF& rect, GLuint textureId);
 
+  void acquireTarget();
+
+  void freezeRadar();
+  void unfreezeRadar();
+  void stepHistory(int step);
+  void startReplay();
+  void showRevolution(qint64 serial);
+
   RLIState _state;
 
   ChartManager     _chart_mngr      { this };
@@ -96,6 +122,8 @@ private:
   MaskEngine*       _maskEngine;
   RadarEngine*      _radarEngine;
   RadarEngine*      _tailsEngine;
+  RadarTrails*      _trails;
+  RadarHistory*     _history;
   ChartEngine*      _chartEngine;
   InfoEngine*       _infoEngine;
   MenuEngine*       _menuEngine;
@@ -104,6 +132,30 @@ private:
   ControlsEngine*   _ctrlEngine;
   MagnifierEngine*  _magnEngine;
 
+  RadarVideoProcessor* _radarProc = nullptr;
+
+  RadarTracker* _tracker = nullptr;
+
+  // Стоп-кадр: live video stops going to _radarEngine, the picture stays
+  // or is taken from _history. Serial -1 is the picture at the freeze moment
+  bool _frozen = false;
+  qint64 _frozen_serial = -1;
+  std::vector<GLfloat> _history_frame;
+
+  // Replay of stored revolutions at the speed they were received
+  QTimer _replay_timer;
+  QElapsedTimer _replay_clock;
+  qint64 _replay_serial = -1;
+  int _replay_peleng = 0;
+
+  // Кадры рисуются только при изменениях
+  FrameScheduler* _scheduler = nullptr;
+  bool layersChanged();
+  inline void requestFrame(int reasons) { if (_scheduler != nullptr) _scheduler->request(reasons); }
+
+  // Карта рисуется в отдельном потоке
+  QThread _chart_thread;
+
   QMap<char, QOpenGLTexture*> _mode_textures;
 
   QOpenGLShaderProgram* _program;
@@ -4,10 +4,30 @@
 #include <QDebug>
 #include <QDir>
 
+#include <QElapsedTimer>
 #include <QtConcurrentRun>
 
+#include "s52pack.h"
+#include "../common/startuptrace.h"
+
 ChartManager::ChartManager(QObject *parent) : QObject(parent) {
-  _s52_refs = new S52References(":/s52/chartsymbols.xml");
+  StartupTrace::Span span("S52 references");
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // The pack made by tools/s52pack is used if it exists, it also has the texture atlases
+  S52Pack* pack = new S52Pack();
+  if (pack->open("data/s52.pack")) {
+    _s52_refs = new S52References(pack);
+  } else {
+    delete pack;
+    _s52_refs = new S52References(":/s52/chartsymbols.xml");
+  }
+
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "S52 references loaded in"
+           << timer.elapsed() << "ms" << ((_s52_refs->pack() != nullptr) ? "from pack" : "from xml");
+
  // _s52_refs->print();
   _s52_refs->setColorScheme("DAY_BRIGHT");
 }
@@ -39,7 +59,9 @@ void ChartManager::chartLoadingWorker() {
       c_chart_path[j] = chart_path[j].toLatin1();
     c_chart_path[chart_path.size()] = '\0';
 
+    qint64 chart_begin = StartupTrace::now();
     S52::Chart* chart = new S52::Chart(c_chart_path, _s52_refs);
+    StartupTrace::record("Chart " + fileList[i], chart_begin, StartupTrace::now());
 
     _charts.insert(fileList[i], chart);
     delete[] c_chart_path;
@@ -1,48 +1,20 @@
 #include "s52assets.h"
 
 #include <QDir>
-#include <QGLWidget>
 #include <QStringList>
 
 #include <QFontDatabase>
-#include <QGraphicsTextItem>
 #include <QTextCodec>
-#include <QPixmap>
 #include <QPainter>
 #include <QRectF>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QDebug>
 
-
-S52Assets::S52Assets(QOpenGLContext* context, S52References* ref) : QOpenGLFunctions(context) {
-  initializeOpenGLFunctions();    
-
-  initFontTexture();
-
-  initColorSchemeTextures(ref);
-
-  initPatternTextures(ref);
-  initLineTextures(ref);
-  initSymbolTextures(ref);
-}
-
-S52Assets::~S52Assets() {
-  /*font_texture->destroy();
-
-  for (QOpenGLTexture* tex : pattern_textures)
-    tex->destroy();
-
-  for (QOpenGLTexture* tex : line_textures)
-    tex->destroy();
-
-  for (QOpenGLTexture* tex : symbol_textures)
-    tex->destroy();
-
-  for (QOpenGLTexture* tex : color_scheme_textures)
-    tex->destroy();*/
-}
+#include "s52pack.h"
 
 
-void S52Assets::initFontTexture() {
+static QImage fontImage() {
   QImage img(16*16, 16*16, QImage::Format_ARGB32);
 
   int id = QFontDatabase::addApplicationFont(":/fonts/Helvetica.ttf");
@@ -66,136 +38,149 @@ void S52Assets::initFontTexture() {
   for (int i = 0; i < 256; i++)
     painter.drawText(QRect(16 * (i % 16), 16 * (i / 16), 16.f, 16.f), Qt::AlignCenter, uchars.at(i));
 
+  painter.end();
+  delete dec;
+  return img;
+}
 
-  font_texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+static QStringList patternFiles(const QString& path, const QString& ex_path) {
+  QDir png_dir(path);
+  QDir ex_png_dir(ex_path);
 
-  font_texture->setMipLevels(1);
-  font_texture->setMinificationFilter(QOpenGLTexture::Nearest);
-  font_texture->setMagnificationFilter(QOpenGLTexture::Nearest);
-  font_texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+  QStringList files;
+  for (QString fileName : png_dir.entryList(QStringList() << "*.png"))
+    files << png_dir.absoluteFilePath(fileName);
 
-  font_texture->setData(img, QOpenGLTexture::DontGenerateMipMaps);
-}
+  if (ex_path != "")
+    for (QString fileName : ex_png_dir.entryList(QStringList() << "*.png"))
+      files << ex_png_dir.absoluteFilePath(fileName);
 
+  return files;
+}
 
-void S52Assets::initColorSchemeTextures(S52References* ref) {
-  QStringList color_scheme_names = ref->getColorSchemeNames();
-  int colors_count = ref->getColorsCount();
+// Images of all the color schemes get one layout: a pattern takes the same place
+// in each of them, the place fits the largest version of the pattern.
+// So chart vertex data doesn't depend on the color scheme and a scheme change is a texture swap
+static void filesToPatternImages(const QMap<QString, QStringList>& scheme_files, QMap<QString, QImage>& images
+                                , QMap<QString, QPoint>& locations, QMap<QString, QSize>& sizes) {
+  QMap<QString, QMap<QString, QImage>> patterns;
+
+  // Load images from files to patterns map, fill sizes
+  for (QString scheme : scheme_files.keys()) {
+    for (QString fName : scheme_files[scheme]) {
+      QString pat_name = fName.right(fName.length() - fName.lastIndexOf("/") - 1).replace(".png", "");
+      QImage pattern = QImage(fName);
+
+      sizes.insert(pat_name, sizes.value(pat_name, QSize(0, 0)).expandedTo(pattern.size()));
+      patterns[scheme].insert(pat_name, pattern);
+    }
+  }
 
-  for (QString scheme : color_scheme_names) {
-    ColorTable* c_tbl = ref->getColorTable(scheme);
+  // Common layout
+  int total_width = 0;
+  int max_height  = 0;
 
-    QImage img(1, colors_count, QImage::Format_RGB888);
-    for (QString color_tag : c_tbl->colors.keys())
-      img.setPixel(0, ref->getColorIndex(color_tag), c_tbl->colors[color_tag].rgb());
+  for (QString pat_name : sizes.keys()) {
+    locations.insert(pat_name, QPoint(total_width, 0));
 
-    QOpenGLTexture* tex = new QOpenGLTexture(QOpenGLTexture::Target2D);
+    total_width += sizes[pat_name].width();
+    if (sizes[pat_name].height() > max_height)
+      max_height = sizes[pat_name].height();
+  }
 
-    tex->setMipLevels(1);
-    tex->setMinificationFilter(QOpenGLTexture::Nearest);
-    tex->setMagnificationFilter(QOpenGLTexture::Nearest);
-    tex->setWrapMode(QOpenGLTexture::ClampToEdge);
+  // Combine patterns of each scheme to a single image according to locations
+  for (QString scheme : scheme_files.keys()) {
+    QImage img(total_width, max_height, QImage::Format_ARGB32);
+    QPainter painter(&img);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(img.rect(), Qt::transparent);
 
-    tex->setData(img, QOpenGLTexture::DontGenerateMipMaps);
+    const QMap<QString, QImage>& scheme_patterns = patterns[scheme];
+    for (QString pat_name : scheme_patterns.keys())
+      painter.drawImage(QRect(locations[pat_name], scheme_patterns[pat_name].size()), scheme_patterns[pat_name]);
 
-    color_scheme_textures.insert(scheme, tex);
+    painter.end();
+    images.insert(scheme, img);
   }
 }
 
-#include <QDebug>
+void S52AssetImages::build(S52References* ref) {
+  font = fontImage();
 
-QOpenGLTexture* S52Assets::dirToPatternTex(const QString& path, const QString& ex_path, QMap<QString, QPoint>& locations, QMap<QString, QSize>& sizes) {
-  QDir png_dir(path);
-  QDir ex_png_dir(ex_path);
-  QMap<QString, QImage> patterns;
+  QMap<QString, QStringList> pattern_files;
+  QMap<QString, QStringList> line_files;
 
-  int total_width = 0;
-  int max_height  = 0;
+  QString ex_dir_path = "data/textures/charts/lines/simple";
+  for (QString scheme : ref->getColorSchemeNames()) {
+    pattern_files.insert(scheme, patternFiles("data/textures/charts/patterns/" + scheme.toLower(), ""));
+    line_files.insert(scheme, patternFiles("data/textures/charts/lines/" + scheme.toLower(), ex_dir_path));
+  }
 
-  QStringList files;
-  for (QString fileName : png_dir.entryList(QStringList() << "*.png"))
-    files << png_dir.absoluteFilePath(fileName);
+  filesToPatternImages(pattern_files, patterns, pattern_locations, pattern_sizes);
+  filesToPatternImages(line_files, lines, line_locations, line_sizes);
 
-  if (ex_path != "")
-    for (QString fileName : ex_png_dir.entryList(QStringList() << "*.png"))
-      files << ex_png_dir.absoluteFilePath(fileName);
+  for (QString scheme : ref->getColorSchemeNames()) {
+    QString file_name = ref->getGraphicsFileName(scheme);
 
-  // Load images from files to patterns map, fill locations and sizes
-  for (QString fName : files) {
-    QString pat_name = fName.right(fName.length() - fName.lastIndexOf("/") - 1).replace(".png", "");
-    QImage pattern = QImage(fName);
+    graphic_files.insert(scheme, file_name);
 
-    locations.insert(pat_name, QPoint(total_width, 0));
-    sizes.insert(pat_name, pattern.size());
+    if (!symbols.contains(file_name))
+      symbols.insert(file_name, QImage("data/textures/charts/symbols/" + file_name));
+  }
+}
 
-    total_width += pattern.width();
-    if (pattern.height() > max_height)
-      max_height = pattern.height();
 
-    patterns.insert(pat_name, pattern);
-  }
+S52Assets::S52Assets(QOpenGLContext* context, S52References* ref) : QOpenGLFunctions(context) {
+  initializeOpenGLFunctions();
 
-  // Combine patterns to a single image according to locations
-  QImage img(total_width, max_height, QImage::Format_ARGB32);
-  QPainter painter(&img);
-  painter.setCompositionMode(QPainter::CompositionMode_Source);
-  painter.fillRect(img.rect(), Qt::transparent);
+  QElapsedTimer timer;
+  timer.start();
 
-  for (QString pat_name : patterns.keys())
-    painter.drawImage(QRect(locations[pat_name], sizes[pat_name]), patterns[pat_name]);
+  // Images of a pack are used right from the mapped file
+  S52AssetImages built;
+  const S52AssetImages* images = &built;
 
-  // Create OpenGL texture using combined image
-  QOpenGLTexture* tex = new QOpenGLTexture(QOpenGLTexture::Target2D);
+  if (ref->pack() != nullptr)
+    images = &ref->pack()->images();
+  else
+    built.build(ref);
 
-  tex->setMipLevels(1);
-  tex->setMinificationFilter(QOpenGLTexture::Nearest);
-  tex->setMagnificationFilter(QOpenGLTexture::Nearest);
-  tex->setWrapMode(QOpenGLTexture::Repeat);
+  initColorSchemeTextures(ref);
+  initTextures(*images);
 
-  tex->setData(img, QOpenGLTexture::DontGenerateMipMaps);
-  return tex;
+  qDebug() << QDateTime::currentDateTime().toString("hh:mm:ss zzz") << ": " << "S52 assets ready in"
+           << timer.elapsed() << "ms" << ((ref->pack() != nullptr) ? "from pack" : "from data files");
 }
 
-void S52Assets::initPatternTextures(S52References* ref) {
-  for (QString scheme : ref->getColorSchemeNames()) {
-    QMap<QString, QPoint> locations;
-    QMap<QString, QSize> sizes;
-
-    QString dir_path = "data/textures/charts/patterns/" + scheme.toLower();
-    QOpenGLTexture* tex = dirToPatternTex(dir_path, "", locations, sizes);
+S52Assets::~S52Assets() {
+  /*font_texture->destroy();
 
-    pattern_textures.insert(scheme, tex);
-    pat_lc.insert(scheme, locations);
-    pat_sz.insert(scheme, sizes);
-  }
-}
+  for (QOpenGLTexture* tex : pattern_textures)
+    tex->destroy();
 
-void S52Assets::initLineTextures(S52References* ref) {
-  for (QString scheme : ref->getColorSchemeNames()) {
-    QMap<QString, QPoint> locations;
-    QMap<QString, QSize> sizes;
+  for (QOpenGLTexture* tex : line_textures)
+    tex->destroy();
 
-    QString dir_path = "data/textures/charts/lines/" + scheme.toLower();
-    QString ex_dir_path = "data/textures/charts/lines/simple";
-    QOpenGLTexture* tex = dirToPatternTex(dir_path, ex_dir_path, locations, sizes);
+  for (QOpenGLTexture* tex : symbol_textures)
+    tex->destroy();
 
-    line_textures.insert(scheme, tex);
-    line_lc.insert(scheme, locations);
-    line_sz.insert(scheme, sizes);
-  }
+  for (QOpenGLTexture* tex : color_scheme_textures)
+    tex->destroy();*/
 }
 
-void S52Assets::initSymbolTextures(S52References* ref) {
-  for (QString scheme : ref->getColorSchemeNames()) {
-    QString file_name = ref->getGraphicsFileName(scheme);
 
-    graphic_files.insert(scheme, file_name);
+void S52Assets::initColorSchemeTextures(S52References* ref) {
+  QStringList color_scheme_names = ref->getColorSchemeNames();
+  int colors_count = ref->getColorsCount();
 
-    if (symbol_textures.contains(file_name))
-      continue;
+  for (QString scheme : color_scheme_names) {
+    ColorTable* c_tbl = ref->getColorTable(scheme);
+
+    QImage img(1, colors_count, QImage::Format_RGB888);
+    for (QString color_tag : c_tbl->colors.keys())
+      img.setPixel(0, ref->getColorIndex(color_tag), c_tbl->colors[color_tag].rgb());
 
     QOpenGLTexture* tex = new QOpenGLTexture(QOpenGLTexture::Target2D);
-    QImage img("data/textures/charts/symbols/" + file_name);
 
     tex->setMipLevels(1);
     tex->setMinificationFilter(QOpenGLTexture::Nearest);
@@ -203,6 +188,38 @@ void S52Assets::initSymbolTextures(S52References* ref) {
     tex->setWrapMode(QOpenGLTexture::ClampToEdge);
 
     tex->setData(img, QOpenGLTexture::DontGenerateMipMaps);
-    symbol_textures.insert(file_name, tex);
+
+    color_scheme_textures.insert(scheme, tex);
   }
 }
+
+
+QOpenGLTexture* S52Assets::imageToTexture(const QImage& img, QOpenGLTexture::WrapMode wrap) {
+  QOpenGLTexture* tex = new QOpenGLTexture(QOpenGLTexture::Target2D);
+
+  tex->setMipLevels(1);
+  tex->setMinificationFilter(QOpenGLTexture::Nearest);
+  tex->setMagnificationFilter(QOpenGLTexture::Nearest);
+  tex->setWrapMode(wrap);
+
+  tex->setData(img, QOpenGLTexture::DontGenerateMipMaps);
+  return tex;
+}
+
+void S52Assets::initTextures(const S52AssetImages& images) {
+  font_texture = imageToTexture(images.font, QOpenGLTexture::ClampToEdge);
+
+  for (QString scheme : images.patterns.keys())
+    pattern_textures.insert(scheme, imageToTexture(images.patterns[scheme], QOpenGLTexture::Repeat));
+  pat_lc = images.pattern_locations;
+  pat_sz = images.pattern_sizes;
+
+  for (QString scheme : images.lines.keys())
+    line_textures.insert(scheme, imageToTexture(images.lines[scheme], QOpenGLTexture::Repeat));
+  line_lc = images.line_locations;
+  line_sz = images.line_sizes;
+
+  graphic_files = images.graphic_files;
+  for (QString file_name : images.symbols.keys())
+    symbol_textures.insert(file_name, imageToTexture(images.symbols[file_name], QOpenGLTexture::ClampToEdge));
+}
@@ -5,10 +5,32 @@
 #include <QOpenGLTexture>
 
 #include <QVector2D>
+#include <QImage>
 #include <QMap>
 
 #include "s52references.h"
 
+// Images of the S52 assets, built from the data files without GL or read from a pack
+struct S52AssetImages {
+  QImage                                  font;
+
+  // Textures of all the color schemes have one layout
+  QMap<QString, QImage>                   patterns;           // by color scheme
+  QMap<QString, QPoint>                   pattern_locations;
+  QMap<QString, QSize>                    pattern_sizes;
+
+  QMap<QString, QImage>                   lines;              // by color scheme
+  QMap<QString, QPoint>                   line_locations;
+  QMap<QString, QSize>                    line_sizes;
+
+  QMap<QString, QString>                  graphic_files;      // by color scheme
+  QMap<QString, QImage>                   symbols;            // by graphic file
+
+  // Reads data/textures/charts and draws the font
+  void build(S52References* ref);
+};
+
+
 class S52Assets : protected QOpenGLFunctions
 {
 public:
@@ -21,38 +43,35 @@ public:
 
   // Returns patterns texture id for the color scheme
   inline QOpenGLTexture* getAreaPatternTex  (const QString& s)                    { return pattern_textures[s]; }
-  // Returns pattern's left-top pixel location in patterns texture, s - color scheme, n - pattern tag
-  inline QPoint getAreaPatternLocation      (const QString& s, const QString& n)  { return pat_lc[s].value(n, QPoint(-1, -1)); }
+  // Returns pattern's left-top pixel location in patterns texture, n - pattern tag.
+  // Pattern textures of all the color schemes have the same layout
+  inline QPoint getAreaPatternLocation      (const QString& n) const              { return pat_lc.value(n, QPoint(-1, -1)); }
   // Returns size of the pattern
-  inline QSize getAreaPatternSize           (const QString& s, const QString& n)  { return pat_sz[s].value(n, QSize(0, 0)); }
+  inline QSize getAreaPatternSize           (const QString& n) const              { return pat_sz.value(n, QSize(0, 0)); }
 
   inline QOpenGLTexture* getLinePatternTex  (const QString& s)                    { return line_textures[s]; }
-  inline QPoint getLinePatternLocation      (const QString& s, const QString& n)  { return line_lc[s].value(n, QPoint(-1, -1)); }
-  inline QSize getLinePatternSize           (const QString& s, const QString& n)  { return line_sz[s].value(n, QSize(0, 0)); }
+  inline QPoint getLinePatternLocation      (const QString& n) const              { return line_lc.value(n, QPoint(-1, -1)); }
+  inline QSize getLinePatternSize           (const QString& n) const              { return line_sz.value(n, QSize(0, 0)); }
 
   inline QOpenGLTexture* getSymbolTex       (const QString& s)                    { return symbol_textures[graphic_files[s]]; }
 
 private:
-  void initFontTexture();
-
   void initColorSchemeTextures(S52References* ref);
-  void initPatternTextures(S52References* ref);
-  void initLineTextures(S52References* ref);
-  void initSymbolTextures(S52References* ref);
+  void initTextures(const S52AssetImages& images);
 
-  QOpenGLTexture* dirToPatternTex(const QString& path, const QString& ex_path, QMap<QString, QPoint>& locations,  QMap<QString, QSize>& sizes);
+  QOpenGLTexture* imageToTexture(const QImage& img, QOpenGLTexture::WrapMode wrap);
 
   QOpenGLTexture*                         font_texture;
 
   QMap<QString, QOpenGLTexture*>          color_scheme_textures;
 
   QMap<QString, QOpenGLTexture*>          pattern_textures;
-  QMap<QString, QMap<QString, QPoint>>    pat_lc;
-  QMap<QString, QMap<QString, QSize>>     pat_sz;
+  QMap<QString, QPoint>                   pat_lc;
+  QMap<QString, QSize>                    pat_sz;
 
   QMap<QString, QOpenGLTexture*>          line_textures;
-  QMap<QString, QMap<QString, QPoint>>    line_lc;
-  QMap<QString, QMap<QString, QSize>>     line_sz;
+  QMap<QString, QPoint>                   line_lc;
+  QMap<QString, QSize>                    line_sz;
 
   QMap<QString, QString>                  graphic_files;
   QMap<QString, QOpenGLTexture*>          symbol_textures;
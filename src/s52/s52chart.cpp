@@ -15,6 +15,30 @@ using namespace S52;
 
 #define EQUAL_EPS 0.00000001
 
+int NameTable::intern(const QString& name) {
+  auto it = _ids.find(name);
+  if (it != _ids.end())
+    return it.value();
+
+  int id = static_cast<int>(_names.size());
+  _names.push_back(name);
+  _ids.insert(name, id);
+  return id;
+}
+
+// Arguments of a rasterization rule, "SY(CHINFO06)" -> "CHINFO06"
+static inline QString ruleArgs(const QString& instr) {
+  int from = instr.indexOf('(') + 1;
+  int to = instr.lastIndexOf(')');
+  return instr.mid(from, (to < from) ? -1 : to - from);
+}
+
+template <typename T>
+static inline void clearLayerVector(std::vector<T>& v, size_t reserve) {
+  v.clear();
+  v.reserve(reserve);
+}
+
 Chart::Chart(char* file_name, S52References* ref) {
   isOk = false;
   _ref = ref;
@@ -88,13 +112,21 @@ Chart::Chart(char* file_name, S52References* ref) {
     poLayer->ResetReading();
     if (!readLayer(poLayer, ref, poDS)) {
       qDebug() << "Failed reading layer " + layer_name;
+      releaseArena();
       return;
     }
   }
 
+  releaseArena();
   isOk = true;
 }
 
+void Chart::releaseArena() {
+  _area_arena = AreaLayer();
+  _line_arena = LineLayer();
+  _mark_arena = MarkLayer();
+}
+
 
 Chart::~Chart() {
   clear();
@@ -170,6 +202,9 @@ void Chart::clear() {
   for (int i = 0; i < mark_layers.keys().size(); i++)
     delete mark_layers[mark_layers.keys()[i]];
 
+  for (int i = 0; i < text_layers.keys().size(); i++)
+    delete text_layers[text_layers.keys()[i]];
+
   delete sndg_layer;
 }
 
@@ -227,9 +262,30 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
 
   OGRFeature* poFeature = nullptr;
 
-  AreaLayer* area_layer = new AreaLayer();
-  LineLayer* line_layer = new LineLayer();
-  MarkLayer* mark_layer = new MarkLayer();
+  // Per feature vectors are reserved by the feature count if the driver knows it cheaply,
+  // geometry vectors keep the capacity reached by previous layers
+  GIntBig feature_count = poLayer->GetFeatureCount(FALSE);
+  size_t features = feature_count > 0 ? static_cast<size_t>(feature_count) : 0;
+
+  AreaLayer* area_layer = &_area_arena;
+  clearLayerVector(area_layer->pattern_ids, features);
+  clearLayerVector(area_layer->color_inds, features);
+  clearLayerVector(area_layer->disp_prio, features);
+  clearLayerVector(area_layer->start_inds, features);
+  area_layer->triangles.clear();
+
+  LineLayer* line_layer = &_line_arena;
+  clearLayerVector(line_layer->pattern_ids, features);
+  clearLayerVector(line_layer->color_inds, features);
+  clearLayerVector(line_layer->disp_prio, features);
+  clearLayerVector(line_layer->start_inds, features);
+  line_layer->points.clear();
+  line_layer->distances.clear();
+
+  MarkLayer* mark_layer = &_mark_arena;
+  clearLayerVector(mark_layer->symbol_ids, features);
+  clearLayerVector(mark_layer->disp_prio, features);
+  clearLayerVector(mark_layer->points, 2*features);
 
 
   QMap<QString, std::pair<int, OGRFieldType>> fields;
@@ -287,7 +343,7 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
         RastRuleType type = RAST_RULE_TYPE_MAP.value(instr.left(2), RastRuleType::NONE);
 
         if (type == RastRuleType::CND_SY) {
-          QString symbName = instr.split("(")[1].split(")")[0];
+          QString symbName = ruleArgs(instr);
           QString exp = expandCondSymb( symbName
                                       , poFeature
                                       , geom
@@ -316,7 +372,7 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
           case RastRuleType::SYM_PT: {
             if (geom_type == wkbPoint) {
               OGRPoint* p = static_cast<OGRPoint*>(geom);
-              mark_layer->symbol_refs.push_back(instr.split("(")[1].split(")")[0]);
+              mark_layer->symbol_ids.push_back(_names.intern(ruleArgs(instr)));
               mark_layer->disp_prio.push_back(static_cast<int>(lp.DPRI));
               mark_layer->points.push_back(static_cast<float>(p->getY()));
               mark_layer->points.push_back(static_cast<float>(p->getX()));
@@ -327,24 +383,24 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
 
           // Simple line, example: LS(DASH,1,CHGRD)
           case RastRuleType::SIM_LN: {
-            QStringList instr_ls = (instr.split("(")[1].split(")")[0]).split(",");
-            QString ptrn_ref = instr_ls[0];
-            QString col_ref = instr_ls[2];
+            QStringList instr_ls = ruleArgs(instr).split(",");
+            int ptrn_id = _names.intern(instr_ls[0]);
+            const QString& col_ref = instr_ls[2];
 
             if (geom_type == wkbPolygon) {
               OGRPolygon* poly = static_cast<OGRPolygon*>(geom);
-              if (!addLineToLayer(line_layer, ptrn_ref, col_ref, lp.DPRI, poly->getExteriorRing()))
+              if (!addLineToLayer(line_layer, ptrn_id, col_ref, lp.DPRI, poly->getExteriorRing()))
                 return false;
 
               for(int iir = 0 ; iir < poly->getNumInteriorRings(); iir++) {
-                if (!addLineToLayer(line_layer, ptrn_ref, col_ref, lp.DPRI, poly->getInteriorRing(iir)))
+                if (!addLineToLayer(line_layer, ptrn_id, col_ref, lp.DPRI, poly->getInteriorRing(iir)))
                   return false;
               }
             }
 
             if (geom_type == wkbLineString) {
               OGRLineString* line = static_cast<OGRLineString*>(geom);
-              if (!addLineToLayer(line_layer, instr_ls[0], instr_ls[2], lp.DPRI, line))
+              if (!addLineToLayer(line_layer, ptrn_id, col_ref, lp.DPRI, line))
                 return false;
             }
 
@@ -353,22 +409,22 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
 
           // Pattern line, example: LC(CBLSUB06)
           case RastRuleType::COM_LN: {
-            QString ptrn_ref = instr.split("(")[1].split(")")[0];
+            int ptrn_id = _names.intern(ruleArgs(instr));
 
             if (geom_type == wkbPolygon) {
               OGRPolygon* poly = static_cast<OGRPolygon*>(geom);
               OGRLineString* ring = static_cast<OGRLineString*>(poly->getExteriorRing());
 
-              if (!addLineToLayer(line_layer, ptrn_ref, "CHBLK", lp.DPRI, ring))
+              if (!addLineToLayer(line_layer, ptrn_id, "CHBLK", lp.DPRI, ring))
                 return false;
 
               for(int iir = 0 ; iir < poly->getNumInteriorRings(); iir++)
-                if (!addLineToLayer(line_layer, ptrn_ref, "CHBLK", lp.DPRI, poly->getInteriorRing(iir)))
+                if (!addLineToLayer(line_layer, ptrn_id, "CHBLK", lp.DPRI, poly->getInteriorRing(iir)))
                   return false;
             }
 
             if (geom_type == wkbLineString)
-              if (!addLineToLayer(line_layer, ptrn_ref, "CHBLK", lp.DPRI, static_cast<OGRLineString*>(geom)))
+              if (!addLineToLayer(line_layer, ptrn_id, "CHBLK", lp.DPRI, static_cast<OGRLineString*>(geom)))
                 return false;
 
             break;
@@ -376,10 +432,10 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
 
           // Simple spatial area, example: AC(DEPDW)
           case RastRuleType::ARE_CO: {
-            QString col_ref = instr.split("(")[1].split(")")[0];
+            QString col_ref = ruleArgs(instr);
 
             if (geom_type == wkbPolygon)
-              if (!addAreaToLayer(area_layer, "", col_ref, lp.DPRI, static_cast<OGRPolygon*>(geom)))
+              if (!addAreaToLayer(area_layer, _names.intern(QString()), col_ref, lp.DPRI, static_cast<OGRPolygon*>(geom)))
                 return false;
 
             break;
@@ -387,10 +443,10 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
 
           // Pattern spatial area, example: AP(FOULAR01)
           case RastRuleType::ARE_PA:  {
-            QString ptrn_ref = instr.split("(")[1].split(")")[0];
+            int ptrn_id = _names.intern(ruleArgs(instr));
 
             if (geom_type == wkbPolygon)
-              if (!addAreaToLayer(area_layer, ptrn_ref, "CHBLK", lp.DPRI, static_cast<OGRPolygon*>(geom)))
+              if (!addAreaToLayer(area_layer, ptrn_id, "CHBLK", lp.DPRI, static_cast<OGRPolygon*>(geom)))
                 return false;
 
             break;
@@ -411,14 +467,15 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
     OGRFeature::DestroyFeature( poFeature );
   }
 
+  // Copies get exactly sized vectors
   if (area_layer->triangles.size() > 0)
-    area_layers[layer_name] = area_layer;
+    area_layers[layer_name] = new AreaLayer(*area_layer);
 
   if (line_layer->points.size() > 0)
-    line_layers[layer_name] = line_layer;
+    line_layers[layer_name] = new LineLayer(*line_layer);
 
   if (mark_layer->points.size() > 0)
-    mark_layers[layer_name] = mark_layer;
+    mark_layers[layer_name] = new MarkLayer(*mark_layer);
 
   //for (QString rule: debugFinalRastRules)
     //qDebug() << rule;
@@ -427,8 +484,8 @@ bool Chart::readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds)
 }
 
 
-bool Chart::addLineToLayer(LineLayer* layer, const QString& ptrn_ref, const QString& col_ref, ChartDispPrio dpri, OGRLineString* line) {
-  layer->pattern_refs.push_back(ptrn_ref);
+bool Chart::addLineToLayer(LineLayer* layer, int ptrn_id, const QString& col_ref, ChartDispPrio dpri, OGRLineString* line) {
+  layer->pattern_ids.push_back(ptrn_id);
   layer->color_inds.push_back(_ref->getColorIndex(col_ref));
   layer->disp_prio.push_back(static_cast<int>(dpri));
   layer->start_inds.push_back(layer->points.size());
@@ -436,9 +493,8 @@ bool Chart::addLineToLayer(LineLayer* layer, const QString& ptrn_ref, const QStr
   return readOGRLine(line, layer->points, layer->distances);
 }
 
-bool Chart::addAreaToLayer(AreaLayer* layer, const QString& ptrn_ref, const QString& col_ref, ChartDispPrio dpri, OGRPolygon* poly) {
-  layer->pattern_refs.push_back(ptrn_ref);
-  layer->disp_prio.push_back(static_cast<int>(dpri));
+bool Chart::addAreaToLayer(AreaLayer* layer, int ptrn_id, const QString& col_ref, ChartDispPrio dpri, OGRPolygon* poly) {
+  layer->pattern_ids.push_back(ptrn_id);
   layer->color_inds.push_back(_ref->getColorIndex(col_ref));
   layer->disp_prio.push_back(static_cast<int>(dpri));
   layer->start_inds.push_back(layer->triangles.size());
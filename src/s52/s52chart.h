@@ -9,6 +9,7 @@
 #include <QString>
 
 #include <vector>
+#include <QHash>
 #include "s52references.h"
 
 class OGRLayer;
@@ -19,8 +20,20 @@ class OGRLineString;
 
 
 namespace S52 {
+  // Имена символов и шаблонов карты, слои хранят их номера
+  class NameTable {
+  public:
+    int intern(const QString& name);
+    inline const QString& name(int id) const { return _names[static_cast<size_t>(id)]; }
+    inline int size() const { return static_cast<int>(_names.size()); }
+
+  private:
+    QHash<QString, int> _ids;
+    std::vector<QString> _names;
+  };
+
   struct AreaLayer {
-    std::vector<QString>  pattern_refs;   // layer i-th area s52 pattern name
+    std::vector<int>      pattern_ids;    // layer i-th area s52 pattern name id
     std::vector<float>    color_inds;     // layer i-th area s52 color token
     std::vector<int>      disp_prio;
     std::vector<size_t>   start_inds;     // layer i-th area triangles start index
@@ -28,7 +41,7 @@ namespace S52 {
   };
 
   struct LineLayer {
-    std::vector<QString>  pattern_refs;   // layer i-th line s52 pattern name
+    std::vector<int>      pattern_ids;    // layer i-th line s52 pattern name id
     std::vector<float>    color_inds;     // layer i-th line s52 color token
     std::vector<int>      disp_prio;
     std::vector<size_t>   start_inds;     // layer i-th line points start index
@@ -37,7 +50,7 @@ namespace S52 {
   };
 
   struct MarkLayer {
-    std::vector<QString>  symbol_refs;    // layer i-th point s52 symbol name
+    std::vector<int>      symbol_ids;     // layer i-th point s52 symbol name id
     std::vector<float>    points;         // sequence of point coords (lat, lon)
     std::vector<int>      disp_prio;
   };
@@ -71,6 +84,8 @@ namespace S52 {
     inline MarkLayer* markLayer(QString name) const { return mark_layers.value(name, nullptr); }
     inline TextLayer* textLayer(QString name) const { return text_layers.value(name, nullptr); }
     inline SndgLayer* sndgLayer()             const { return sndg_layer; }
+    // Pattern and symbol names of the layers
+    inline const NameTable& names()           const { return _names; }
 
     inline float minLat() const { return min_lat; }
     inline float maxLat() const { return max_lat; }
@@ -81,6 +96,7 @@ namespace S52 {
     bool isOk;
     S52References* _ref;
     void clear();
+    void releaseArena();
 
     QSet<int> floatingATONArray;
     QSet<int> rigidATONArray;
@@ -97,6 +113,14 @@ namespace S52 {
     QMap<QString, TextLayer*> text_layers;
     SndgLayer* sndg_layer;
 
+    NameTable _names;
+
+    // Ingest arena: layers of the OGR layer being read. They keep their capacity between
+    // OGR layers, only non-empty ones are copied into exactly sized chart layers
+    AreaLayer _area_arena;
+    LineLayer _line_arena;
+    MarkLayer _mark_arena;
+
     // Reads OGRLayer, appends presented layers to one or more layer maps
     bool readLayer(OGRLayer* poLayer, S52References* ref, OGRDataSource* ds);
     bool readSoundingLayer(OGRLayer* poLayer, const OGRGeometry* spatFilter);
@@ -104,11 +128,11 @@ namespace S52 {
 
     QMap<QString, QVariant> getOGRFeatureAttributes(OGRFeature* obj, const QMap<QString, std::pair<int, OGRFieldType>>& fields);
 
-    bool addAreaToLayer(AreaLayer* layer, const QString& ptrn_ref, const QString& col_ref, ChartDispPrio dpri, OGRPolygon* poly);
+    bool addAreaToLayer(AreaLayer* layer, int ptrn_id, const QString& col_ref, ChartDispPrio dpri, OGRPolygon* poly);
     // Reading and tesselating OGRPolygon, append result to triangles
     bool readOGRPolygon(OGRPolygon* poGeom, std::vector<float>& triangles);
 
-    bool addLineToLayer(LineLayer* layer, const QString& ptrn_ref, const QString& col_ref, ChartDispPrio dpri, OGRLineString* line);
+    bool addLineToLayer(LineLayer* layer, int ptrn_id, const QString& col_ref, ChartDispPrio dpri, OGRLineString* line);
     // Reading OGRLine, append result to points
     bool readOGRLine(OGRLineString* poGeom, std::vector<float>& points, std::vector<double>& distances);
   };
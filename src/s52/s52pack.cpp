@@ -0,0 +1,165 @@
+#include "s52pack.h"
+
+#include <QDebug>
+#include <QSaveFile>
+
+S52Pack::S52Pack() {
+  _map = nullptr;
+  _refs_offset = 0;
+  _refs_size = 0;
+}
+
+S52Pack::~S52Pack() {
+  // Images wrap the mapping, they go first
+  _images = S52AssetImages();
+  _file.close();
+}
+
+
+bool S52Pack::open(const QString& path) {
+  _file.setFileName(path);
+  if (!_file.open(QIODevice::ReadOnly) || _file.size() < HEADER_SIZE)
+    return false;
+
+  _map = _file.map(0, _file.size());
+  if (_map == nullptr)
+    return false;
+
+  QDataStream header(QByteArray::fromRawData(reinterpret_cast<const char*>(_map), HEADER_SIZE));
+  header.setVersion(STREAM_VERSION);
+
+  quint32 magic, version;
+  quint64 refs_offset, refs_size, assets_offset, assets_size, data_offset;
+  header >> magic >> version >> refs_offset >> refs_size >> assets_offset >> assets_size >> data_offset;
+
+  quint64 size = static_cast<quint64>(_file.size());
+  if ( magic != MAGIC || version != VERSION
+    || refs_offset + refs_size > size || assets_offset + assets_size > size || data_offset > size ) {
+    qDebug() << "Wrong S52 pack" << path;
+    return false;
+  }
+
+  _refs_offset = static_cast<qint64>(refs_offset);
+  _refs_size = static_cast<qint64>(refs_size);
+
+  QByteArray assets = QByteArray::fromRawData(reinterpret_cast<const char*>(_map + assets_offset), static_cast<int>(assets_size));
+  if (!readImages(assets, static_cast<qint64>(data_offset))) {
+    qDebug() << "Wrong S52 pack images" << path;
+    _images = S52AssetImages();
+    return false;
+  }
+
+  return true;
+}
+
+QByteArray S52Pack::references() const {
+  return QByteArray::fromRawData(reinterpret_cast<const char*>(_map + _refs_offset), static_cast<int>(_refs_size));
+}
+
+bool S52Pack::readImages(const QByteArray& block, qint64 data_offset) {
+  QDataStream stream(block);
+  stream.setVersion(STREAM_VERSION);
+
+  stream >> _images.pattern_locations >> _images.pattern_sizes
+         >> _images.line_locations >> _images.line_sizes
+         >> _images.graphic_files;
+
+  quint32 count;
+  stream >> count;
+
+  for (quint32 i = 0; i < count; i++) {
+    QString key;
+    qint32 width, height;
+    quint64 offset;
+    stream >> key >> width >> height >> offset;
+
+    if (stream.status() != QDataStream::Ok || width < 0 || height < 0)
+      return false;
+
+    qint64 bytes = 4ll * width * height;
+    if (data_offset + static_cast<qint64>(offset) + bytes > _file.size())
+      return false;
+
+    QImage img(_map + data_offset + offset, width, height, 4*width, QImage::Format_RGBA8888);
+
+    QString name = key.section('/', 1);
+    if (key == "font")
+      _images.font = img;
+    else if (key.startsWith("pattern/"))
+      _images.patterns.insert(name, img);
+    else if (key.startsWith("line/"))
+      _images.lines.insert(name, img);
+    else if (key.startsWith("symbol/"))
+      _images.symbols.insert(name, img);
+  }
+
+  return stream.status() == QDataStream::Ok;
+}
+
+
+bool S52Pack::write(const QString& path, const S52References& ref, const S52AssetImages& images) {
+  QByteArray refs;
+  {
+    QDataStream stream(&refs, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+    ref.save(stream);
+  }
+
+  QByteArray assets;
+  QByteArray data;
+  {
+    QDataStream stream(&assets, QIODevice::WriteOnly);
+    stream.setVersion(STREAM_VERSION);
+
+    stream << images.pattern_locations << images.pattern_sizes
+           << images.line_locations << images.line_sizes
+           << images.graphic_files;
+
+    QList<QPair<QString, QImage>> table;
+    table << qMakePair(QString("font"), images.font);
+    for (QString scheme : images.patterns.keys())
+      table << qMakePair("pattern/" + scheme, images.patterns[scheme]);
+    for (QString scheme : images.lines.keys())
+      table << qMakePair("line/" + scheme, images.lines[scheme]);
+    for (QString file_name : images.symbols.keys())
+      table << qMakePair("symbol/" + file_name, images.symbols[file_name]);
+
+    stream << static_cast<quint32>(table.size());
+
+    for (const QPair<QString, QImage>& entry : table) {
+      QImage img = entry.second.convertToFormat(QImage::Format_RGBA8888);
+
+      while (data.size() % ALIGN != 0)
+        data.append('\0');
+
+      stream << entry.first << static_cast<qint32>(img.width()) << static_cast<qint32>(img.height()) << static_cast<quint64>(data.size());
+
+      // RGBA8888 lines are never padded
+      data.append(reinterpret_cast<const char*>(img.constBits()), 4 * img.width() * img.height());
+    }
+  }
+
+  quint64 refs_offset = HEADER_SIZE;
+  quint64 assets_offset = refs_offset + static_cast<quint64>(refs.size());
+  quint64 data_offset = assets_offset + static_cast<quint64>(assets.size());
+  quint64 padding = (ALIGN - data_offset % ALIGN) % ALIGN;
+  data_offset += padding;
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream header(&file);
+  header.setVersion(STREAM_VERSION);
+  header << static_cast<quint32>(MAGIC) << static_cast<quint32>(VERSION)
+         << refs_offset << static_cast<quint64>(refs.size())
+         << assets_offset << static_cast<quint64>(assets.size())
+         << data_offset;
+
+  file.write(refs);
+  file.write(assets);
+  file.write(QByteArray(static_cast<int>(padding), '\0'));
+  file.write(data);
+
+  return file.commit();
+}
@@ -0,0 +1,48 @@
+#ifndef S52PACK_H
+#define S52PACK_H
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QDataStream>
+
+#include "s52assets.h"
+#include "s52references.h"
+
+// Упакованные ресурсы S52: разобранный chartsymbols.xml и готовые атласы текстур.
+// The pack is made offline by tools/s52pack and mapped into memory at startup,
+// atlas images are RGBA8888 pixels used right from the mapping, nothing is decoded.
+//   header:  magic, version, offsets and sizes of the blocks
+//   refs:    S52References::save
+//   assets:  layouts and the image table (key, width, height, offset in data)
+//   data:    image pixels, every image is aligned to 16 bytes
+class S52Pack {
+public:
+  enum { STREAM_VERSION = QDataStream::Qt_5_0 };
+
+  S52Pack();
+  ~S52Pack();
+
+  // Maps the pack, false if there is no valid pack at the path
+  bool open(const QString& path);
+
+  // References block, the data stays in the mapping
+  QByteArray references() const;
+  inline const S52AssetImages& images() const { return _images; }
+
+  static bool write(const QString& path, const S52References& ref, const S52AssetImages& images);
+
+private:
+  enum { MAGIC = 0x53353250, VERSION = 1, HEADER_SIZE = 48, ALIGN = 16 };
+
+  bool readImages(const QByteArray& block, qint64 data_offset);
+
+  QFile _file;
+  const uchar* _map;
+  qint64 _refs_offset;
+  qint64 _refs_size;
+
+  S52AssetImages _images;
+};
+
+#endif // S52PACK_H
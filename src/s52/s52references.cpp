@@ -4,8 +4,11 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QDataStream>
 #include <QXmlStreamReader>
 
+#include "s52pack.h"
+
 
 S52References::S52References(QString fileName) {
   QFile file(fileName);
@@ -45,6 +48,16 @@ S52References::S52References(QString fileName) {
   //print();
 }
 
+S52References::S52References(S52Pack* pack) {
+  _pack = pack;
+
+  QDataStream stream(_pack->references());
+  stream.setVersion(S52Pack::STREAM_VERSION);
+  load(stream);
+
+  fillColorTables();
+}
+
 LookUp S52References::findBestLookUp(const QString& name, const QMap<QString, QVariant>& objAttrs, LookUpTable tbl) {
   QVector<LookUp> lups = lookups[tbl].value(name, QVector<LookUp>());
   LookUp best;
@@ -318,6 +331,104 @@ void S52References::print(void) {
 S52References::~S52References() {
   for (auto ct: _colTbls)
     delete ct;
+
+  delete _pack;
+}
+
+
+static QDataStream& operator<<(QDataStream& s, const VectorSymbol& v) {
+  return s << v.size << v.distance << v.pivot << v.origin << v.hpgl;
+}
+
+static QDataStream& operator>>(QDataStream& s, VectorSymbol& v) {
+  return s >> v.size >> v.distance >> v.pivot >> v.origin >> v.hpgl;
+}
+
+static QDataStream& operator<<(QDataStream& s, const BitmapSymbol& b) {
+  return s << b.size << b.distance << b.pivot << b.origin << b.graphics_location;
+}
+
+static QDataStream& operator>>(QDataStream& s, BitmapSymbol& b) {
+  return s >> b.size >> b.distance >> b.pivot >> b.origin >> b.graphics_location;
+}
+
+static QDataStream& operator<<(QDataStream& s, const LineStyle& l) {
+  return s << l.rcid << l.name << l.vector << l.description << l.color_ref;
+}
+
+static QDataStream& operator>>(QDataStream& s, LineStyle& l) {
+  return s >> l.rcid >> l.name >> l.vector >> l.description >> l.color_ref;
+}
+
+static QDataStream& operator<<(QDataStream& s, const Pattern& p) {
+  return s << p.rcid << p.name << p.definition << p.filltype << p.spacing << p.vector << p.description << p.color_ref;
+}
+
+static QDataStream& operator>>(QDataStream& s, Pattern& p) {
+  return s >> p.rcid >> p.name >> p.definition >> p.filltype >> p.spacing >> p.vector >> p.description >> p.color_ref;
+}
+
+static QDataStream& operator<<(QDataStream& s, const Symbol& sy) {
+  return s << sy.rcid << sy.name << sy.description << sy.definition << sy.color_ref << sy.vector << sy.bitmap;
+}
+
+static QDataStream& operator>>(QDataStream& s, Symbol& sy) {
+  return s >> sy.rcid >> sy.name >> sy.description >> sy.definition >> sy.color_ref >> sy.vector >> sy.bitmap;
+}
+
+static QDataStream& operator<<(QDataStream& s, const LookUp& lp) {
+  return s << static_cast<qint32>(lp.nSequence) << static_cast<qint32>(lp.RCID) << lp.INST << lp.ALST << lp.OBCL
+           << static_cast<qint32>(lp.FTYP) << static_cast<qint32>(lp.DPRI) << static_cast<qint32>(lp.RPRI)
+           << static_cast<qint32>(lp.TNAM) << static_cast<qint32>(lp.DISC) << static_cast<qint32>(lp.LUCM);
+}
+
+static QDataStream& operator>>(QDataStream& s, LookUp& lp) {
+  qint32 seq, rcid, ftyp, dpri, rpri, tnam, disc, lucm;
+  s >> seq >> rcid >> lp.INST >> lp.ALST >> lp.OBCL >> ftyp >> dpri >> rpri >> tnam >> disc >> lucm;
+
+  lp.nSequence = seq;
+  lp.RCID = rcid;
+  lp.FTYP = static_cast<ChartObjectType>(ftyp);
+  lp.DPRI = static_cast<ChartDispPrio>(dpri);
+  lp.RPRI = static_cast<ChartRadarPrio>(rpri);
+  lp.TNAM = static_cast<LookUpTable>(tnam);
+  lp.DISC = static_cast<ChartDisplayCat>(disc);
+  lp.LUCM = lucm;
+  return s;
+}
+
+// Color indices and tables are filled from the colors after loading
+void S52References::save(QDataStream& stream) const {
+  stream << static_cast<quint32>(_colTbls.size());
+  for (const ColorTable* ct : _colTbls)
+    stream << ct->name << ct->graphics_file << ct->colors;
+
+  stream << static_cast<quint32>(lookups.size());
+  for (LookUpTable tbl : lookups.keys())
+    stream << static_cast<qint32>(tbl) << lookups[tbl];
+
+  stream << line_styles << patterns << symbols;
+}
+
+void S52References::load(QDataStream& stream) {
+  quint32 count;
+
+  stream >> count;
+  for (quint32 i = 0; i < count; i++) {
+    ColorTable* ct = new ColorTable();
+    stream >> ct->name >> ct->graphics_file >> ct->colors;
+    _colTbls.insert(ct->name, ct);
+  }
+
+  stream >> count;
+  for (quint32 i = 0; i < count; i++) {
+    qint32 tbl;
+    QMap<QString, QVector<LookUp>> tbl_lookups;
+    stream >> tbl >> tbl_lookups;
+    lookups.insert(static_cast<LookUpTable>(tbl), tbl_lookups);
+  }
+
+  stream >> line_styles >> patterns >> symbols;
 }
 
 
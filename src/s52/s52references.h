@@ -37,6 +37,8 @@ const static LookUpTable CONST_AREA_LOOKUP = LookUpTable::PLAIN_BOUNDARIES; // C
 
 
 class QXmlStreamReader;
+class QDataStream;
+class S52Pack;
 
 
 
@@ -239,8 +241,15 @@ struct Symbol {
 class S52References {
 public:
   S52References(QString filename);
+  // References stored in the pack, the pack is kept and deleted with the references
+  explicit S52References(S52Pack* pack);
   ~S52References(void);
 
+  // The pack the references are from, nullptr if they are read from xml
+  inline const S52Pack* pack() const { return _pack; }
+  // Pre-parsed references for the pack
+  void save(QDataStream& stream) const;
+
   LookUp findBestLookUp(const QString& name, const QMap<QString, QVariant>& objAttrs, LookUpTable tbl);
 
   inline QString getGraphicsFileName(const QString& scheme) const {return _colTbls[scheme]->graphics_file;}
@@ -270,6 +279,10 @@ private:
   void readPatterns   (QXmlStreamReader* xml);
   void readSymbols    (QXmlStreamReader* xml);
 
+  void load(QDataStream& stream);
+
+  S52Pack* _pack = nullptr;
+
   QString _colorScheme;
 
   QMap<QString, uint> _colorIndices;
@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# AIS NMEA log replay and parser benchmark
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = aisreplay
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+unix:QMAKE_CXXFLAGS += -std=gnu++11
+
+INCLUDEPATH += ../../src
+
+SOURCES     += \
+    main.cpp \
+    ../../src/datasources/aisparser.cpp
+
+HEADERS     += \
+    ../../src/datasources/aisparser.h
@@ -0,0 +1,228 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QThread>
+#include <QDebug>
+#include <QFile>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "datasources/aisparser.h"
+
+// Воспроизведение записей АИС для RLIDisplayES -ais и замер скорости разбора.
+//   aisreplay <log> -bench [passes]            parse the log in memory and print throughput
+//   aisreplay <log> -gen <targets> <minutes>   write a synthetic log of type 1 reports
+//   aisreplay <log> [-udp <port> | -tcp <port>] [-r <sentences/s>] [-loop]
+// Without -udp/-tcp sentences go to stdout, e.g. into a pipe.
+
+static void usage() {
+  fprintf(stderr, "usage: aisreplay <log> -bench [passes]\n"
+                  "       aisreplay <log> -gen <targets> <minutes>\n"
+                  "       aisreplay <log> [-udp <port> | -tcp <port>] [-r <sentences/s>] [-loop]\n");
+  exit(1);
+}
+
+static QList<QByteArray> readLines(const QString& path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    fprintf(stderr, "can't open %s\n", qPrintable(path));
+    exit(1);
+  }
+
+  QList<QByteArray> lines;
+  for (const QByteArray& line : file.readAll().split('\n'))
+    if (!line.trimmed().isEmpty())
+      lines.push_back(line.trimmed() + "\r\n");
+
+  return lines;
+}
+
+
+static int bench(const QString& path, int passes) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    fprintf(stderr, "can't open %s\n", qPrintable(path));
+    return 1;
+  }
+  QByteArray data = file.readAll();
+
+  AISParser parser;
+  qint64 reports = 0;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Feed by network sized chunks, so lines are split between calls
+  const int CHUNK = 1400;
+  for (int p = 0; p < passes; p++) {
+    for (int pos = 0; pos < data.size(); pos += CHUNK) {
+      reports += parser.parse(data.constData() + pos, static_cast<size_t>(qMin(CHUNK, data.size() - pos)));
+      parser.clearReports();
+    }
+  }
+
+  double secs = timer.nsecsElapsed() / 1e9;
+
+  printf("%d passes of %d bytes in %.3f s\n", passes, data.size(), secs);
+  printf("sentences %llu, messages %llu, errors %llu, position reports %lld\n"
+        , static_cast<unsigned long long>(parser.sentenceCount())
+        , static_cast<unsigned long long>(parser.messageCount())
+        , static_cast<unsigned long long>(parser.errorCount())
+        , reports);
+  printf("%.0f sentences/s, %.1f MB/s\n", parser.sentenceCount() / secs, passes * data.size() / secs / 1e6);
+
+  return 0;
+}
+
+
+// 6-bit armoring of a bit string
+static QByteArray armor(const std::vector<int>& bits) {
+  QByteArray payload;
+  for (size_t i = 0; i < bits.size(); i += 6) {
+    int v = 0;
+    for (size_t j = i; j < i + 6; j++)
+      v = (v << 1) | (j < bits.size() ? bits[j] : 0);
+    payload.push_back(static_cast<char>(v < 40 ? v + 48 : v + 56));
+  }
+  return payload;
+}
+
+static void putBits(std::vector<int>& bits, long long value, int count) {
+  for (int i = count - 1; i >= 0; i--)
+    bits.push_back(static_cast<int>((value >> i) & 1));
+}
+
+static QByteArray sentence(const QByteArray& body) {
+  unsigned char sum = 0;
+  for (char c : body)
+    sum ^= static_cast<unsigned char>(c);
+  return "!" + body + "*" + QByteArray::number(sum, 16).rightJustified(2, '0').toUpper() + "\r\n";
+}
+
+static int generate(const QString& path, int targets, int minutes) {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    fprintf(stderr, "can't create %s\n", qPrintable(path));
+    return 1;
+  }
+
+  srand(1);
+  std::vector<double> lat(targets), lon(targets), cog(targets), sog(targets);
+  for (int t = 0; t < targets; t++) {
+    lat[t] = 15.0 + (rand() % 10000) / 10000.0;
+    lon[t] = 145.0 + (rand() % 10000) / 10000.0;
+    cog[t] = rand() % 360;
+    sog[t] = rand() % 25;
+  }
+
+  // Every target reports each 10 seconds
+  for (int s = 0; s < minutes * 60; s += 10) {
+    for (int t = 0; t < targets; t++) {
+      double dist = sog[t] * 10.0 / 3600.0 / 60.0;
+      lat[t] += dist * cos(cog[t] * M_PI / 180.0);
+      lon[t] += dist * sin(cog[t] * M_PI / 180.0) / cos(lat[t] * M_PI / 180.0);
+
+      std::vector<int> bits;
+      putBits(bits, 1, 6);                                    // type
+      putBits(bits, 0, 2);                                    // repeat
+      putBits(bits, 200000000 + t, 30);                       // mmsi
+      putBits(bits, 0, 4);                                    // status
+      putBits(bits, 0, 8);                                    // rot
+      putBits(bits, static_cast<long long>(sog[t] * 10), 10);
+      putBits(bits, 0, 1);                                    // accuracy
+      putBits(bits, static_cast<long long>(lon[t] * 600000) & ((1LL << 28) - 1), 28);
+      putBits(bits, static_cast<long long>(lat[t] * 600000) & ((1LL << 27) - 1), 27);
+      putBits(bits, static_cast<long long>(cog[t] * 10), 12);
+      putBits(bits, static_cast<long long>(cog[t]), 9);       // heading
+      putBits(bits, s % 60, 6);                               // second
+      putBits(bits, 0, 25);
+
+      file.write(sentence("AIVDM,1,1,,A," + armor(bits) + ",0"));
+    }
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (args.size() < 2)
+    usage();
+
+  QString path = args[1];
+
+  if (args.contains("-bench")) {
+    int i = args.indexOf("-bench");
+    return bench(path, (i + 1 < args.size()) ? qMax(1, args[i+1].toInt()) : 10);
+  }
+
+  if (args.contains("-gen")) {
+    int i = args.indexOf("-gen");
+    if (i + 2 >= args.size())
+      usage();
+    return generate(path, args[i+1].toInt(), args[i+2].toInt());
+  }
+
+  int rate = args.contains("-r") ? args[args.indexOf("-r") + 1].toInt() : 200;
+  bool loop = args.contains("-loop");
+
+  QList<QByteArray> lines = readLines(path);
+  if (lines.isEmpty())
+    return 0;
+
+  QUdpSocket udp;
+  QTcpServer server;
+  QTcpSocket* client = nullptr;
+  quint16 port = 0;
+
+  if (args.contains("-udp")) {
+    port = args[args.indexOf("-udp") + 1].toUShort();
+  } else if (args.contains("-tcp")) {
+    port = args[args.indexOf("-tcp") + 1].toUShort();
+    if (!server.listen(QHostAddress::LocalHost, port)) {
+      fprintf(stderr, "can't listen on %d\n", port);
+      return 1;
+    }
+    fprintf(stderr, "waiting for a client on %d\n", port);
+    server.waitForNewConnection(-1);
+    client = server.nextPendingConnection();
+  }
+
+  // Sentences are sent in 10 ms slices
+  int per_slice = qMax(1, rate / 100);
+  int index = 0;
+
+  forever {
+    for (int i = 0; i < per_slice; i++) {
+      const QByteArray& line = lines[index];
+
+      if (client != nullptr)
+        client->write(line);
+      else if (port != 0)
+        udp.writeDatagram(line, QHostAddress::LocalHost, port);
+      else
+        fwrite(line.constData(), 1, line.size(), stdout);
+
+      if (++index == lines.size()) {
+        if (!loop)
+          return 0;
+        index = 0;
+      }
+    }
+
+    if (client != nullptr)
+      client->waitForBytesWritten(10);
+    else
+      fflush(stdout);
+
+    QThread::msleep(10);
+  }
+}
@@ -0,0 +1,45 @@
+#-------------------------------------------------
+#
+# S57 chart ingest benchmark
+#
+#-------------------------------------------------
+
+QT       += core gui opengl
+
+TARGET = chartload
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+unix:QMAKE_CXXFLAGS += -std=gnu++11
+
+# include gdal
+win32:QMAKE_LIBDIR += C:/GDAL/lib
+win32:INCLUDEPATH += C:/GDAL/include
+win32:LIBS += -lgdal_i -lgeos_i
+
+unix:LIBS += -lgdal
+
+INCLUDEPATH += ../../src
+
+SOURCES     += \
+    main.cpp \
+    ../../src/common/triangulate.cpp \
+    ../../src/common/rlimath.cpp \
+    ../../src/s52/s52chart.cpp \
+    ../../src/s52/s52references.cpp \
+    ../../src/s52/s52assets.cpp \
+    ../../src/s52/s52pack.cpp \
+    ../../src/s52/s57condsymb.cpp
+
+HEADERS     += \
+    ../../src/common/triangulate.h \
+    ../../src/common/rlimath.h \
+    ../../src/s52/s52chart.h \
+    ../../src/s52/s52references.h \
+    ../../src/s52/s52assets.h \
+    ../../src/s52/s52pack.h \
+    ../../src/s52/s57condsymb.h
+
+RESOURCES   += \
+    ../../res/chartsymbols.qrc
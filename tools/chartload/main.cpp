@@ -0,0 +1,149 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QDebug>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#include <sys/resource.h>
+
+#include "s52/s52chart.h"
+#include "s52/s52references.h"
+
+// Замер загрузки карты S57 без отрисовки: время, пиковый RSS и число выделений памяти.
+//   chartload <chart.000> [-refs <chartsymbols.xml>] [-n passes]
+// Allocations are counted by wrapping malloc on glibc, elsewhere only time and RSS are printed.
+
+static std::atomic<unsigned long long> alloc_count { 0 };
+static std::atomic<unsigned long long> alloc_bytes { 0 };
+
+#ifdef __GLIBC__
+extern "C" {
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t count, size_t size);
+  void* __libc_realloc(void* ptr, size_t size);
+
+  void* malloc(size_t size) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_malloc(size);
+  }
+
+  void* calloc(size_t count, size_t size) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(count * size, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+  }
+
+  void* realloc(void* ptr, size_t size) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+  }
+}
+#endif
+
+static void usage() {
+  fprintf(stderr, "usage: chartload <chart.000> [-refs <chartsymbols.xml>] [-n passes]\n");
+  exit(1);
+}
+
+// Peak resident set size in KB
+static long peakRss() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+template <typename T>
+static void addVector(const std::vector<T>& v, size_t& used, size_t& reserved) {
+  used += v.size() * sizeof(T);
+  reserved += v.capacity() * sizeof(T);
+}
+
+// Bytes used and reserved by the layer vectors of the chart
+static void layerBytes(const S52::Chart& chart, size_t& used, size_t& reserved) {
+  used = reserved = 0;
+
+  for (const QString& name : chart.areaLayerNames()) {
+    S52::AreaLayer* layer = chart.areaLayer(name);
+    addVector(layer->pattern_ids, used, reserved);
+    addVector(layer->color_inds, used, reserved);
+    addVector(layer->disp_prio, used, reserved);
+    addVector(layer->start_inds, used, reserved);
+    addVector(layer->triangles, used, reserved);
+  }
+
+  for (const QString& name : chart.lineLayerNames()) {
+    S52::LineLayer* layer = chart.lineLayer(name);
+    addVector(layer->pattern_ids, used, reserved);
+    addVector(layer->color_inds, used, reserved);
+    addVector(layer->disp_prio, used, reserved);
+    addVector(layer->start_inds, used, reserved);
+    addVector(layer->points, used, reserved);
+    addVector(layer->distances, used, reserved);
+  }
+
+  for (const QString& name : chart.markLayerNames()) {
+    S52::MarkLayer* layer = chart.markLayer(name);
+    addVector(layer->symbol_ids, used, reserved);
+    addVector(layer->points, used, reserved);
+    addVector(layer->disp_prio, used, reserved);
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (args.size() < 2)
+    usage();
+
+  QByteArray path = args[1].toLocal8Bit();
+  QString refs_path = args.contains("-refs") ? args[args.indexOf("-refs") + 1] : QString(":/s52/chartsymbols.xml");
+  int passes = args.contains("-n") ? qMax(1, args[args.indexOf("-n") + 1].toInt()) : 1;
+
+  S52References refs(refs_path);
+  refs.setColorScheme("DAY_BRIGHT");
+
+  long base_rss = peakRss();
+  printf("references loaded, peak RSS %ld KB\n", base_rss);
+
+  for (int p = 0; p < passes; p++) {
+    unsigned long long count0 = alloc_count.load();
+    unsigned long long bytes0 = alloc_bytes.load();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    S52::Chart* chart = new S52::Chart(path.data(), &refs);
+
+    double secs = timer.nsecsElapsed() / 1e9;
+    unsigned long long count = alloc_count.load() - count0;
+    unsigned long long bytes = alloc_bytes.load() - bytes0;
+
+    size_t used, reserved;
+    layerBytes(*chart, used, reserved);
+
+    printf("pass %d: %.3f s, peak RSS %ld KB (+%ld KB)\n", p + 1, secs, peakRss(), peakRss() - base_rss);
+#ifdef __GLIBC__
+    printf("  allocations %llu, %.1f MB requested\n", count, bytes / 1e6);
+#else
+    Q_UNUSED(count);
+    Q_UNUSED(bytes);
+#endif
+    printf("  layers: area %d, line %d, mark %d, names %d\n"
+          , chart->areaLayerNames().size()
+          , chart->lineLayerNames().size()
+          , chart->markLayerNames().size()
+          , chart->names().size());
+    printf("  layer vectors %.1f KB used, %.1f KB reserved\n", used / 1024.0, reserved / 1024.0);
+
+    delete chart;
+  }
+
+  return 0;
+}
@@ -0,0 +1,121 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "processing/radarplotextractor.h"
+
+#include "../toolargs.h"
+
+// Замер выделения отметок на синтетическом видео.
+//   plotbench [-echoes n] [-block pelengs] [-revs n] [-rpm n]
+// One 4096x800 revolution is made of noise, speckle above the threashold, point echoes
+// and a few coast patches, then it is passed to RadarPlotExtractor::updateData by blocks
+// of pelengs as the video processor sends them. Every block is one sector.
+
+static void usage() {
+  fprintf(stderr, "usage: plotbench [-echoes n] [-block pelengs] [-revs n] [-rpm n]\n");
+  exit(1);
+}
+
+static const int PEL_COUNT = 4096;
+static const int PEL_LEN   = 800;
+
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (args.contains("-h") || args.contains("--help"))
+    usage();
+
+  int echoes  = static_cast<int>(option(args, "-echoes", 4000));
+  int block   = std::max(1, std::min(PEL_COUNT, static_cast<int>(option(args, "-block", 64))));
+  int revs    = std::max(1, static_cast<int>(option(args, "-revs", 10)));
+  double rpm  = option(args, "-rpm", 24);
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> noise(0.f, 40.f);
+  std::uniform_int_distribution<int> pelengs(0, PEL_COUNT - 1);
+  std::uniform_int_distribution<int> samples(0, PEL_LEN - 1);
+  std::uniform_int_distribution<int> amps(96, 255);
+
+  std::vector<GLfloat> video(static_cast<size_t>(PEL_COUNT) * PEL_LEN);
+  for (GLfloat& amp : video)
+    amp = noise(random);
+
+  auto paint = [&](int peleng, int radius, int width, int length) {
+    float amp = static_cast<float>(amps(random));
+    for (int p = 0; p < width; p++)
+      for (int r = radius; r < std::min(PEL_LEN, radius + length); r++)
+        video[static_cast<size_t>((peleng + p) % PEL_COUNT) * PEL_LEN + r] = amp;
+  };
+
+  // Single samples above the threashold, too small to be plots
+  for (int i = 0; i < PEL_COUNT * PEL_LEN / 200; i++)
+    paint(pelengs(random), samples(random), 1, 1);
+
+  // Point echoes, wider in bearing than in range
+  std::uniform_int_distribution<int> widths(4, 24);
+  std::uniform_int_distribution<int> lengths(2, 12);
+  for (int i = 0; i < echoes; i++)
+    paint(pelengs(random), samples(random), widths(random), lengths(random));
+
+  // Coast, dropped by the size limits
+  for (int i = 0; i < 8; i++)
+    paint(pelengs(random), samples(random), 200, 100);
+
+  RadarPlotExtractor extractor(PEL_COUNT, PEL_LEN);
+
+  int plot_count = 0;
+  QObject::connect(&extractor, &RadarPlotExtractor::plotsExtracted, [&](const QVector<RadarPlot>& plots) {
+    plot_count += plots.size();
+  });
+
+  std::vector<qint64> sector_nsecs;
+  qint64 total_nsecs = 0;
+
+  printf("%d echoes, %d pelengs per sector, %d revolutions\n", echoes, block, revs);
+
+  for (int rev = 0; rev < revs; rev++) {
+    int rev_plots = plot_count;
+    qint64 rev_nsecs = 0;
+    qint64 rev_max = 0;
+
+    for (int offset = 0; offset < PEL_COUNT; offset += block) {
+      int count = std::min(block, PEL_COUNT - offset);
+
+      QElapsedTimer timer;
+      timer.start();
+      extractor.updateData(offset, count, video.data() + static_cast<size_t>(offset) * PEL_LEN);
+      qint64 nsecs = timer.nsecsElapsed();
+
+      rev_nsecs += nsecs;
+      rev_max = std::max(rev_max, nsecs);
+      sector_nsecs.push_back(nsecs);
+    }
+
+    total_nsecs += rev_nsecs;
+    printf("rev %3d: %5d plots, %.3f ms per revolution, %.1f us max per sector\n"
+          , rev + 1, plot_count - rev_plots, rev_nsecs / 1e6, rev_max / 1e3);
+  }
+
+  std::sort(sector_nsecs.begin(), sector_nsecs.end());
+  double mean = static_cast<double>(total_nsecs) / sector_nsecs.size();
+  qint64 p99 = sector_nsecs[sector_nsecs.size() * 99 / 100];
+
+  // Время прихода сектора при заданной скорости вращения антенны
+  double sector_usecs = 60e6 / rpm * block / PEL_COUNT;
+
+  printf("%d sectors: %.1f us mean, %.1f us p99, %.1f us max per sector\n"
+        , static_cast<int>(sector_nsecs.size()), mean / 1e3, p99 / 1e3, sector_nsecs.back() / 1e3);
+  printf("a sector arrives every %.1f us at %.0f rpm, %.2f%% of one core\n"
+        , sector_usecs, rpm, 100.0 * mean / 1e3 / sector_usecs);
+
+  return 0;
+}
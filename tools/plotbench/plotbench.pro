@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Radar plot extractor benchmark on synthetic video
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT       -= widgets
+
+TARGET = plotbench
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+unix:QMAKE_CXXFLAGS += -std=gnu++11
+
+INCLUDEPATH += ../../src
+
+SOURCES     += \
+    main.cpp \
+    ../../src/processing/radarplotextractor.cpp
+
+HEADERS     += \
+    ../toolargs.h \
+    ../../src/processing/radarplotextractor.h
@@ -0,0 +1,246 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThread>
+#include <QDebug>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "datasources/radarpacket.h"
+#include "datasources/radarudpreceiver.h"
+
+#include "../toolargs.h"
+
+// Передача радарного видео по UDP для RLIDisplayES -radar и замер приёма.
+//   radarsend <address>:<port> [options]    send a rotating test picture
+//   radarsend -bench [options]              send to a RadarUdpReceiver on 127.0.0.1
+// Options:
+//   -b <pelengs per revolution> (4096)  -p <samples per peleng> (800)  -frag <samples per packet> (352)
+//   -rate <pelengs/s> (0 - as fast as possible)  -t <seconds> (10, 0 - forever)  -port <port> (5800, bench)
+//   -reorder <n> to swap every n-th packet with the next one, -drop <percent> to skip packets
+
+static void usage() {
+  fprintf(stderr, "usage: radarsend <address>:<port> [-b n] [-p n] [-frag n] [-rate pelengs/s] [-t s] [-reorder n] [-drop %%]\n"
+                  "       radarsend -bench [-port n] [-b n] [-p n] [-frag n] [-rate pelengs/s] [-t s] [-reorder n] [-drop %%]\n");
+  exit(1);
+}
+
+struct Options {
+  int pel_count   = 4096;
+  int pel_len     = 800;
+  int frag_len    = 352;
+  double rate     = 0;
+  double seconds  = 10;
+  int reorder     = 0;
+  double drop     = 0;
+};
+
+struct SendStat {
+  quint64 packets = 0;
+  quint64 dropped = 0;
+  quint64 pelengs = 0;
+  double seconds = 0;
+};
+
+// Revolution of the test picture: range rings and a bright sector
+static std::vector<float> testPicture(const Options& o) {
+  std::vector<float> amps(static_cast<size_t>(o.pel_count) * o.pel_len, 0.f);
+
+  for (int i = 0; i < o.pel_count; i++)
+    for (int j = 0; j < o.pel_len; j++)
+      if (j % 100 < 4 || i % 512 < 16)
+        amps[static_cast<size_t>(i) * o.pel_len + j] = 255.f * (o.pel_len - j) / o.pel_len;
+
+  return amps;
+}
+
+static SendStat send(int fd, const sockaddr_in& to, const Options& o, const volatile bool* stop = nullptr) {
+  enum { BATCH = 64 };
+
+  std::vector<float> picture = testPicture(o);
+  int frags = (o.pel_len + o.frag_len - 1) / o.frag_len;
+
+  std::vector<RadarPacketHeader> headers(BATCH);
+  std::vector<iovec> iovs(2*BATCH);
+  std::vector<mmsghdr> msgs(BATCH);
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> percent(0.0, 100.0);
+
+  SendStat stat;
+  quint32 seq = 0;
+  int bearing = 0, frag = 0;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  while ((o.seconds <= 0 || timer.nsecsElapsed() < o.seconds * 1e9) && !(stop && *stop)) {
+    int count = 0;
+
+    while (count < BATCH) {
+      int first = frag * o.frag_len;
+      int len = std::min(o.frag_len, o.pel_len - first);
+
+      RadarPacketHeader& h = headers[count];
+      h.magic = RADAR_PACKET_MAGIC;
+      h.seq = seq++;
+      h.bearing = static_cast<quint16>(bearing);
+      h.bearings = static_cast<quint16>(o.pel_count);
+      h.first = static_cast<quint16>(first);
+      h.count = static_cast<quint16>(len);
+
+      iovs[2*count].iov_base = &h;
+      iovs[2*count].iov_len = sizeof(h);
+      iovs[2*count+1].iov_base = &picture[static_cast<size_t>(bearing) * o.pel_len + first];
+      iovs[2*count+1].iov_len = len * sizeof(float);
+
+      if (++frag == frags) {
+        frag = 0;
+        bearing = (bearing + 1) % o.pel_count;
+        stat.pelengs++;
+      }
+
+      if (o.drop > 0 && percent(random) < o.drop) {
+        stat.dropped++;
+        continue;
+      }
+
+      count++;
+    }
+
+    if (o.reorder > 0)
+      for (int i = 0; i + 1 < count; i++)
+        if ((stat.packets + i) % o.reorder == 0)
+          std::swap(iovs[2*i], iovs[2*i+2]), std::swap(iovs[2*i+1], iovs[2*i+3]);
+
+    for (int i = 0; i < count; i++) {
+      memset(&msgs[i].msg_hdr, 0, sizeof(msghdr));
+      msgs[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&to);
+      msgs[i].msg_hdr.msg_namelen = sizeof(to);
+      msgs[i].msg_hdr.msg_iov = &iovs[2*i];
+      msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    for (int sent = 0; sent < count; ) {
+      int n = sendmmsg(fd, &msgs[sent], count - sent, 0);
+      if (n < 0) {
+        if (errno == ENOBUFS || errno == EAGAIN || errno == EINTR)
+          continue;
+        perror("sendmmsg");
+        return stat;
+      }
+      sent += n;
+    }
+    stat.packets += count;
+
+    // Keep the rate by the pelengs sent so far
+    if (o.rate > 0) {
+      qint64 due = static_cast<qint64>(stat.pelengs / o.rate * 1e9);
+      qint64 ahead = due - timer.nsecsElapsed();
+      if (ahead > 0)
+        usleep(static_cast<useconds_t>(ahead / 1000));
+    }
+  }
+
+  stat.seconds = timer.nsecsElapsed() / 1e9;
+  return stat;
+}
+
+static bool address(const QString& str, sockaddr_in& sa) {
+  QStringList parts = str.split(":");
+  if (parts.size() != 2)
+    return false;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(parts[1].toUShort());
+  return inet_pton(AF_INET, parts[0].toLatin1().constData(), &sa.sin_addr) == 1;
+}
+
+static void printSend(const SendStat& s) {
+  printf("sent %llu pelengs, %llu packets in %.2f s: %.0f pelengs/s, %.0f packets/s, %llu dropped on purpose\n"
+        , s.pelengs, s.packets, s.seconds, s.pelengs / s.seconds, s.packets / s.seconds, s.dropped);
+}
+
+
+static int bench(const Options& o, int port) {
+  RadarUdpReceiver receiver(o.pel_count, o.pel_len, QString("udp:127.0.0.1:%1").arg(port));
+  receiver.start();
+  QThread::msleep(200);
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in to;
+  address(QString("127.0.0.1:%1").arg(port), to);
+
+  SendStat sent = send(fd, to, o);
+  close(fd);
+
+  // Let the receiver take what is still queued
+  QThread::msleep(300);
+  receiver.stop();
+  receiver.wait();
+
+  RadarUdpReceiver::Stat got = receiver.stat();
+  quint64 expected = sent.packets + sent.dropped;
+
+  printSend(sent);
+  printf("received %llu packets (%llu moved, %llu late, %llu duplicates, %llu bad)\n"
+        , got.packets, got.moved, got.late_packets, got.duplicates, got.bad_packets);
+  printf("published %llu complete pelengs, %.0f pelengs/s sustained, %llu incomplete\n"
+        , got.pelengs, got.pelengs / sent.seconds, got.lost_pelengs);
+  printf("lost %llu packets by seq, drop rate %.3f%% of sent (%.3f%% with the purposely dropped)\n"
+        , got.lost_packets
+        , sent.packets > 0 ? 100.0 * (sent.packets - std::min<quint64>(sent.packets, got.packets - got.duplicates)) / sent.packets : 0.0
+        , expected > 0 ? 100.0 * got.lost_packets / expected : 0.0);
+  return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (args.size() < 2)
+    usage();
+
+  Options o;
+  o.pel_count = static_cast<int>(option(args, "-b", o.pel_count));
+  o.pel_len   = static_cast<int>(option(args, "-p", o.pel_len));
+  o.frag_len  = static_cast<int>(option(args, "-frag", o.frag_len));
+  o.rate      = option(args, "-rate", o.rate);
+  o.seconds   = option(args, "-t", o.seconds);
+  o.reorder   = static_cast<int>(option(args, "-reorder", o.reorder));
+  o.drop      = option(args, "-drop", o.drop);
+
+  if (o.frag_len <= 0 || o.frag_len > RADAR_PACKET_MAX_SAMPLES || (o.pel_len + o.frag_len - 1) / o.frag_len > 32) {
+    fprintf(stderr, "fragment must be 1..%d samples and a peleng at most 32 fragments\n", RADAR_PACKET_MAX_SAMPLES);
+    return 1;
+  }
+
+  if (args[1] == "-bench")
+    return bench(o, static_cast<int>(option(args, "-port", 5800)));
+
+  sockaddr_in to;
+  if (!address(args[1], to))
+    usage();
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  // Multicast stays on the local network
+  int ttl = 1;
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+  printSend(send(fd, to, o));
+  close(fd);
+  return 0;
+}
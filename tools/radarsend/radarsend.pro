@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# UDP radar video sender and loopback ingest benchmark
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT       -= widgets
+
+TARGET = radarsend
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+unix:QMAKE_CXXFLAGS += -std=gnu++11
+
+INCLUDEPATH += ../../src
+
+SOURCES     += \
+    main.cpp \
+    ../../src/datasources/radarudpreceiver.cpp
+
+HEADERS     += \
+    ../toolargs.h \
+    ../../src/datasources/radarudpreceiver.h \
+    ../../src/datasources/radarpacket.h
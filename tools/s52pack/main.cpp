@@ -0,0 +1,108 @@
+#include <QGuiApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QDebug>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "s52/s52pack.h"
+#include "s52/s52assets.h"
+#include "s52/s52references.h"
+
+// Сборка пакета ресурсов S52 для быстрого старта RLIDisplayES.
+//   s52pack <pack> [-xml <chartsymbols.xml>]   build the pack, run it from the directory with data/
+//   s52pack <pack> -bench                      compare startup from the sources and from the pack
+// RLIDisplayES uses data/s52.pack if it exists, rebuild it after changing the xml or the textures.
+
+static void usage() {
+  fprintf(stderr, "usage: s52pack <pack> [-xml <chartsymbols.xml>]\n"
+                  "       s52pack <pack> -bench\n");
+  exit(1);
+}
+
+// Reads every pixel, so mapped pages are loaded like they are by the texture upload
+static quint32 touch(const S52AssetImages& images) {
+  QList<QImage> all;
+  all << images.font << images.patterns.values() << images.lines.values() << images.symbols.values();
+
+  quint32 sum = 0;
+  for (const QImage& img : all) {
+    const uchar* bits = img.constBits();
+    for (int i = 0; i < img.byteCount(); i += 64)
+      sum += bits[i];
+  }
+  return sum;
+}
+
+static int bench(const QString& path) {
+  QElapsedTimer timer;
+
+  timer.start();
+  S52References xml_refs(":/s52/chartsymbols.xml");
+  qint64 xml_refs_ms = timer.elapsed();
+
+  timer.start();
+  S52AssetImages built;
+  built.build(&xml_refs);
+  touch(built);
+  qint64 built_ms = timer.elapsed();
+
+  timer.start();
+  S52Pack* pack = new S52Pack();
+  if (!pack->open(path)) {
+    fprintf(stderr, "can't open %s\n", qPrintable(path));
+    delete pack;
+    return 1;
+  }
+  qint64 open_ms = timer.elapsed();
+
+  timer.start();
+  S52References pack_refs(pack);
+  qint64 pack_refs_ms = timer.elapsed();
+
+  timer.start();
+  touch(pack->images());
+  qint64 pack_images_ms = timer.elapsed();
+
+  printf("sources: references %lld ms, images %lld ms, total %lld ms\n"
+        , xml_refs_ms, built_ms, xml_refs_ms + built_ms);
+  printf("pack:    open %lld ms, references %lld ms, images %lld ms, total %lld ms\n"
+        , open_ms, pack_refs_ms, pack_images_ms, open_ms + pack_refs_ms + pack_images_ms);
+  return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+  // Fonts are drawn with QPainter
+  QGuiApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (args.size() < 2)
+    usage();
+
+  QString path = args[1];
+
+  if (args.contains("-bench"))
+    return bench(path);
+
+  QString xml_path = args.contains("-xml") ? args[args.indexOf("-xml") + 1] : QString(":/s52/chartsymbols.xml");
+
+  S52References refs(xml_path);
+
+  S52AssetImages images;
+  images.build(&refs);
+
+  if (!S52Pack::write(path, refs, images)) {
+    fprintf(stderr, "can't write %s\n", qPrintable(path));
+    return 1;
+  }
+
+  printf("%s: %d color schemes, %d area patterns, %d line patterns, %d symbol images\n"
+        , qPrintable(path)
+        , refs.getColorSchemeNames().size()
+        , images.pattern_locations.size()
+        , images.line_locations.size()
+        , images.symbols.size());
+  return 0;
+}
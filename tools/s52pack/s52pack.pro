@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Offline S52 assets pack: parsed chartsymbols.xml and texture atlases
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = s52pack
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+unix:QMAKE_CXXFLAGS += -std=gnu++11
+
+INCLUDEPATH += ../../src
+
+SOURCES     += \
+    main.cpp \
+    ../../src/s52/s52assets.cpp \
+    ../../src/s52/s52references.cpp \
+    ../../src/s52/s52pack.cpp
+
+HEADERS     += \
+    ../../src/s52/s52assets.h \
+    ../../src/s52/s52references.h \
+    ../../src/s52/s52pack.h
+
+RESOURCES   += \
+    ../../res/fonts.qrc \
+    ../../res/chartsymbols.qrc
@@ -0,0 +1,13 @@
+#ifndef TOOLARGS_H
+#define TOOLARGS_H
+
+#include <QString>
+#include <QStringList>
+
+// Числовой параметр "-name value" командной строки утилит, def if it is not given
+inline double option(const QStringList& args, const QString& name, double def) {
+  int i = args.indexOf(name);
+  return (i >= 0 && i + 1 < args.size()) ? args[i + 1].toDouble() : def;
+}
+
+#endif // TOOLARGS_H
@@ -0,0 +1,166 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include <QSet>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "common/rlimath.h"
+#include "processing/radartracker.h"
+
+#include "../toolargs.h"
+
+// Замер сопровождения целей на синтетических отметках.
+//   trackbench [-n targets] [-scans n] [-sectors n] [-clutter plots per scan]
+// Targets move straight with random courses and speeds around a still ship. Every scan
+// they become plots with range and bearing noise, plus random clutter plots, which go to
+// RadarTracker::onPlotsExtracted by sectors in bearing order as the plot extractor sends them.
+// Scan time is simulated, so the run is as fast as the tracker.
+
+static void usage() {
+  fprintf(stderr, "usage: trackbench [-n targets] [-scans n] [-sectors n] [-clutter plots per scan]\n");
+  exit(1);
+}
+
+struct Target {
+  double x, y;    // Metres from the ship, east and north
+  double vx, vy;  // m/s
+};
+
+static const int    PEL_COUNT     = 4096;
+static const int    PEL_LEN       = 800;
+static const double RANGE_METRES  = 24 * RLIMath::MILE2METER;
+static const double SAMPLE_METRES = RANGE_METRES / PEL_LEN;
+static const qint64 SCAN_MSECS    = 2500;
+
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (args.contains("-h") || args.contains("--help"))
+    usage();
+
+  int target_count  = static_cast<int>(option(args, "-n", 1000));
+  int scans         = static_cast<int>(option(args, "-scans", 40));
+  int sectors       = std::max(1, static_cast<int>(option(args, "-sectors", 32)));
+  int clutter       = static_cast<int>(option(args, "-clutter", 200));
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 0.5);
+
+  // Targets between 1 and 22 miles, up to 30 knots
+  std::vector<Target> targets(static_cast<size_t>(target_count));
+  for (Target& t : targets) {
+    double range = (1.0 + 21.0 * std::sqrt(uniform(random))) * RLIMath::MILE2METER;
+    double bearing = RLIMath::TWOPI * uniform(random);
+    double course = RLIMath::TWOPI * uniform(random);
+    double speed = 30.0 * uniform(random) * RLIMath::MILE2METER / 3600.0;
+
+    t.x = range * std::sin(bearing);
+    t.y = range * std::cos(bearing);
+    t.vx = speed * std::sin(course);
+    t.vy = speed * std::cos(course);
+  }
+
+  RadarTracker tracker(PEL_COUNT);
+  tracker.setGeometry(GeoPos(15.0, 145.0), 0.0, 0.0, SAMPLE_METRES, 0.0);
+
+  QSet<quint32> confirmed;
+  std::vector<qint64> batch_nsecs;
+  std::vector<QVector<RadarPlot>> batches(static_cast<size_t>(sectors));
+
+  qint64 start = 1000000000000ll;
+  qint64 total_nsecs = 0;
+  int plot_count = 0;
+
+  printf("%d targets, %d clutter plots per scan, %d sectors per scan, %d scans\n", target_count, clutter, sectors, scans);
+
+  for (int scan = 0; scan < scans; scan++) {
+    for (QVector<RadarPlot>& batch : batches)
+      batch.clear();
+
+    qint64 scan_start = start + scan * SCAN_MSECS;
+
+    auto addPlot = [&](double x, double y) {
+      double range = std::sqrt(x*x + y*y) / SAMPLE_METRES;
+      double peleng = std::fmod(RLIMath::degs(std::atan2(x, y)) + 360.0, 360.0) * PEL_COUNT / 360.0;
+      if (range >= PEL_LEN)
+        return;
+
+      RadarPlot plot;
+      plot.peleng = static_cast<float>(std::fmod(peleng + noise(random) + PEL_COUNT, PEL_COUNT));
+      plot.radius = static_cast<float>(range + noise(random));
+      plot.amplitude = 200.f;
+      plot.size = 16;
+      plot.time = scan_start + static_cast<qint64>(plot.peleng * SCAN_MSECS / PEL_COUNT);
+
+      batches[static_cast<size_t>(plot.peleng) * sectors / PEL_COUNT].push_back(plot);
+    };
+
+    for (const Target& t : targets) {
+      double secs = (scan * SCAN_MSECS) / 1000.0;
+      addPlot(t.x + t.vx * secs, t.y + t.vy * secs);
+    }
+
+    for (int i = 0; i < clutter; i++) {
+      double range = RANGE_METRES * std::sqrt(uniform(random));
+      double bearing = RLIMath::TWOPI * uniform(random);
+      addPlot(range * std::sin(bearing), range * std::cos(bearing));
+    }
+
+    qint64 scan_nsecs = 0;
+    qint64 scan_max = 0;
+
+    for (QVector<RadarPlot>& batch : batches) {
+      if (batch.isEmpty())
+        continue;
+
+      std::sort(batch.begin(), batch.end(), [](const RadarPlot& a, const RadarPlot& b) { return a.peleng < b.peleng; });
+      plot_count += batch.size();
+
+      QElapsedTimer timer;
+      timer.start();
+      tracker.onPlotsExtracted(batch);
+      qint64 nsecs = timer.nsecsElapsed();
+
+      // Taking the feed is the renderer's work, it is not timed
+      if (const TargetBatch* changes = tracker.feed()->take())
+        for (int i = 0; i < changes->size(); i++) {
+          if (changes->removed[i])
+            confirmed.remove(changes->ids[i]);
+          else
+            confirmed.insert(changes->ids[i]);
+        }
+
+      scan_nsecs += nsecs;
+      scan_max = std::max(scan_max, nsecs);
+      batch_nsecs.push_back(nsecs);
+    }
+
+    total_nsecs += scan_nsecs;
+    printf("scan %3d: %5d tracks, %5d confirmed, %.3f ms per scan, %.1f us max per batch\n"
+          , scan + 1, tracker.trackCount(), confirmed.size(), scan_nsecs / 1e6, scan_max / 1e3);
+  }
+
+  if (batch_nsecs.empty())
+    return 0;
+
+  std::sort(batch_nsecs.begin(), batch_nsecs.end());
+  double mean = static_cast<double>(total_nsecs) / batch_nsecs.size();
+  qint64 p99 = batch_nsecs[batch_nsecs.size() * 99 / 100];
+
+  printf("%d plots in %d batches: %.1f us mean, %.1f us p99, %.1f us max per batch\n"
+        , plot_count, static_cast<int>(batch_nsecs.size()), mean / 1e3, p99 / 1e3, batch_nsecs.back() / 1e3);
+  printf("%.3f ms per scan, %.2f%% of a %lld ms scan on one core\n"
+        , total_nsecs / 1e6 / scans, 100.0 * total_nsecs / 1e6 / scans / SCAN_MSECS, SCAN_MSECS);
+
+  return 0;
+}
@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Radar tracker benchmark on synthetic plots
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT       -= widgets
+
+TARGET = trackbench
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+unix:QMAKE_CXXFLAGS += -std=gnu++11
+
+INCLUDEPATH += ../../src
+
+SOURCES     += \
+    main.cpp \
+    ../../src/common/rlimath.cpp \
+    ../../src/common/targetindex.cpp \
+    ../../src/datasources/targetfeed.cpp \
+    ../../src/processing/radartracker.cpp
+
+HEADERS     += \
+    ../toolargs.h \
+    ../../src/common/rlimath.h \
+    ../../src/common/targetindex.h \
+    ../../src/datasources/targetfeed.h \
+    ../../src/processing/radartracker.h
@@ -0,0 +1,125 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "processing/radarvideoprocessor.h"
+
+#include "../toolargs.h"
+
+// Замер обработки радарного видео на синтетических оборотах.
+//   videobench [-revs n] [-block pelengs] [-rpm n]
+// Revolutions of 4096x800 samples with sea clutter falling with range, echoes and
+// interference streaks go through RadarVideoProcessor::processData by blocks of pelengs
+// with STC, FTC, CFAR and interference rejection on. Throughput is compared with
+// the rate pelengs come from the antenna, the processor has one core of its own.
+
+static void usage() {
+  fprintf(stderr, "usage: videobench [-revs n] [-block pelengs] [-rpm n]\n");
+  exit(1);
+}
+
+static const int PEL_COUNT = 4096;
+static const int PEL_LEN   = 800;
+
+
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+
+  if (args.contains("-h") || args.contains("--help"))
+    usage();
+
+  int revs    = std::max(1, static_cast<int>(option(args, "-revs", 10)));
+  int block   = std::max(1, std::min(PEL_COUNT, static_cast<int>(option(args, "-block", 64))));
+  double rpm  = option(args, "-rpm", 24);
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> uniform(0.f, 1.f);
+  std::uniform_int_distribution<int> pelengs(0, PEL_COUNT - 1);
+  std::uniform_int_distribution<int> samples(0, PEL_LEN - 1);
+
+  // Несколько разных оборотов, чтобы помехи не коррелировали от оборота к обороту
+  const int variants = RadarVideoProcessor::HISTORY_REVOLUTIONS + 1;
+  std::vector<std::vector<GLfloat>> video(variants);
+
+  for (std::vector<GLfloat>& rev : video) {
+    rev.resize(static_cast<size_t>(PEL_COUNT) * PEL_LEN);
+
+    for (int p = 0; p < PEL_COUNT; p++)
+      for (int r = 0; r < PEL_LEN; r++) {
+        float clutter = 160.f * std::max(0.f, 1.f - r / 200.f);
+        rev[static_cast<size_t>(p) * PEL_LEN + r] = std::min(255.f, clutter * uniform(random) + 30.f * uniform(random));
+      }
+
+    for (int i = 0; i < 3000; i++) {
+      int p0 = pelengs(random), r0 = samples(random);
+      for (int p = p0; p < p0 + 12; p++)
+        for (int r = r0; r < std::min(PEL_LEN, r0 + 6); r++)
+          rev[static_cast<size_t>(p % PEL_COUNT) * PEL_LEN + r] = 200.f + 55.f * uniform(random);
+    }
+
+    // Interference of another radar, single pelengs along the whole range
+    for (int i = 0; i < 64; i++) {
+      int p = pelengs(random);
+      for (int r = 0; r < PEL_LEN; r += 2)
+        rev[static_cast<size_t>(p) * PEL_LEN + r] = 255.f;
+    }
+  }
+
+  RadarVideoProcessor processor(PEL_COUNT, PEL_LEN);
+  processor.setGain(200.f);
+  processor.setWater(128.f);
+  processor.setRain(128.f);
+  processor.setCfar(true);
+  processor.setInterferenceRejection(true);
+
+  qint64 blocks = 0;
+  QObject::connect(&processor, &RadarVideoProcessor::updateRadarData, [&](int, int, GLfloat*) {
+    blocks++;
+  });
+
+  qint64 total_nsecs = 0;
+  qint64 max_block_nsecs = 0;
+  qint64 pelengs_done = 0;
+
+  printf("%d revolutions of %dx%d, %d pelengs per block\n", revs, PEL_COUNT, PEL_LEN, block);
+
+  for (int rev = 0; rev < revs; rev++) {
+    std::vector<GLfloat>& src = video[static_cast<size_t>(rev % variants)];
+    qint64 rev_nsecs = 0;
+
+    for (int offset = 0; offset < PEL_COUNT; offset += block) {
+      int count = std::min(block, PEL_COUNT - offset);
+      GLfloat* amps = src.data() + static_cast<size_t>(offset) * PEL_LEN;
+
+      QElapsedTimer timer;
+      timer.start();
+      processor.processData(offset, count, amps);
+      qint64 nsecs = timer.nsecsElapsed();
+
+      rev_nsecs += nsecs;
+      max_block_nsecs = std::max(max_block_nsecs, nsecs);
+    }
+
+    total_nsecs += rev_nsecs;
+    pelengs_done += PEL_COUNT;
+    printf("rev %3d: %.3f ms, %.0f pelengs/s\n", rev + 1, rev_nsecs / 1e6, PEL_COUNT / (rev_nsecs / 1e9));
+  }
+
+  double secs = total_nsecs / 1e9;
+  double rate = pelengs_done / secs;
+  double required = PEL_COUNT * rpm / 60.0;
+
+  printf("%lld pelengs in %.3f ms, %lld blocks emitted, %.1f us max per block\n"
+        , pelengs_done, secs * 1000.0, blocks, max_block_nsecs / 1e3);
+  printf("%.0f pelengs/s, %.0f pelengs/s required at %.0f rpm: %.2fx real time, %.2f%% of one core\n"
+        , rate, required, rpm, rate / required, 100.0 * required / rate);
+
+  return 0;
+}
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Radar video processing benchmark on synthetic revolutions
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT       -= widgets
+
+TARGET = videobench
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+unix:QMAKE_CXXFLAGS += -std=gnu++11
+
+INCLUDEPATH += ../../src
+
+SOURCES     += \
+    main.cpp \
+    ../../src/processing/radarvideoprocessor.cpp
+
+HEADERS     += \
+    ../toolargs.h \
+    ../../src/common/rlisimd.h \
+    ../../src/processing/radarvideoprocessor.h